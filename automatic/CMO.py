@@ -387,13 +387,17 @@ class AutoModeSimulator:
             avg_serv = stats['total_service_time'] / served if served > 0 else 0.0
             avg_stay = avg_wait + avg_serv
 
-            # Расчет дисперсий для конкретного клиента
-            wait_times = stats['wait_times']
-            service_times = stats['service_times']
-            mean_wait_src = avg_wait
-            mean_serv_src = avg_serv
-            disp_wait_src = sum((t - mean_wait_src)**2 for t in wait_times) / (len(wait_times) - 1) if len(wait_times) > 1 else 0.0
-            disp_serv_src = sum((t - mean_serv_src)**2 for t in service_times) / (len(service_times) - 1) if len(service_times) > 1 else 0.0
+            # Расчет дисперсий для конкретного клиента (cmo_native.py передает их готовыми)
+            if 'disp_wait' in stats:
+                disp_wait_src = stats['disp_wait']
+                disp_serv_src = stats['disp_service']
+            else:
+                wait_times = stats['wait_times']
+                service_times = stats['service_times']
+                mean_wait_src = avg_wait
+                mean_serv_src = avg_serv
+                disp_wait_src = sum((t - mean_wait_src)**2 for t in wait_times) / (len(wait_times) - 1) if len(wait_times) > 1 else 0.0
+                disp_serv_src = sum((t - mean_serv_src)**2 for t in service_times) / (len(service_times) - 1) if len(service_times) > 1 else 0.0
 
             print(f"{client_id:<5} {'Client ' + str(client_id):<10} {generated:<10} {p_rej:<8.4f} {avg_stay:<8.4f} {avg_wait:<8.4f} {avg_serv:<8.4f} {disp_wait_src:<8.4f} {disp_serv_src:<8.4f}")
 
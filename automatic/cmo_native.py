@@ -0,0 +1,196 @@
+import ctypes
+import os
+import sys
+
+from CMO import AutoModeSimulator, DELTA
+
+# --- Прогон автоматического режима на модели not_automatic через libnotifyme.so ---
+# Библиотека собирается из корня репозитория (см. not_automatic/NotifyMeApi.h):
+#   g++ -std=c++20 -O2 -fPIC -shared -pthread $(ls not_automatic/*.cpp | grep -v main.cpp) -o libnotifyme.so
+# Путь к ней - переменная окружения NOTIFYME_LIB, по умолчанию libnotifyme.so в корне репозитория.
+# Цикл событий идет в C++, здесь только сценарий и печать таблиц тем же print_final_results
+
+NM_API_VERSION = 1
+
+
+class SourceStats(ctypes.Structure):
+    _fields_ = [
+        ('generated', ctypes.c_longlong),
+        ('delivered', ctypes.c_longlong),
+        ('rejected', ctypes.c_longlong),
+        ('rejection_rate', ctypes.c_double),
+        ('system_time', ctypes.c_double),
+        ('wait_time', ctypes.c_double),
+        ('service_time', ctypes.c_double),
+        ('wait_variance', ctypes.c_double),
+        ('service_variance', ctypes.c_double),
+    ]
+
+
+class Summary(ctypes.Structure):
+    _fields_ = [
+        ('model_time', ctypes.c_double),
+        ('events', ctypes.c_longlong),
+        ('generated', ctypes.c_longlong),
+        ('delivered', ctypes.c_longlong),
+        ('rejected', ctypes.c_longlong),
+        ('rejection_rate', ctypes.c_double),
+        ('wait_time', ctypes.c_double),
+        ('service_time', ctypes.c_double),
+        ('statistics_start', ctypes.c_double),
+        ('finished', ctypes.c_int),
+        ('precision_reached', ctypes.c_int),
+    ]
+
+
+def load_library(path=None):
+    if path is None:
+        default = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'libnotifyme.so')
+        path = os.environ.get('NOTIFYME_LIB', default)
+    lib = ctypes.CDLL(path)
+    sim = ctypes.c_void_p
+
+    lib.nm_api_version.restype = ctypes.c_int
+    lib.nm_last_error.restype = ctypes.c_char_p
+    lib.nm_create_from_text.argtypes = [ctypes.c_char_p]
+    lib.nm_create_from_text.restype = sim
+    lib.nm_create_from_file.argtypes = [ctypes.c_char_p]
+    lib.nm_create_from_file.restype = sim
+    lib.nm_destroy.argtypes = [sim]
+    lib.nm_destroy.restype = None
+    lib.nm_run_events.argtypes = [sim, ctypes.c_longlong]
+    lib.nm_run_events.restype = ctypes.c_longlong
+    lib.nm_run.argtypes = [sim]
+    lib.nm_run.restype = ctypes.c_longlong
+    lib.nm_source_count.argtypes = [sim]
+    lib.nm_source_count.restype = ctypes.c_int
+    lib.nm_channel_count.argtypes = [sim]
+    lib.nm_channel_count.restype = ctypes.c_int
+    lib.nm_fetch_summary.argtypes = [sim, ctypes.POINTER(Summary)]
+    lib.nm_fetch_summary.restype = ctypes.c_int
+    lib.nm_fetch_sources.argtypes = [sim, ctypes.POINTER(SourceStats), ctypes.c_int]
+    lib.nm_fetch_sources.restype = ctypes.c_int
+    lib.nm_fetch_channels.argtypes = [sim, ctypes.POINTER(ctypes.c_double), ctypes.POINTER(ctypes.c_double), ctypes.c_int]
+    lib.nm_fetch_channels.restype = ctypes.c_int
+
+    if lib.nm_api_version() != NM_API_VERSION:
+        raise RuntimeError(f"libnotifyme: версия API {lib.nm_api_version()}, ожидалась {NM_API_VERSION}")
+    return lib
+
+
+# Параметры CMO.py -> сценарий INI. Общий поток с интервалом avg_interval делится поровну
+# между num_clients клиентами; специалисты равноправны (свободный с меньшим номером)
+def scenario_text(avg_interval, num_clients, buffer_size, num_specialists, service_min, service_max,
+                  num_requests, seed=17, precision=0.0):
+    return "\n".join([
+        "[system]",
+        f"buffer = {buffer_size}",
+        f"notifications = {num_requests}",
+        f"seed = {seed}",
+        "snapshots = 0",
+        f"precision = {precision}",
+        "",
+        "[sources]",
+        f"count = {num_clients}",
+        f"rate = {1.0 / (avg_interval * num_clients)!r}",
+        "",
+        "[channels]",
+        f"count = {num_specialists}",
+        "priority = 1",
+        f"service = uniform {service_min!r} {service_max!r}",
+        "",
+    ])
+
+
+class NativeSimulation:
+    def __init__(self, lib, text):
+        self.lib = lib
+        self.handle = lib.nm_create_from_text(text.encode('utf-8'))
+        if not self.handle:
+            raise RuntimeError(lib.nm_last_error().decode('utf-8', 'replace'))
+
+    def close(self):
+        if self.handle:
+            self.lib.nm_destroy(self.handle)
+            self.handle = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def run(self, events=None):
+        done = self.lib.nm_run(self.handle) if events is None else self.lib.nm_run_events(self.handle, events)
+        if done < 0:
+            raise RuntimeError(self.lib.nm_last_error().decode('utf-8', 'replace'))
+        return done
+
+    # Результаты в формате report из AutoModeSimulator.run_simulation
+    def report(self):
+        summary = Summary()
+        self.lib.nm_fetch_summary(self.handle, ctypes.byref(summary))
+        sources = (SourceStats * self.lib.nm_source_count(self.handle))()
+        count = self.lib.nm_fetch_sources(self.handle, sources, len(sources))
+        channel_count = self.lib.nm_channel_count(self.handle)
+        loads = (ctypes.c_double * channel_count)()
+        busy = (ctypes.c_double * channel_count)()
+        self.lib.nm_fetch_channels(self.handle, loads, busy, channel_count)
+
+        client_stats = {}
+        for i in range(count):
+            s = sources[i]
+            client_stats[i + 1] = {
+                'generated': s.generated,
+                'served': s.delivered,
+                'rejected': s.rejected,
+                'total_wait_time': s.wait_time * s.delivered,
+                'total_service_time': s.service_time * s.delivered,
+                'disp_wait': s.wait_variance,
+                'disp_service': s.service_variance,
+            }
+        return {
+            'summary': summary,
+            'generated_count': summary.generated,
+            'rejected_count': summary.rejected,
+            'processed_count': summary.delivered,
+            'rejection_probability': summary.rejection_rate,
+            'avg_wait_time': summary.wait_time,
+            'avg_service_time': summary.service_time,
+            'avg_system_time': summary.wait_time + summary.service_time,
+            'client_detailed_stats': client_stats,
+            'total_system_time': summary.model_time,
+            'specialist_loads': list(loads),
+            'specialist_busy_times': list(busy),
+        }
+
+
+def main(argv):
+    # Те же параметры, что в основном блоке CMO.py; "--precision" - остановка по точности DELTA
+    avg_interval = 0.7
+    num_clients = 10
+    buffer_size = 4
+    num_specialists = 2
+    service_min = 1.0
+    service_max = 1.4
+    num_requests = 5000
+    precision = 0.0
+    if '--precision' in argv:
+        precision = DELTA
+        num_requests = 10_000_000
+
+    lib = load_library()
+    text = scenario_text(avg_interval, num_clients, buffer_size, num_specialists, service_min, service_max,
+                         num_requests, precision=precision)
+    with NativeSimulation(lib, text) as simulation:
+        print(f"Запуск автоматического режима (libnotifyme) с N={num_requests} заявками от {num_clients} клиентов...")
+        simulation.run()
+        report = simulation.report()
+    summary = report['summary']
+    print(f"Событий: {summary.events}, модельное время {summary.model_time:.2f}"
+          + (", точность достигнута" if summary.precision_reached else ""))
+    AutoModeSimulator.print_final_results(None, report)
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,102 @@
+// AllocationCounter.cpp
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+  std::atomic<long long> allocations{ 0 };
+  std::atomic<long long> deallocations{ 0 };
+
+}
+
+#ifdef NOTIFYME_COUNT_ALLOCATIONS
+
+namespace {
+
+  void* countedAllocate(std::size_t size, std::size_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) {
+      size = 1;
+    }
+    void* pointer = nullptr;
+    if (alignment > alignof(std::max_align_t)) {
+      std::size_t rounded = (size + alignment - 1) / alignment * alignment; // aligned_alloc: размер кратен выравниванию
+      pointer = std::aligned_alloc(alignment, rounded);
+    }
+    else {
+      pointer = std::malloc(size);
+    }
+    return pointer;
+  }
+
+  void countedFree(void* pointer) {
+    if (pointer) {
+      deallocations.fetch_add(1, std::memory_order_relaxed);
+      std::free(pointer);
+    }
+  }
+
+}
+
+void* operator new(std::size_t size) {
+  void* pointer = countedAllocate(size, alignof(std::max_align_t));
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  void* pointer = countedAllocate(size, static_cast<std::size_t>(alignment));
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+
+namespace AllocationCounter {
+  bool isEnabled() { return true; }
+}
+
+#else
+
+namespace AllocationCounter {
+  bool isEnabled() { return false; }
+}
+
+#endif
+
+namespace AllocationCounter {
+  long long getAllocations() { return allocations.load(std::memory_order_relaxed); }
+  long long getDeallocations() { return deallocations.load(std::memory_order_relaxed); }
+}
\ No newline at end of file
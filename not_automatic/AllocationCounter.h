@@ -0,0 +1,17 @@
+// AllocationCounter.h
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+// Подсчет обращений к куче для проверки установившегося режима без выделения памяти.
+// Включается сборкой с -DNOTIFYME_COUNT_ALLOCATIONS: AllocationCounter.cpp подменяет глобальные
+// operator new/delete, каждое выделение увеличивает атомарный счетчик. Без флага подмены нет,
+// счетчик всегда 0, isEnabled() - false:
+//   g++ -std=c++20 -O2 -pthread -DNOTIFYME_COUNT_ALLOCATIONS not_automatic/*.cpp -o notifyme-alloc
+//   ./notifyme-alloc --alloc-bench not_automatic/scenarios/ttl.ini
+namespace AllocationCounter {
+  bool isEnabled();
+  long long getAllocations(); // Выделений с начала программы (во всех потоках)
+  long long getDeallocations();
+}
+
+#endif // ALLOCATION_COUNTER_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+// AnalyticalModel.cpp
+#include "AnalyticalModel.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+  struct BirthDeath {
+    double blocking; // Вероятность полного состояния - по PASTA доля отказов
+    double queueLength;
+  };
+
+  // M/M/c/K: стационарное распределение числа в системе n = 0..c+K; расчет в логарифмах -
+  // без переполнения при больших c и K
+  BirthDeath solveMMcK(double lambda, double mu, int c, int capacity) {
+    int states = c + capacity;
+    std::vector<double> logP(states + 1, 0.0);
+    for (int n = 1; n <= states; n++) {
+      logP[n] = logP[n - 1] + std::log(lambda / (std::min(n, c) * mu));
+    }
+    double top = *std::max_element(logP.begin(), logP.end());
+    double total = 0.0;
+    for (double& value : logP) {
+      value = std::exp(value - top);
+      total += value;
+    }
+    BirthDeath result{ logP[states] / total, 0.0 };
+    for (int n = c + 1; n <= states; n++) {
+      result.queueLength += (n - c) * logP[n] / total;
+    }
+    return result;
+  }
+
+  // Буфер дробной длины - линейно между соседними целыми
+  BirthDeath solveScaled(double lambda, double mu, int c, double capacity) {
+    int lower = static_cast<int>(std::floor(capacity));
+    double fraction = capacity - lower;
+    BirthDeath below = solveMMcK(lambda, mu, c, lower);
+    if (fraction < 1e-9) {
+      return below;
+    }
+    BirthDeath above = solveMMcK(lambda, mu, c, lower + 1);
+    return BirthDeath{ below.blocking + fraction * (above.blocking - below.blocking),
+      below.queueLength + fraction * (above.queueLength - below.queueLength) };
+  }
+
+}
+
+AnalyticalEstimate estimateAnalytically(const SimulationConfig& config) {
+  AnalyticalEstimate estimate{ true, "", true, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, false };
+  auto unsupported = [&](const std::string& reason) {
+    if (estimate.applicable) {
+      estimate.applicable = false;
+      estimate.reason = reason;
+    }
+  };
+
+  for (const auto& source : config.sources) {
+    estimate.arrivalRate += source.lambda;
+    if (source.ttl > 0 || source.collapseKeys > 0 || source.rateLimit > 0) {
+      unsupported("TTL, объединение или ограничение на входе");
+    }
+  }
+  if (config.retry.maxAttempts > 0) {
+    unsupported("повторы вытесненных");
+  }
+  if (config.autoscale.policy != ScalingPolicy::NONE) {
+    unsupported("автомасштабирование");
+  }
+  int c = static_cast<int>(config.channels.size());
+  if (c == 0 || estimate.arrivalRate <= 0) {
+    unsupported("нет каналов или источников");
+    return estimate;
+  }
+
+  // Моменты времени обслуживания: смесь каналов с равными весами
+  double rateSum = 0.0;
+  double meanSum = 0.0;
+  double secondMomentSum = 0.0;
+  double firstMean = -1.0;
+  for (const auto& channel : config.channels) {
+    if (channel.batchSize > 1) {
+      unsupported("пакетные каналы");
+    }
+    double mean = 0.0;
+    double variance = 0.0;
+    switch (channel.serviceLaw) {
+    case ServiceLaw::UNIFORM:
+      mean = (channel.minServiceTime + channel.maxServiceTime) / 2.0;
+      variance = (channel.maxServiceTime - channel.minServiceTime) * (channel.maxServiceTime - channel.minServiceTime) / 12.0;
+      estimate.exact = false;
+      break;
+    case ServiceLaw::EXPONENTIAL:
+      mean = channel.meanServiceTime;
+      variance = mean * mean;
+      break;
+    case ServiceLaw::CONSTANT:
+      mean = channel.meanServiceTime;
+      estimate.exact = false;
+      break;
+    }
+    if (mean <= 0) {
+      unsupported("нулевое время обслуживания");
+      return estimate;
+    }
+    estimate.exact = estimate.exact && (firstMean < 0 || mean == firstMean);
+    firstMean = mean;
+    rateSum += 1.0 / mean;
+    meanSum += mean;
+    secondMomentSum += variance + mean * mean;
+  }
+  double meanService = meanSum / c;
+  estimate.serviceScv = std::max(0.0, secondMomentSum / c / (meanService * meanService) - 1.0);
+  estimate.serviceRate = rateSum / c;
+  estimate.offeredLoad = estimate.arrivalRate / (c * estimate.serviceRate);
+
+  double g = (1.0 + estimate.serviceScv) / 2.0;
+  BirthDeath chain = solveScaled(estimate.arrivalRate, estimate.serviceRate, c, config.bufferCapacity / g);
+  estimate.rejection = chain.blocking;
+  estimate.queueLength = g * chain.queueLength;
+  double admitted = estimate.arrivalRate * (1.0 - estimate.rejection);
+  // Д1ОО4: вытесняется последнее поступившее, оно пробыло в буфере около одного промежутка
+  // между событиями полной системы; это время есть в длине очереди, но не в T_ож доставленных
+  double displacedStay = 1.0 / (estimate.arrivalRate + c * estimate.serviceRate);
+  double queueTime = estimate.queueLength - estimate.arrivalRate * estimate.rejection * displacedStay;
+  estimate.wait = admitted > 0 ? std::max(0.0, queueTime) / admitted : 0.0;
+  estimate.utilization = std::min(1.0, admitted / (c * estimate.serviceRate));
+  // Ясные точки: отказов почти нет при умеренной загрузке или перегрузка вдвое (p_отк ~ 1 - 1/rho)
+  estimate.settled = estimate.applicable && ((estimate.rejection < 1e-4 && estimate.offeredLoad < 0.5) || estimate.offeredLoad > 2.0);
+  return estimate;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+// AnalyticalModel.h
+#ifndef ANALYTICAL_MODEL_H
+#define ANALYTICAL_MODEL_H
+
+#include "SimulationConfig.h"
+#include <string>
+
+// Аналитическая оценка сценария без прогона: суммарный пуассоновский поток источников,
+// c каналов, K мест в буфере, вытеснение при полном буфере.
+// Экспоненциальное обслуживание одной длительности - точные формулы M/M/c/K (цепь гибели и размножения).
+// Иначе - двухмоментное приближение M/G/c/K: очередь в единицах g = (1 + cs^2) / 2 ведет себя как
+// в M/M/c/K с буфером K / g (диффузионное масштабирование), длина очереди умножается на g (Ли - Лонгтон).
+// Разная длительность каналов - через суммарную интенсивность обслуживания
+struct AnalyticalEstimate {
+  bool applicable; // false - в сценарии есть то, чего модель не учитывает (reason)
+  std::string reason;
+  bool exact; // M/M/c/K без приближений
+  double arrivalRate; // lambda - сумма по источникам
+  double serviceRate; // mu - средняя интенсивность канала
+  double serviceScv; // Квадрат коэффициента вариации времени обслуживания
+  double offeredLoad; // rho = lambda / (c * mu)
+  double rejection; // p_отк
+  double wait; // T_ож доставленных (с нулями сразу попавших в канал)
+  double queueLength; // Средняя длина очереди в буфере
+  double utilization; // Средняя загрузка канала
+  bool settled; // Исход ясен без прогона: почти без отказов при малой загрузке или глубокая перегрузка
+};
+
+AnalyticalEstimate estimateAnalytically(const SimulationConfig& config);
+
+#endif // ANALYTICAL_MODEL_H
\ No newline at end of file
@@ -0,0 +1,139 @@
+// Autoscaler.cpp
+#include "Autoscaler.h"
+#include "Checkpoint.h"
+#include "PushNotificationSystem.h" // Для runAutoscaleComparison
+#include <algorithm> // Для std::clamp
+#include <cmath> // Для std::ceil, std::lround
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+Autoscaler::Autoscaler(const AutoscaleConfig& config, int initialChannels)
+  : config(config), lastGenerated(0), lastRejected(0), lastBusyTime(0.0),
+  output(initialChannels), previousError(0.0), earlierError(0.0), primed(false),
+  occupancy(0.0), rejectionRate(0.0), utilization(0.0), decisions(0), lastChange(0.0) {
+  if (this->config.maxChannels == 0) {
+    this->config.maxChannels = std::max(this->config.minChannels, 2 * initialChannels);
+  }
+}
+
+void Autoscaler::rebase(long long generated, long long rejected, double busyTime) {
+  lastGenerated -= generated;
+  lastRejected -= rejected;
+  lastBusyTime -= busyTime;
+}
+
+int Autoscaler::decide(double now, double bufferOccupancy, long long generated, long long rejected, double busyTime, int active, int planned) {
+  long long newGenerated = generated - lastGenerated;
+  occupancy = bufferOccupancy;
+  rejectionRate = newGenerated > 0 ? static_cast<double>(rejected - lastRejected) / newGenerated : 0.0;
+  utilization = active > 0 ? (busyTime - lastBusyTime) / (active * config.interval) : 0.0;
+  lastGenerated = generated;
+  lastRejected = rejected;
+  lastBusyTime = busyTime;
+  decisions++;
+
+  int desired = planned;
+  switch (config.policy) {
+  case ScalingPolicy::THRESHOLD:
+    if (occupancy > config.upOccupancy || rejectionRate > config.upRejection) {
+      desired = planned + config.step;
+    }
+    else if (occupancy < config.downOccupancy && rejectionRate == 0.0) {
+      desired = planned - config.step;
+    }
+    break;
+  case ScalingPolicy::PID: {
+    double error = occupancy - config.target;
+    if (!primed) {
+      previousError = error; // Первый замер - без скачка от пропорциональной и дифференциальной частей
+      earlierError = error;
+      primed = true;
+    }
+    output += config.kp * (error - previousError) + config.ki * error * config.interval
+      + config.kd * (error - 2 * previousError + earlierError) / config.interval;
+    output = std::clamp(output, static_cast<double>(config.minChannels), static_cast<double>(config.maxChannels));
+    earlierError = previousError;
+    previousError = error;
+    desired = static_cast<int>(std::lround(output));
+    break;
+  }
+  case ScalingPolicy::TARGET_TRACKING:
+    if (active > 0) {
+      desired = static_cast<int>(std::ceil(active * utilization / config.targetUtilization));
+      if (desired > active && desired < planned) {
+        desired = planned; // Рост уже покрыт заказанными каналами - их не отменять
+      }
+    }
+    break;
+  default:
+    break;
+  }
+  desired = std::clamp(desired, config.minChannels, config.maxChannels);
+  if (desired < planned && now - lastChange < config.scaleInCooldown) {
+    desired = planned; // Сокращение после недавнего изменения - ждать, иначе пул дергается на шуме замеров
+  }
+  if (desired != planned) {
+    lastChange = now;
+  }
+  return desired;
+}
+
+const AutoscaleConfig& Autoscaler::getConfig() const { return config; }
+bool Autoscaler::isEnabled() const { return config.policy != ScalingPolicy::NONE; }
+double Autoscaler::getLastOccupancy() const { return occupancy; }
+double Autoscaler::getLastRejectionRate() const { return rejectionRate; }
+double Autoscaler::getLastUtilization() const { return utilization; }
+long long Autoscaler::getDecisions() const { return decisions; }
+
+void Autoscaler::saveState(BinaryWriter& writer) const {
+  writer.writePod(lastGenerated);
+  writer.writePod(lastRejected);
+  writer.writePod(lastBusyTime);
+  writer.writePod(output);
+  writer.writePod(previousError);
+  writer.writePod(earlierError);
+  writer.writePod(primed);
+  writer.writePod(occupancy);
+  writer.writePod(rejectionRate);
+  writer.writePod(utilization);
+  writer.writePod(decisions);
+  writer.writePod(lastChange);
+}
+
+void Autoscaler::loadState(BinaryReader& reader) {
+  reader.readPod(lastGenerated);
+  reader.readPod(lastRejected);
+  reader.readPod(lastBusyTime);
+  reader.readPod(output);
+  reader.readPod(previousError);
+  reader.readPod(earlierError);
+  reader.readPod(primed);
+  reader.readPod(occupancy);
+  reader.readPod(rejectionRate);
+  reader.readPod(utilization);
+  reader.readPod(decisions);
+  reader.readPod(lastChange);
+}
+
+void runAutoscaleComparison(SimulationConfig config) {
+  std::cout << "Политика  | p_отк  | T_ож p99 | T_отклика p99 | Канало-время | Ср. каналов | Стоимость  | Введено | Снято\n";
+  std::cout << "----------|--------|----------|---------------|--------------|-------------|------------|---------|------\n";
+  const std::pair<const char*, ScalingPolicy> policies[] = { { "none", ScalingPolicy::NONE },
+    { "threshold", ScalingPolicy::THRESHOLD }, { "pid", ScalingPolicy::PID }, { "target", ScalingPolicy::TARGET_TRACKING } };
+  for (const auto& [name, policy] : policies) {
+    config.autoscale.policy = policy;
+    PushNotificationSystem system(config);
+    system.runHeadless();
+    const Database& database = system.getDatabase();
+    double channelHours = database.getChannelHours(system.getCurrentTime());
+    std::cout << std::left << std::setw(9) << name << std::right << " | " << std::fixed << std::setprecision(4)
+      << std::setw(6) << database.getRejectionRate() << " | "
+      << std::setw(8) << database.getWaitHistogram().quantile(0.99) << " | "
+      << std::setw(13) << database.getResponseHistogram().quantile(0.99) << " | "
+      << std::setprecision(1) << std::setw(12) << channelHours << " | "
+      << std::setprecision(2) << std::setw(11) << channelHours / system.getCurrentTime() << " | "
+      << std::setprecision(1) << std::setw(10) << channelHours * config.autoscale.channelCost << " | "
+      << std::setw(7) << system.getProvisionedChannels() << " | " << system.getRetiredChannels() << "\n";
+  }
+}
\ No newline at end of file
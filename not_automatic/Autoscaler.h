@@ -0,0 +1,60 @@
+// Autoscaler.h
+#ifndef AUTOSCALER_H
+#define AUTOSCALER_H
+
+#include "SimulationConfig.h" // Для AutoscaleConfig
+
+class BinaryWriter;
+class BinaryReader;
+
+// Контроллер числа каналов. Вызывается раз в interval модельного времени с накопленными
+// счетчиками системы и сам берет приращения за период. Решение - желаемое число каналов;
+// заказ и снятие каналов (с задержкой ввода) выполняет система
+class Autoscaler {
+private:
+  AutoscaleConfig config;
+  // Счетчики на прошлом замере
+  long long lastGenerated;
+  long long lastRejected;
+  double lastBusyTime;
+  // PID в скоростной форме: выход копится и ограничивается min..max - без раскачки интеграла
+  double output;
+  double previousError;
+  double earlierError;
+  bool primed;
+  // Последний замер - для отчета
+  double occupancy;
+  double rejectionRate;
+  double utilization;
+  long long decisions;
+  double lastChange; // Момент последнего изменения числа каналов
+
+public:
+  Autoscaler(const AutoscaleConfig& config = AutoscaleConfig(), int initialChannels = 0);
+
+  // occupancy - заполнение буфера (0..1); generated, rejected, busyTime - накопленные итоги;
+  // active - работающие каналы, planned - работающие и заказанные.
+  // Занятость учитывается при начале обслуживания - загрузка за период приближенная
+  int decide(double now, double bufferOccupancy, long long generated, long long rejected, double busyTime, int active, int planned);
+
+  // Накопленные итоги сброшены (отсечение разгона), до сброса были такими: следующие
+  // приращения считаются от них, а не от нуля
+  void rebase(long long generated, long long rejected, double busyTime);
+
+  const AutoscaleConfig& getConfig() const;
+  bool isEnabled() const;
+  double getLastOccupancy() const;
+  double getLastRejectionRate() const;
+  double getLastUtilization() const;
+  long long getDecisions() const;
+
+  // Контрольная точка: только состояние контроллера, параметры - из конфигурации системы
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+// Задержка и отказы против канало-времени для политик none, threshold, pid и target на одном
+// сценарии. Политика из config.autoscale не учитывается, остальные параметры - общие
+void runAutoscaleComparison(SimulationConfig config);
+
+#endif // AUTOSCALER_H
\ No newline at end of file
@@ -0,0 +1,103 @@
+// BatchMeans.cpp
+#include "BatchMeans.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cmath>
+
+BatchMeans::BatchMeans(int capacity)
+  : capacity(std::max(8, capacity / 2 * 2)), batchSize(1), means(), currentSum(0.0), currentCount(0) {
+  means.reserve(this->capacity);
+}
+
+void BatchMeans::reset() {
+  batchSize = 1;
+  means.clear();
+  currentSum = 0.0;
+  currentCount = 0;
+}
+
+void BatchMeans::add(double value) {
+  currentSum += value;
+  if (++currentCount < batchSize) {
+    return;
+  }
+  means.push_back(currentSum / currentCount);
+  currentSum = 0.0;
+  currentCount = 0;
+  if (static_cast<int>(means.size()) == capacity) {
+    // Пачки одной длины - среднее слитой пары равно среднему средних
+    int half = capacity / 2;
+    for (int i = 0; i < half; i++) {
+      means[i] = (means[2 * i] + means[2 * i + 1]) / 2.0;
+    }
+    means.resize(half);
+    batchSize *= 2;
+  }
+}
+
+int BatchMeans::getBatchCount() const { return static_cast<int>(means.size()); }
+long long BatchMeans::getBatchSize() const { return batchSize; }
+
+double BatchMeans::getMean() const {
+  if (means.empty()) {
+    return 0.0;
+  }
+  double sum = 0.0;
+  for (double mean : means) {
+    sum += mean;
+  }
+  return sum / means.size();
+}
+
+double BatchMeans::getHalfWidth(double tAlpha) const {
+  std::size_t count = means.size();
+  if (count < 2) {
+    return 0.0;
+  }
+  double mean = getMean();
+  double squares = 0.0;
+  for (double value : means) {
+    squares += (value - mean) * (value - mean);
+  }
+  return tAlpha * std::sqrt(squares / (count - 1) / count);
+}
+
+double BatchMeans::getLag1Autocorrelation() const {
+  std::size_t count = means.size();
+  if (count < 3) {
+    return 0.0;
+  }
+  double mean = getMean();
+  double squares = 0.0;
+  double products = 0.0;
+  for (std::size_t i = 0; i < count; i++) {
+    squares += (means[i] - mean) * (means[i] - mean);
+    if (i > 0) {
+      products += (means[i] - mean) * (means[i - 1] - mean);
+    }
+  }
+  return squares > 0 ? products / squares : 0.0;
+}
+
+bool BatchMeans::isReliable(double tAlpha) const {
+  int count = getBatchCount();
+  // Для некоррелированных средних r1 приближенно нормален со стандартным отклонением 1/sqrt(b)
+  return count >= capacity / 2 && std::abs(getLag1Autocorrelation()) <= tAlpha / std::sqrt(static_cast<double>(count));
+}
+
+void BatchMeans::saveState(BinaryWriter& writer) const {
+  writer.writePod(capacity);
+  writer.writePod(batchSize);
+  writer.writePodVector(means);
+  writer.writePod(currentSum);
+  writer.writePod(currentCount);
+}
+
+void BatchMeans::loadState(BinaryReader& reader) {
+  reader.readPod(capacity);
+  reader.readPod(batchSize);
+  reader.readPodVector(means);
+  means.reserve(capacity);
+  reader.readPod(currentSum);
+  reader.readPod(currentCount);
+}
\ No newline at end of file
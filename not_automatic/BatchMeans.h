@@ -0,0 +1,41 @@
+// BatchMeans.h
+#ifndef BATCH_MEANS_H
+#define BATCH_MEANS_H
+
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Потоковый метод неперекрывающихся пачек для одного показателя одного длинного прогона.
+// В памяти не больше capacity средних пачек: когда массив заполнен, соседние пачки сливаются
+// попарно, а длина следующих пачек удваивается - память постоянна при любой длине прогона.
+// Интервал по средним пачек осмыслен, только если они почти некоррелированы: проверяется
+// выборочная автокорреляция первого порядка
+class BatchMeans {
+private:
+  int capacity; // Пачек в памяти (четное)
+  long long batchSize; // Наблюдений в пачке сейчас
+  std::vector<double> means; // Средние законченных пачек
+  double currentSum; // Незаконченная пачка
+  long long currentCount;
+
+public:
+  explicit BatchMeans(int capacity = 64);
+
+  void add(double value);
+  void reset(); // Все пачки - заново (емкость и память сохраняются)
+
+  int getBatchCount() const;
+  long long getBatchSize() const;
+  double getMean() const; // По законченным пачкам
+  double getHalfWidth(double tAlpha) const; // tAlpha * s / sqrt(b), s - по средним пачек
+  double getLag1Autocorrelation() const;
+  // Пачек не меньше половины емкости (после слияния - все) и автокорреляция незначима на уровне tAlpha
+  bool isReliable(double tAlpha) const;
+
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+#endif // BATCH_MEANS_H
\ No newline at end of file
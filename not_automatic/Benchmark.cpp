@@ -0,0 +1,237 @@
+// Benchmark.cpp
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+#include "PushNotificationSystem.h"
+#include "ProcessModel.h"
+#include "ProcessEngine.h"
+#include "Checkpoint.h"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace {
+
+  double elapsedSeconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // Одинаковые зерна должны давать одинаковую статистику в обеих моделях
+  bool sameResults(const Database& a, const Database& b, int numSources) {
+    if (a.getDeliveredCount() != b.getDeliveredCount() || a.getRejectedCount() != b.getRejectedCount()) {
+      return false;
+    }
+    for (int i = 1; i <= numSources; i++) {
+      if (a.getSourceGeneratedCount(i) != b.getSourceGeneratedCount(i) ||
+        std::abs(a.getSourceAvgWaitTime(i) - b.getSourceAvgWaitTime(i)) > 1e-9 ||
+        std::abs(a.getSourceAvgServiceTime(i) - b.getSourceAvgServiceTime(i)) > 1e-9) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+}
+
+bool runEngineBenchmark(int numSources, int bufferCapacity, int maxNotifs, unsigned seed) {
+  std::cout << "===== Замер: цикл событий против процессной модели =====\n";
+  std::cout << "Источников: " << numSources << ", буфер: " << bufferCapacity
+    << ", заявок: " << maxNotifs << ", seed: " << seed << "\n";
+
+  // Ручной цикл событий (календарь Event, ветви GEN/FREE_CHAN)
+  PushNotificationSystem system(numSources, bufferCapacity, 3, maxNotifs, seed);
+  system.setSnapshotInterval(0);
+  auto start = std::chrono::steady_clock::now();
+  system.runHeadless();
+  double loopSeconds = elapsedSeconds(start);
+
+  // Процессная модель (сопрограммы, календарь активаций)
+  long long heapBefore = FramePool::getHeapAllocations();
+  long long framesBefore = FramePool::getFrameAllocations();
+  ProcessModel model(numSources, bufferCapacity, maxNotifs, seed);
+  start = std::chrono::steady_clock::now();
+  model.run();
+  double processSeconds = elapsedSeconds(start);
+
+  int arrivals = maxNotifs - numSources; // Обработанные события GEN в обеих моделях
+  if (arrivals < 1) {
+    arrivals = 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "\nМодель              | События | Время, с | нс/заявку\n";
+  std::cout << "--------------------|---------|----------|----------\n";
+  std::cout << "Цикл событий        | " << std::setw(7) << system.getProcessedEvents() << " | "
+    << std::setw(8) << std::setprecision(4) << loopSeconds << " | "
+    << std::setw(9) << std::setprecision(1) << loopSeconds * 1e9 / arrivals << "\n";
+  std::cout << "Процессная модель   | " << std::setw(7) << model.getActivations() << " | "
+    << std::setw(8) << std::setprecision(4) << processSeconds << " | "
+    << std::setw(9) << std::setprecision(1) << processSeconds * 1e9 / arrivals << "\n";
+
+  std::cout << "\nКадров сопрограмм: " << FramePool::getFrameAllocations() - framesBefore
+    << ", обращений пула к куче: " << FramePool::getHeapAllocations() - heapBefore << "\n";
+  if (loopSeconds > 0) {
+    std::cout << "Отношение времени (процессы / цикл): " << std::setprecision(3) << processSeconds / loopSeconds << "\n";
+  }
+
+  bool identical = sameResults(system.getDatabase(), model.getDatabase(), numSources)
+    && system.getCurrentTime() == model.getCurrentTime();
+  std::cout << "Результаты моделей совпадают: " << (identical ? "да" : "НЕТ") << "\n";
+  return identical;
+}
+
+bool runCheckpointBenchmark(int warmupNotifs, int totalNotifs, unsigned seed, const std::string& path) {
+  std::cout << "===== Проверка контрольной точки =====\n";
+  std::cout << "Разогрев: " << warmupNotifs << ", всего заявок: " << totalNotifs << ", seed: " << seed << "\n";
+
+  // Непрерывный прогон - эталон
+  PushNotificationSystem reference(3, 5, 3, totalNotifs, seed);
+  reference.runHeadless();
+
+  // Разогрев и сохранение
+  PushNotificationSystem warm(3, 5, 3, warmupNotifs, seed);
+  warm.runHeadless();
+  auto start = std::chrono::steady_clock::now();
+  warm.saveCheckpoint(path);
+  double saveSeconds = elapsedSeconds(start);
+
+  // Восстановление в системе с другим зерном и продолжение
+  PushNotificationSystem restored(3, 5, 3, warmupNotifs, seed + 1);
+  start = std::chrono::steady_clock::now();
+  restored.loadCheckpoint(path);
+  double loadSeconds = elapsedSeconds(start);
+  restored.setMaxNotifications(totalNotifs);
+  restored.runHeadless();
+
+  BinaryWriter expected;
+  BinaryWriter actual;
+  reference.saveState(expected);
+  restored.saveState(actual);
+  bool identical = expected.getData() == actual.getData();
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Размер контрольной точки: " << warm.getProcessedEvents() << " событий, "
+    << expected.getData().size() / 1024.0 << " КБ в конце прогона\n";
+  std::cout << "Запись: " << saveSeconds * 1000.0 << " мс, загрузка: " << loadSeconds * 1000.0 << " мс\n";
+  std::cout << "Восстановленный прогон совпадает с непрерывным: " << (identical ? "да" : "НЕТ") << "\n";
+  return identical;
+}
+
+bool runTimeTravelBenchmark(long long totalEvents, int interval, unsigned seed) {
+  std::cout << "===== Перемещение по шкале времени =====\n";
+  std::cout << "Событий: " << totalEvents << ", интервал снимков: " << interval << ", seed: " << seed << "\n";
+
+  PushNotificationSystem system(3, 5, 3, std::numeric_limits<long long>::max(), seed);
+  system.enableTimeline(interval);
+  auto start = std::chrono::steady_clock::now();
+  system.goToEvent(totalEvents);
+  double runSeconds = elapsedSeconds(start);
+
+  std::mt19937 jumps(seed);
+  std::uniform_int_distribution<long long> targetDist(0, totalEvents);
+  const int jumpCount = 200;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < jumpCount; i++) {
+    system.goToEvent(targetDist(jumps));
+  }
+  double jumpSeconds = elapsedSeconds(start);
+
+  // Шаг назад с конца прогона
+  system.goToEvent(totalEvents);
+  start = std::chrono::steady_clock::now();
+  system.goToEvent(totalEvents - 1);
+  double backSeconds = elapsedSeconds(start);
+
+  // Состояние после перехода назад должно совпасть с прямым прогоном до того же события
+  bool identical = true;
+  const long long checkpoints[] = { totalEvents / 3, totalEvents / 2 + 7, totalEvents - 1 };
+  for (long long target : checkpoints) {
+    system.goToEvent(totalEvents);
+    system.goToEvent(target);
+    PushNotificationSystem reference(3, 5, 3, std::numeric_limits<long long>::max(), seed);
+    reference.goToEvent(target);
+    BinaryWriter expected;
+    BinaryWriter actual;
+    reference.saveState(expected);
+    system.saveState(actual);
+    identical = identical && expected.getData() == actual.getData();
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Прямой прогон: " << runSeconds << " с, снимков: " << system.getTimelineBytes() / 1024 / 1024.0 << " МБ\n";
+  std::cout << "Средний случайный переход: " << jumpSeconds * 1000.0 / jumpCount << " мс\n";
+  std::cout << "Шаг назад (B) в конце прогона: " << backSeconds * 1000.0 << " мс\n";
+  std::cout << "Состояние после перехода совпадает с прямым прогоном: " << (identical ? "да" : "НЕТ") << "\n";
+  return identical;
+}
+
+void runSeriesExport(int maxNotifs, int snapshotInterval, const std::string& prefix,
+  DownsampleMode mode, std::size_t maxPoints, unsigned seed) {
+  std::cout << "===== Выгрузка рядов снапшотов =====\n";
+  std::cout << "Заявок: " << maxNotifs << ", снапшот каждые " << snapshotInterval << " событий, seed: " << seed << "\n";
+
+  PushNotificationSystem system(3, 5, 3, maxNotifs, seed);
+  system.setSnapshotInterval(snapshotInterval);
+  auto start = std::chrono::steady_clock::now();
+  system.runHeadless();
+  double runSeconds = elapsedSeconds(start);
+
+  const TimeSeriesStore& series = system.getDatabase().getSeries();
+  std::size_t bytes = (series.getColumnCount() + 1) * series.getCapacity() * sizeof(double);
+
+  start = std::chrono::steady_clock::now();
+  series.exportCsv(prefix + ".csv", mode, maxPoints);
+  double csvSeconds = elapsedSeconds(start);
+  start = std::chrono::steady_clock::now();
+  series.exportBinary(prefix + ".bin", mode, maxPoints);
+  double binarySeconds = elapsedSeconds(start);
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Прогон: " << runSeconds << " с, снапшотов: " << series.getLength()
+    << ", рядов: " << series.getColumnCount() << ", память рядов: " << bytes / 1024.0 / 1024.0 << " МБ\n";
+  std::cout << "Выгружено строк: " << series.selectRows(mode, maxPoints).size() << "\n";
+  std::cout << prefix << ".csv: " << std::filesystem::file_size(prefix + ".csv") / 1024.0 << " КБ за " << csvSeconds * 1000.0 << " мс\n";
+  std::cout << prefix << ".bin: " << std::filesystem::file_size(prefix + ".bin") / 1024.0 << " КБ за " << binarySeconds * 1000.0 << " мс\n";
+}
+
+bool runAllocationBenchmark(SimulationConfig config, long long warmupEvents, long long measuredEvents) {
+  std::cout << "===== Выделения памяти в установившемся режиме =====\n";
+  std::cout << "Источников: " << config.sources.size() << ", каналов: " << config.channels.size()
+    << ", буфер: " << config.bufferCapacity << ", разгон: " << warmupEvents << " событий, замер: " << measuredEvents << "\n";
+  if (!AllocationCounter::isEnabled()) {
+    std::cout << "Подсчет выделений не собран: нужна сборка с -DNOTIFYME_COUNT_ALLOCATIONS (см. AllocationCounter.h)\n";
+    return false;
+  }
+
+  // Заявок с запасом: на заявку приходится не меньше одного события, прогон не кончится раньше замера
+  long long notifications = warmupEvents + measuredEvents + static_cast<long long>(config.sources.size());
+  config.maxNotifications = notifications;
+  PushNotificationSystem system(config);
+  system.setVerbose(false);
+  system.runEvents(warmupEvents);
+  double measureStart = system.getCurrentTime();
+
+  long long allocationsBefore = AllocationCounter::getAllocations();
+  auto start = std::chrono::steady_clock::now();
+  long long measured = system.runEvents(measuredEvents);
+  double seconds = elapsedSeconds(start);
+  long long allocations = AllocationCounter::getAllocations() - allocationsBefore;
+
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "Событий в замере: " << measured << ", " << (measured > 0 ? seconds * 1e9 / measured : 0.0) << " нс/событие\n";
+  std::cout << "Выделений памяти: " << allocations;
+  if (measured > 0) {
+    std::cout << " (" << std::setprecision(4) << static_cast<double>(allocations) / measured << " на событие)";
+  }
+  if (config.warmupBatch > 0) {
+    // Сброс статистики после разгона - тоже в цикле событий; проверка осмысленна, если он попал в замер
+    double resetTime = system.getWarmupResetTime();
+    std::cout << "\nОтсечение разгона: " << (resetTime < 0 ? "не найдено"
+      : (resetTime >= measureStart ? "в замере" : "до замера")) << ", рядов снапшотов " << system.getDatabase().getSeries().getLength();
+  }
+  std::cout << "\nУстановившийся режим без выделений: " << (allocations == 0 ? "да" : "НЕТ") << "\n";
+  return allocations == 0;
+}
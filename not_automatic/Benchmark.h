@@ -0,0 +1,32 @@
+// Benchmark.h
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "SimulationConfig.h"
+#include "TimeSeries.h"
+#include <string>
+
+// Замер: ручной цикл событий PushNotificationSystem против процессной модели (ProcessModel)
+// на одинаковых параметрах и зерне. Возвращает false, если результаты моделей разошлись
+bool runEngineBenchmark(int numSources, int bufferCapacity, int maxNotifs, unsigned seed);
+
+// Проверка контрольных точек: прогон до warmupNotifs, сохранение в path, восстановление
+// в новой системе и продолжение до totalNotifs. Состояние должно побитово совпасть
+// с непрерывным прогоном; выводится время записи и загрузки
+bool runCheckpointBenchmark(int warmupNotifs, int totalNotifs, unsigned seed, const std::string& path);
+
+// Перемещение по шкале времени: прогон на totalEvents событий со снимками каждые interval,
+// затем случайные переходы. Время перехода и проверка состояния против прямого прогона
+bool runTimeTravelBenchmark(long long totalEvents, int interval, unsigned seed);
+
+// Прогон со снапшотами каждые snapshotInterval событий и выгрузка рядов в <prefix>.csv
+// и <prefix>.bin (прореживание до maxPoints точек, 0 - все). Время прогона и выгрузки, объем рядов
+void runSeriesExport(int maxNotifs, int snapshotInterval, const std::string& prefix,
+  DownsampleMode mode, std::size_t maxPoints, unsigned seed);
+
+// Установившийся режим без выделения памяти: сценарий разгоняется warmupEvents событиями,
+// затем на measuredEvents событиях считаются обращения к куче (AllocationCounter).
+// Возвращает false, если в замере было хоть одно выделение или подсчет не собран
+bool runAllocationBenchmark(SimulationConfig config, long long warmupEvents, long long measuredEvents);
+
+#endif // BENCHMARK_H
\ No newline at end of file
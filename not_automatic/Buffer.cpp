@@ -1,101 +1,453 @@
 // Buffer.cpp
 #include "Buffer.h"
-#include "Database.h" //  recordRejection
-#include <algorithm> //  std::all_of, std::none_of, std::count
+#include "Database.h" // Для recordRejection
+#include "Checkpoint.h"
+#include <algorithm> // Для std::min
+#include <bit> // Для std::countr_zero, std::countl_zero
+#include <stdexcept>
 
-Buffer::Buffer(int capacity) : capacity(capacity), pointer(0) {
+Buffer::Buffer(int capacity) : capacity(capacity), pointer(0), usedSlots(0), coalescing(false),
+  holdDisplaced(false), hasDisplaced(false),
+  classSelection(ClassSelection::NONE), classCount(0), classMask(0), classLeaves(0), virtualPass(0.0) {
   notifications.resize(capacity);
   occupied.resize(capacity, false);
+  occupancyWords.assign((capacity + 63) / 64, 0);
+}
+
+void Buffer::setOccupied(int position, bool value) {
+  occupied[position] = value;
+  std::uint64_t bit = std::uint64_t(1) << (position % 64);
+  if (value) {
+    occupancyWords[position / 64] |= bit;
+  }
+  else {
+    occupancyWords[position / 64] &= ~bit;
+  }
+}
+
+int Buffer::nextSlot(int from, bool wantOccupied) const {
+  // Просмотр словами по 64 ячейки: от from до конца, затем с начала (кольцо)
+  int words = static_cast<int>(occupancyWords.size());
+  for (int pass = 0; pass <= words; pass++) {
+    int word = (from / 64 + pass) % words;
+    std::uint64_t bits = wantOccupied ? occupancyWords[word] : ~occupancyWords[word];
+    if (pass == 0) {
+      bits &= ~std::uint64_t(0) << (from % 64); // Ячейки до from в первом слове - в последнюю очередь
+    }
+    if (bits) {
+      int position = word * 64 + std::countr_zero(bits);
+      if (position < capacity) { // Хвост последнего слова - за пределами буфера
+        return position;
+      }
+    }
+  }
+  return -1;
+}
+
+void Buffer::armExpiry(int position, const Notification& notification, double currentTime) {
+  int sourceId = notification.getSourceId();
+  double ttl = (sourceId >= 0 && sourceId < static_cast<int>(sourceTtl.size())) ? sourceTtl[sourceId] : 0.0;
+  if (ttl > 0) {
+    expiryWheel.arm(position, currentTime + ttl);
+  }
+  else {
+    expiryWheel.cancel(position);
+  }
+}
+
+std::size_t Buffer::keySlot(const Notification& notification) const {
+  // Перемешивание splitmix64 по трем полям ключа
+  std::uint64_t h = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(notification.getSourceId())) << 32)
+    ^ static_cast<std::uint32_t>(notification.getDeviceId());
+  h ^= static_cast<std::uint64_t>(static_cast<std::uint32_t>(notification.getCollapseKey())) * 0x9E3779B97F4A7C15ull;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+  h ^= h >> 31;
+  return static_cast<std::size_t>(h) & (keyIndex.size() - 1);
+}
+
+int Buffer::findCoalescable(const Notification& notification) const {
+  std::size_t mask = keyIndex.size() - 1;
+  for (std::size_t i = keySlot(notification); keyIndex[i] >= 0; i = (i + 1) & mask) {
+    if (notifications[keyIndex[i]].sameCollapseTarget(notification)) {
+      return keyIndex[i];
+    }
+  }
+  return -1;
+}
+
+void Buffer::indexInsert(int position) {
+  std::size_t mask = keyIndex.size() - 1;
+  std::size_t i = keySlot(notifications[position]);
+  while (keyIndex[i] >= 0) {
+    i = (i + 1) & mask;
+  }
+  keyIndex[i] = position;
+}
+
+void Buffer::indexErase(int position) {
+  std::size_t mask = keyIndex.size() - 1;
+  std::size_t hole = keySlot(notifications[position]);
+  while (keyIndex[hole] != position) {
+    hole = (hole + 1) & mask;
+  }
+  keyIndex[hole] = -1;
+  // Сдвиг назад: следующие в цепочке, чья исходная позиция не между дырой и ними, занимают дыру
+  for (std::size_t i = (hole + 1) & mask; keyIndex[i] >= 0; i = (i + 1) & mask) {
+    std::size_t home = keySlot(notifications[keyIndex[i]]);
+    bool stays = (hole < i) ? (home > hole && home <= i) : (home > hole || home <= i);
+    if (!stays) {
+      keyIndex[hole] = keyIndex[i];
+      keyIndex[i] = -1;
+      hole = i;
+    }
+  }
+}
+
+void Buffer::releaseSlot(int position) {
+  if (coalescing && notifications[position].isCoalescable()) {
+    indexErase(position);
+  }
+  if (classCount > 0) {
+    classUnlink(position);
+  }
+  if (isExpiryEnabled()) {
+    expiryWheel.cancel(position);
+  }
+  setOccupied(position, false);
+  usedSlots--;
+  notifications[position] = Notification(0, 0);
+}
+
+int Buffer::classOf(const Notification& notification) const {
+  int cls = notification.getPriorityClass();
+  return cls < 0 ? 0 : (cls >= classCount ? classCount - 1 : cls);
+}
+
+void Buffer::classLink(int position) {
+  int cls = classOf(notifications[position]);
+  int head = classHead[cls];
+  if (head < 0) {
+    classNext[position] = position;
+    classPrev[position] = position;
+    classHead[cls] = position;
+    classMask |= std::uint64_t(1) << cls;
+    if (classSelection == ClassSelection::WEIGHTED) {
+      classPass[cls] = std::max(classPass[cls], virtualPass); // Простой в пустом состоянии не копит кредит
+      updateClassTree(cls);
+    }
+  }
+  else {
+    int tail = classPrev[head];
+    classNext[tail] = position;
+    classPrev[position] = tail;
+    classNext[position] = head;
+    classPrev[head] = position;
+  }
+  classSize[cls]++;
+}
+
+void Buffer::classUnlink(int position) {
+  int cls = classOf(notifications[position]);
+  if (classNext[position] == position) {
+    classHead[cls] = -1;
+    classMask &= ~(std::uint64_t(1) << cls);
+    if (classSelection == ClassSelection::WEIGHTED) {
+      updateClassTree(cls);
+    }
+  }
+  else {
+    classNext[classPrev[position]] = classNext[position];
+    classPrev[classNext[position]] = classPrev[position];
+    if (classHead[cls] == position) {
+      classHead[cls] = classNext[position];
+    }
+  }
+  classSize[cls]--;
+}
+
+void Buffer::updateClassTree(int cls) {
+  int node = classLeaves + cls;
+  classTree[node] = (classHead[cls] >= 0) ? cls : -1;
+  for (node /= 2; node >= 1; node /= 2) {
+    int left = classTree[2 * node];
+    int right = classTree[2 * node + 1];
+    // При равных проходах - левый, т.е. более высокий класс
+    classTree[node] = (left < 0) ? right : (right < 0) ? left : (classPass[right] < classPass[left] ? right : left);
+  }
+}
+
+int Buffer::selectClass() {
+  if (classSelection == ClassSelection::STRICT) {
+    return std::countr_zero(classMask);
+  }
+  int cls = classTree[1];
+  virtualPass = classPass[cls];
+  classPass[cls] += classStride[cls];
+  updateClassTree(cls);
+  return cls;
 }
 
 bool Buffer::isFull() const {
-  return std::all_of(occupied.begin(), occupied.end(), [](bool o) { return o; });
+  return usedSlots >= capacity;
 }
 
 bool Buffer::isEmpty() const {
-  return std::none_of(occupied.begin(), occupied.end(), [](bool o) { return o; });
+  return usedSlots == 0;
 }
 
-//   (11 - )
-//   Database     (14)
-bool Buffer::addNotification(Notification notification, Database* db) {
+// Добавление уведомления (Д1ОЗ1 - кольцо)
+// Теперь принимает Database для фиксации статистики вытеснения (Д1ОО4)
+bool Buffer::addNotification(Notification notification, double currentTime, Database* db) {
+  if (coalescing && notification.isCoalescable()) {
+    int target = findCoalescable(notification);
+    if (target >= 0) {
+      // Более новое содержимое для того же устройства и ключа - на место старого, ячейка и указатель прежние
+      notifications[target].coalesce(notification);
+      if (isExpiryEnabled()) {
+        armExpiry(target, notification, currentTime); // Срок жизни - от нового содержимого
+      }
+      if (db) {
+        db->recordCoalescing(notification);
+      }
+      return true;
+    }
+  }
+
   if (isFull()) {
-    //   (14 -  )
-    //    (    )
-    //  11 " " -     `(pointer - 1) % capacity`
+    // Дисциплина отказа (Д1ОО4 - замена последнего)
+    // Найти последнюю поступившую (с наибольшим указателем до инкремента)
+    // В Д1ОЗ1 "последняя поступившая" - это уведомление в позиции `(pointer - 1) % capacity`
     int lastPos = (pointer == 0) ? capacity - 1 : pointer - 1;
+    if (classCount > 0) {
+      // С классами - последнее поступившее самого низкого непустого класса (хвост его кольца)
+      int lowest = 63 - std::countl_zero(classMask);
+      if (classOf(notification) > lowest) {
+        // Поступившее ниже всех ожидающих - отказ ему самому, буфер не меняется
+        notification.setStatus(NotificationStatus::REJECTED);
+        if (holdDisplaced) {
+          displacedNotification = notification;
+          hasDisplaced = true;
+        }
+        else if (db) {
+          db->recordRejection(notification);
+        }
+        return false;
+      }
+      lastPos = classPrev[classHead[lowest]];
+    }
 
-    //   
+    // Вытеснить последнее уведомление
     Notification displaced = notifications[lastPos];
     displaced.setStatus(NotificationStatus::REJECTED);
 
-    //    
-    if (db) {
+    // ЗАПИСАТЬ СТАТИСТИКУ О ВЫТСНЕНИИ (в режиме повторов - решает владелец)
+    if (holdDisplaced) {
+      displacedNotification = displaced;
+      hasDisplaced = true;
+    }
+    else if (db) {
       db->recordRejection(displaced);
     }
 
-    //      
-    notifications[lastPos] = notification;
-    occupied[lastPos] = true;
-    notification.setEnterBufferTime(); //     
+    // Поместить новое уведомление на освободившееся место
+    if (coalescing && displaced.isCoalescable()) {
+      indexErase(lastPos);
+    }
+    if (classCount > 0) {
+      classUnlink(lastPos);
+    }
+    notification.setEnterBufferTime(currentTime); // Устанавливаем время входа в буфер
     notification.setStatus(NotificationStatus::BUFFERED);
+    notifications[lastPos] = notification;
+    setOccupied(lastPos, true);
+    if (isExpiryEnabled()) {
+      armExpiry(lastPos, notification, currentTime); // Таймер вытесненного заменяется таймером нового
+    }
+    if (coalescing && notification.isCoalescable()) {
+      indexInsert(lastPos);
+    }
+    if (classCount > 0) {
+      classLink(lastPos);
+    }
 
-    return true; //  ,  
+    return true; // Уведомление добавлено, предыдущее вытеснено
   }
 
-  //   ,    (11)
-  int startPos = pointer;
-  do {
-    if (!occupied[pointer]) {
-      notifications[pointer] = notification;
-      occupied[pointer] = true;
-      notification.setEnterBufferTime(); //     
-      notification.setStatus(NotificationStatus::BUFFERED);
+  // Найти свободное место, начиная с указателя (Д1ОЗ1)
+  int position = nextSlot(pointer, false);
+  if (position < 0) {
+    return false; // Не должно сработать, если isFull() корректен
+  }
+  notification.setEnterBufferTime(currentTime); // Устанавливаем время входа в буфер
+  notification.setStatus(NotificationStatus::BUFFERED);
+  notifications[position] = notification;
+  setOccupied(position, true);
+  usedSlots++;
+  if (isExpiryEnabled()) {
+    armExpiry(position, notification, currentTime);
+  }
+  if (coalescing && notification.isCoalescable()) {
+    indexInsert(position);
+  }
+  if (classCount > 0) {
+    classLink(position);
+  }
 
-      //     
-      pointer = (pointer + 1) % capacity;
-      return true;
+  // Переместить указатель на следующую позицию
+  pointer = (position + 1) % capacity;
+  return true;
+}
+
+// Выбор уведомления (Д2Б3 - кольцо)
+Notification Buffer::getNextNotification(double currentTime) {
+  if (isEmpty()) {
+    return Notification(0, 0); // Пустое уведомление
+  }
+
+  // Найти следующее уведомление, начиная с указателя (Д2Б3);
+  // с классами - самое раннее в кольце выбранного класса
+  int position = (classCount > 0) ? classHead[selectClass()] : nextSlot(pointer, true);
+  if (position < 0) {
+    return Notification(0, 0); // Не должно сработать, если isEmpty() корректен
+  }
+  Notification notification = notifications[position];
+  // Освободить ячейку (таймер TTL снимается - ушло в канал до истечения срока)
+  releaseSlot(position);
+
+  // Переместить указатель на следующую позицию (это ключевое для Д2Б3!)
+  pointer = (position + 1) % capacity;
+
+  // Установить время *покидания* буфера (начала обслуживания)
+  notification.setLeaveBufferTime(currentTime);
+
+  return notification;
+}
+
+int Buffer::takeNotifications(int maxCount, double currentTime, std::vector<Notification>& out) {
+  int taken = 0;
+  while (taken < maxCount && !isEmpty()) {
+    out.push_back(getNextNotification(currentTime)); // Указатель идет по кольцу от выбранной ячейки
+    taken++;
+  }
+  return taken;
+}
+
+void Buffer::enableExpiry(const std::vector<double>& ttlBySource, double tickSize) {
+  sourceTtl = ttlBySource;
+  if (tickSize <= 0) {
+    // Самый короткий TTL - на 64 тика: срок попадает в слот с точностью до 1/64 TTL,
+    // слот текущего тика короткий и просматривается быстро
+    double shortest = 0.0;
+    for (double ttl : sourceTtl) {
+      if (ttl > 0) {
+        shortest = (shortest > 0) ? std::min(shortest, ttl) : ttl;
+      }
     }
-    pointer = (pointer + 1) % capacity;
-  } while (pointer != startPos);
+    tickSize = (shortest > 0) ? shortest / TimingWheel::kSlots : 1.0;
+  }
+  expiryWheel = TimingWheel(capacity, tickSize);
+  expiredSlots.reserve(capacity); // За одно продвижение истекает не больше, чем ячеек
+}
 
-  return false; //   ,  isFull() 
+bool Buffer::isExpiryEnabled() const {
+  return !sourceTtl.empty();
 }
 
-//   (23 - )
-Notification Buffer::getNextNotification() {
-  if (isEmpty()) {
-    return Notification(0, 0); //  
+int Buffer::expireNotifications(double currentTime, Database* db) {
+  if (!isExpiryEnabled()) {
+    return 0;
+  }
+  expiredSlots.clear();
+  expiryWheel.advance(currentTime, expiredSlots);
+  for (int position : expiredSlots) {
+    Notification expired = notifications[position];
+    expired.setStatus(NotificationStatus::EXPIRED);
+    if (db) {
+      db->recordExpiry(expired);
+    }
+    // Ячейка освобождается; указатель Д1ОЗ1/Д2Б3 не сдвигается
+    releaseSlot(position);
   }
+  return static_cast<int>(expiredSlots.size());
+}
 
-  //   ,    (23)
-  int startPos = pointer;
-  do {
-    if (occupied[pointer]) {
-      Notification notification = notifications[pointer];
-      //  
-      occupied[pointer] = false;
-      notifications[pointer] = Notification(0, 0);
+void Buffer::enableDisplacementRetry() {
+  holdDisplaced = true;
+}
 
-      //      (   23!)
-      pointer = (pointer + 1) % capacity;
+bool Buffer::takeDisplaced(Notification& out) {
+  if (!hasDisplaced) {
+    return false;
+  }
+  out = displacedNotification;
+  hasDisplaced = false;
+  return true;
+}
 
-      //   **  ( )
-      notification.setLeaveBufferTime();
+void Buffer::enableClasses(int count, ClassSelection selection, const std::vector<double>& weights) {
+  if (selection == ClassSelection::NONE || count < 1) {
+    return;
+  }
+  if (count > 64) {
+    throw std::invalid_argument("Классов уведомлений не больше 64");
+  }
+  classSelection = selection;
+  classCount = count;
+  classHead.assign(count, -1);
+  classNext.assign(capacity, -1);
+  classPrev.assign(capacity, -1);
+  classSize.assign(count, 0);
+  classMask = 0;
+  classPass.assign(count, 0.0);
+  classStride.assign(count, 1.0);
+  for (int cls = 0; cls < count && cls < static_cast<int>(weights.size()); cls++) {
+    if (weights[cls] > 0) {
+      classStride[cls] = 1.0 / weights[cls];
+    }
+  }
+  classLeaves = 1;
+  while (classLeaves < count) {
+    classLeaves <<= 1;
+  }
+  classTree.assign(2 * classLeaves, -1);
+  virtualPass = 0.0;
+  for (int i = 0; i < capacity; i++) {
+    if (occupied[i]) {
+      classLink(i);
+    }
+  }
+}
 
-      return notification;
+int Buffer::getClassCount() const {
+  return classCount;
+}
+
+int Buffer::getClassUsedSlots(int cls) const {
+  return (cls >= 0 && cls < classCount) ? classSize[cls] : 0;
+}
+
+void Buffer::enableCoalescing() {
+  coalescing = true;
+  std::size_t size = 1;
+  while (size < 2 * static_cast<std::size_t>(capacity)) {
+    size <<= 1; // Заполнение не больше половины - короткие цепочки пробирования
+  }
+  keyIndex.assign(size, -1);
+  for (int i = 0; i < capacity; i++) {
+    if (occupied[i] && notifications[i].isCoalescable()) {
+      indexInsert(i);
     }
-    pointer = (pointer + 1) % capacity;
-  } while (pointer != startPos);
+  }
+}
 
-  return Notification(0, 0); //   ,  isEmpty() 
+bool Buffer::isCoalescingEnabled() const {
+  return coalescing;
 }
 
 int Buffer::getPointer() const { return pointer; }
 int Buffer::getCapacity() const { return capacity; }
-int Buffer::getUsedSlots() const {
-  return std::count(occupied.begin(), occupied.end(), true);
-}
+int Buffer::getUsedSlots() const { return usedSlots; }
 
 const std::vector<Notification>& Buffer::getNotifications() const {
   return notifications;
@@ -103,4 +455,71 @@ const std::vector<Notification>& Buffer::getNotifications() const {
 
 const std::vector<bool>& Buffer::getOccupied() const {
   return occupied;
+}
+
+void Buffer::saveState(BinaryWriter& writer) const {
+  writer.writePod(capacity);
+  writer.writePod(pointer);
+  writer.writePod<unsigned long long>(notifications.size());
+  for (const auto& notification : notifications) {
+    notification.saveState(writer);
+  }
+  writer.writeBoolVector(occupied);
+  writer.writePodVector(sourceTtl);
+  expiryWheel.saveState(writer);
+  writer.writePod(coalescing); // Индекс ключей не пишется - строится заново по ячейкам
+  writer.writePod(holdDisplaced); // Вытесненное забирается в том же событии - между событиями его нет
+  writer.writePod(classSelection);
+  writer.writePod(classCount);
+  writer.writePodVector(classHead);
+  writer.writePodVector(classNext);
+  writer.writePodVector(classPrev);
+  writer.writePodVector(classSize);
+  writer.writePod(classMask);
+  writer.writePodVector(classPass);
+  writer.writePodVector(classStride);
+  writer.writePodVector(classTree);
+  writer.writePod(classLeaves);
+  writer.writePod(virtualPass);
+}
+
+void Buffer::loadState(BinaryReader& reader) {
+  reader.readPod(capacity);
+  reader.readPod(pointer);
+  notifications.resize(static_cast<std::size_t>(reader.readPod<unsigned long long>()));
+  for (auto& notification : notifications) {
+    notification.loadState(reader);
+  }
+  reader.readBoolVector(occupied);
+  reader.readPodVector(sourceTtl);
+  expiryWheel.loadState(reader);
+  usedSlots = 0;
+  occupancyWords.assign((occupied.size() + 63) / 64, 0);
+  for (std::size_t i = 0; i < occupied.size(); i++) {
+    if (occupied[i]) {
+      setOccupied(static_cast<int>(i), true);
+      usedSlots++;
+    }
+  }
+  bool savedCoalescing = false;
+  reader.readPod(savedCoalescing);
+  coalescing = false;
+  keyIndex.clear();
+  if (savedCoalescing) {
+    enableCoalescing();
+  }
+  reader.readPod(holdDisplaced);
+  hasDisplaced = false;
+  reader.readPod(classSelection);
+  reader.readPod(classCount);
+  reader.readPodVector(classHead);
+  reader.readPodVector(classNext);
+  reader.readPodVector(classPrev);
+  reader.readPodVector(classSize);
+  reader.readPod(classMask);
+  reader.readPodVector(classPass);
+  reader.readPodVector(classStride);
+  reader.readPodVector(classTree);
+  reader.readPod(classLeaves);
+  reader.readPod(virtualPass);
 }
\ No newline at end of file
@@ -2,19 +2,72 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
-#include "Notification.h" //   Notification
+#include "Notification.h" // Для хранения Notification
+#include "TimingWheel.h" // Для сроков жизни уведомлений
+#include "CommonTypes.h" // Для ClassSelection
+#include <cstdint>
 #include <vector>
 
-//   Database (forward declaration)
+// Предварительное объявление Database (forward declaration)
 class Database;
+class BinaryWriter;
+class BinaryReader;
 
-//   (   - 11)
+// Класс Буфера (с кольцевой организацией - Д1ОЗ1)
 class Buffer {
 private:
   int capacity;
-  int pointer; //      **    ** (11)
+  int pointer; // Указатель на следующую позицию для *поиска* свободного места при *добавлении* (Д1ОЗ1)
   std::vector<Notification> notifications;
-  std::vector<bool> occupied; //    
+  std::vector<bool> occupied; // Для отслеживания занятых ячеек
+  int usedSlots; // Число занятых ячеек - isFull/isEmpty без просмотра всего буфера
+  std::vector<std::uint64_t> occupancyWords; // Копия occupied по 64 ячейки в слове - быстрый поиск по кольцу
+  // --- Сроки жизни (TTL) ---
+  std::vector<double> sourceTtl; // TTL по номеру источника, 0 - без срока; пусто - TTL выключен
+  TimingWheel expiryWheel; // Таймер на ячейку: взводится при постановке, снимается при выборке и вытеснении
+  std::vector<int> expiredSlots; // Ячейки, истекшие за одно продвижение (без выделения памяти на шаг)
+  // --- Объединение (coalescing) ---
+  bool coalescing;
+  // Открытая адресация с линейным пробированием: номера ячеек буфера, -1 - пусто.
+  // Ключ (источник, устройство, ключ схлопывания) читается из самой ячейки; размер - степень двойки
+  // не меньше 2 * capacity, удаление сдвигом назад (без надгробий)
+  std::vector<int> keyIndex;
+  // --- Повторы ---
+  bool holdDisplaced; // Вытесненное не записывается как отказ, а отдается владельцу для повтора
+  bool hasDisplaced;
+  Notification displacedNotification; // Не больше одного вытесненного на одно добавление
+  // --- Классы уведомлений ---
+  // Общая емкость, но у каждого класса свое кольцо: двусвязный циклический список ячеек
+  // в порядке поступления (голова - самое раннее, хвост - последнее). Взять голову,
+  // снять хвост или любую ячейку (TTL) - O(1)
+  ClassSelection classSelection; // NONE - классов нет
+  int classCount;
+  std::vector<int> classHead; // -1 - класс пуст
+  std::vector<int> classNext; // Связи колец по номеру ячейки
+  std::vector<int> classPrev;
+  std::vector<int> classSize; // Занято ячеек классом
+  std::uint64_t classMask; // Непустые классы (до 64): высший - countr_zero, низший - по countl_zero
+  // WEIGHTED - шаговое планирование (stride): класс с наименьшим проходом, проход += 1 / вес.
+  // Минимум ищется турнирным деревом над классами - O(log classes) на выборку
+  std::vector<double> classPass;
+  std::vector<double> classStride;
+  std::vector<int> classTree; // Узел - класс с наименьшим проходом в поддереве, -1 - пусто; листья с classLeaves
+  int classLeaves;
+  double virtualPass; // Проход последней выборки - новый непустой класс не получает накопленного кредита
+
+  void setOccupied(int position, bool value);
+  int nextSlot(int from, bool wantOccupied) const; // Первая ячейка с нужным состоянием, от from по кольцу
+  void armExpiry(int position, const Notification& notification, double currentTime); // Таймер по TTL источника
+  std::size_t keySlot(const Notification& notification) const; // Исходная позиция ключа в keyIndex
+  int findCoalescable(const Notification& notification) const; // Ячейка с тем же ключом или -1
+  void indexInsert(int position);
+  void indexErase(int position); // До того, как ячейка будет перезаписана
+  void releaseSlot(int position); // Освободить ячейку: занятость, индекс ключей, таймер TTL, кольцо класса
+  int classOf(const Notification& notification) const; // Класс в пределах 0..classCount-1
+  void classLink(int position); // В хвост кольца своего класса
+  void classUnlink(int position);
+  void updateClassTree(int cls);
+  int selectClass(); // Класс следующей выборки (для WEIGHTED - со сдвигом прохода)
 
 public:
   Buffer(int capacity);
@@ -22,12 +75,42 @@ public:
   bool isFull() const;
   bool isEmpty() const;
 
-  //   (11 - )
-  //   Database     (14)
-  bool addNotification(Notification notification, Database* db = nullptr);
+  // Добавление уведомления (Д1ОЗ1 - кольцо)
+  // Теперь принимает Database для фиксации статистики вытеснения (Д1ОО4)
+  // В режиме объединения уведомление с ключом уже лежащего в буфере заменяет его содержимое
+  // на месте - новой ячейки не занимает и никого не вытесняет
+  bool addNotification(Notification notification, double currentTime, Database* db = nullptr);
+
+  // Выбор уведомления (Д2Б3 - кольцо)
+  Notification getNextNotification(double currentTime);
+
+  // Выбор до maxCount уведомлений подряд в порядке Д2Б3 (для пакетного канала) - дописываются в out.
+  // Возвращает число выбранных
+  int takeNotifications(int maxCount, double currentTime, std::vector<Notification>& out);
+
+  // Включить TTL до начала прогона: ttlBySource[номер источника] (0 - без срока),
+  // tickSize - тик колеса (0 - подобрать по самому короткому TTL)
+  void enableExpiry(const std::vector<double>& ttlBySource, double tickSize = 0.0);
+  bool isExpiryEnabled() const;
 
-  //   (23 - )
-  Notification getNextNotification();
+  // Режим повторов: вытесненное (Д1ОО4) забирается через takeDisplaced сразу после addNotification,
+  // решение "повтор или окончательный отказ" принимает владелец буфера
+  void enableDisplacementRetry();
+  bool takeDisplaced(Notification& out);
+
+  // Классы уведомлений под общей емкостью. Выбор: STRICT - высший непустой класс,
+  // WEIGHTED - доли по weights (пусто - поровну). Вытесняется последнее поступившее
+  // самого низкого непустого класса; если поступившее ниже всех в буфере - отказ ему самому
+  void enableClasses(int count, ClassSelection selection, const std::vector<double>& weights = {});
+  int getClassCount() const; // 0 - режим выключен
+  int getClassUsedSlots(int cls) const;
+
+  // Режим объединения по (источник, устройство, ключ схлопывания)
+  void enableCoalescing();
+  bool isCoalescingEnabled() const;
+  // Убрать из буфера уведомления со сроком <= currentTime (исход "истекло" в Database).
+  // Вызывается перед каждым событием - истечения между событиями выдаются пачкой. Возвращает их число
+  int expireNotifications(double currentTime, Database* db = nullptr);
 
   int getPointer() const;
   int getCapacity() const;
@@ -35,6 +118,10 @@ public:
 
   const std::vector<Notification>& getNotifications() const;
   const std::vector<bool>& getOccupied() const;
+
+  // Контрольная точка: ячейки, занятость, указатель, таймеры TTL и режим объединения (емкость берется из точки)
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
 };
 
 #endif // BUFFER_H
\ No newline at end of file
@@ -0,0 +1,331 @@
+// CapacityPlanner.cpp
+#include "CapacityPlanner.h"
+#include "PushNotificationSystem.h"
+#include "AnalyticalModel.h"
+#include "VarianceReduction.h" // Для comparisonVariant
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace {
+
+  enum class Verdict { FEASIBLE, INFEASIBLE, UNDECIDED };
+
+  // Реплики одной конфигурации: p_отк и 99-й процентиль T_ож каждой
+  struct Evaluation {
+    std::vector<double> rejection;
+    std::vector<double> waitP99;
+  };
+
+  double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) {
+      sum += value;
+    }
+    return values.empty() ? 0.0 : sum / values.size();
+  }
+
+  // При малом числе реплик нормальный квантиль занижает интервал - берется квантиль Стьюдента
+  // (доверительная вероятность 0.9), не меньше заданного tAlpha
+  double studentQuantile(std::size_t freedom, double tAlpha) {
+    static const double table[] = { 6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+      1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725 };
+    return freedom >= 1 && freedom <= 20 ? std::max(table[freedom - 1], tAlpha) : tAlpha;
+  }
+
+  double halfWidth(const std::vector<double>& values, double tAlpha) {
+    if (values.size() < 2) {
+      return 0.0;
+    }
+    tAlpha = studentQuantile(values.size() - 1, tAlpha);
+    double average = mean(values);
+    double squares = 0.0;
+    for (double value : values) {
+      squares += (value - average) * (value - average);
+    }
+    return tAlpha * std::sqrt(squares / (values.size() - 1) / values.size());
+  }
+
+  Verdict verdict(const std::vector<double>& values, double limit, double tAlpha) {
+    double average = mean(values);
+    double half = halfWidth(values, tAlpha);
+    if (average + half <= limit) {
+      return Verdict::FEASIBLE;
+    }
+    if (average - half > limit) {
+      return Verdict::INFEASIBLE;
+    }
+    return Verdict::UNDECIDED;
+  }
+
+  class Planner {
+  private:
+    const SimulationConfig& base;
+    const PlanSpec& spec;
+    unsigned threadCount;
+    std::map<std::tuple<int, int, std::string>, Evaluation> cache;
+    long long runs;
+
+    SimulationConfig configure(int channels, int buffer, const std::string& layout) const {
+      SimulationConfig config = comparisonVariant(base, "channels=" + std::to_string(channels));
+      config.bufferCapacity = buffer;
+      config.setPriorityScheme(layout);
+      config.snapshotInterval = 0;
+      return config;
+    }
+
+    // Реплики first..last-1 - параллельно, каждая на своем зерне
+    void runReplications(const SimulationConfig& config, int first, int last, Evaluation& evaluation) {
+      std::size_t offset = evaluation.rejection.size();
+      evaluation.rejection.resize(offset + (last - first));
+      evaluation.waitP99.resize(offset + (last - first));
+      std::atomic<int> next(first);
+      auto worker = [&]() {
+        for (int r = next.fetch_add(1); r < last; r = next.fetch_add(1)) {
+          SimulationConfig run = config;
+          run.seed = spec.seed + static_cast<unsigned>(r);
+          PushNotificationSystem system(run);
+          system.runHeadless();
+          const Database& database = system.getDatabase();
+          evaluation.rejection[offset + (r - first)] = database.getRejectionRate();
+          // Точная гистограмма (погрешность < 1/64, нули отдельно): корзины LatencyHistogram
+          // идут через два раза, и p99 у разных конфигураций совпадал бы с их границами
+          evaluation.waitP99[offset + (r - first)] = database.getWaitHistogram().quantile(0.99);
+        }
+      };
+      std::vector<std::thread> workers;
+      for (unsigned t = 0; t < std::min<unsigned>(threadCount, last - first); t++) {
+        workers.emplace_back(worker);
+      }
+      for (auto& thread : workers) {
+        thread.join();
+      }
+      runs += last - first;
+    }
+
+    // Реплики удваиваются, пока решение по выбранному ограничению (или по обоим) не однозначно
+    const Evaluation& evaluate(int channels, int buffer, const std::string& layout, bool withWait) {
+      Evaluation& evaluation = cache[std::make_tuple(channels, buffer, layout)];
+      SimulationConfig config = configure(channels, buffer, layout);
+      int have = static_cast<int>(evaluation.rejection.size());
+      int cached = have;
+      if (have < spec.replications) {
+        runReplications(config, have, spec.replications, evaluation);
+      }
+      for (;;) {
+        Verdict rejection = verdict(evaluation.rejection, spec.maxRejection, spec.tAlpha);
+        Verdict wait = withWait ? verdict(evaluation.waitP99, spec.maxWaitP99, spec.tAlpha) : Verdict::FEASIBLE;
+        bool decided = rejection == Verdict::INFEASIBLE || wait == Verdict::INFEASIBLE
+          || (rejection == Verdict::FEASIBLE && wait == Verdict::FEASIBLE);
+        have = static_cast<int>(evaluation.rejection.size());
+        if (decided || have >= spec.maxReplications) {
+          break;
+        }
+        runReplications(config, have, std::min(2 * have, spec.maxReplications), evaluation);
+      }
+      if (static_cast<int>(evaluation.rejection.size()) > cached) {
+        report(channels, buffer, layout, evaluation); // Повторный запрос без новых реплик не печатается
+      }
+      return evaluation;
+    }
+
+    void report(int channels, int buffer, const std::string& layout, const Evaluation& evaluation) const {
+      std::cout << std::setw(7) << channels << " | " << std::setw(5) << buffer << " | " << std::setw(6) << layout << " | "
+        << std::setw(6) << evaluation.rejection.size() << " | "
+        << std::fixed << std::setprecision(5) << std::setw(8) << mean(evaluation.rejection) << " +- "
+        << std::setw(7) << halfWidth(evaluation.rejection, spec.tAlpha) << " | "
+        << std::setprecision(3) << std::setw(8) << mean(evaluation.waitP99) << " +- "
+        << std::setw(6) << halfWidth(evaluation.waitP99, spec.tAlpha) << std::defaultfloat << "\n";
+    }
+
+    // Решение неоднозначно и после всех реплик - конфигурация не принимается (осторожная сторона)
+    bool rejectionMet(int channels, int buffer, const std::string& layout) {
+      return verdict(evaluate(channels, buffer, layout, false).rejection, spec.maxRejection, spec.tAlpha) == Verdict::FEASIBLE;
+    }
+
+    // Наименьший K с выполненным ограничением p_отк; -1 - нет и при maxBuffer
+    int smallestBuffer(int channels, const std::string& layout) {
+      // Буфер хотя бы на одно место: без него модель не работает (SimulationConfig отвергает buffer < 1)
+      int lo = 1;
+      int hi = spec.maxBuffer;
+      bool hiChecked = false;
+      SimulationConfig probe = configure(channels, 1, layout);
+      AnalyticalEstimate estimate = estimateAnalytically(probe);
+      if (estimate.applicable) {
+        probe.bufferCapacity = spec.maxBuffer;
+        double largest = estimateAnalytically(probe).rejection;
+        if (largest > 3.0 * spec.maxRejection) {
+          std::cout << std::setw(7) << channels << " | " << std::setw(5) << spec.maxBuffer << " | " << std::setw(6) << layout
+            << " | по аналитической оценке p_отк = " << largest << " - без прогона\n";
+          return -1;
+        }
+        // Вилка вокруг аналитического K: модель приближенная, границы проверяются прогоном
+        for (probe.bufferCapacity = 1; probe.bufferCapacity < spec.maxBuffer; probe.bufferCapacity++) {
+          if (estimateAnalytically(probe).rejection <= spec.maxRejection) {
+            break;
+          }
+        }
+        int guess = probe.bufferCapacity;
+        int upper = std::min(spec.maxBuffer, guess + guess / 2 + 1);
+        hiChecked = upper == spec.maxBuffer;
+        if (rejectionMet(channels, upper, layout)) {
+          hi = upper;
+          hiChecked = true;
+          int lower = std::max(1, guess / 2);
+          if (lower < upper) {
+            if (rejectionMet(channels, lower, layout)) {
+              hi = lower;
+            }
+            else {
+              lo = lower + 1;
+            }
+          }
+        }
+        else if (hiChecked) {
+          return -1; // Не выполнено и при наибольшем буфере
+        }
+        else {
+          lo = upper + 1;
+        }
+      }
+      if (!hiChecked && !rejectionMet(channels, hi, layout)) {
+        return -1;
+      }
+      while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (rejectionMet(channels, mid, layout)) {
+          hi = mid;
+        }
+        else {
+          lo = mid + 1;
+        }
+      }
+      return hi;
+    }
+
+  public:
+    Planner(const SimulationConfig& base, const PlanSpec& spec)
+      : base(base), spec(spec), threadCount(spec.threads > 0 ? spec.threads : std::max(1u, std::thread::hardware_concurrency())),
+      cache(), runs(0) {}
+
+    PlanCandidate run() {
+      double channelCost = base.autoscale.channelCost;
+      PlanCandidate best{ 0, 0, "", 0.0, false, 0.0, 0.0, 0.0, 0.0, 0 };
+      std::cout << "Каналов | Буфер | Схема  | Реплик | p_отк               | T_ож p99\n";
+      std::cout << "--------|-------|--------|--------|---------------------|-----------------\n";
+      for (int channels = std::max(1, spec.minChannels); channels <= spec.maxChannels; channels++) {
+        if (best.feasible && channels * channelCost >= best.cost) {
+          break; // Даже без буфера не дешевле найденного
+        }
+        for (const auto& layout : spec.layouts) {
+          int buffer = smallestBuffer(channels, layout);
+          if (buffer < 0) {
+            continue;
+          }
+          // Процентиль T_ож у наименьшего подходящего буфера; больший буфер его только увеличит
+          const Evaluation& evaluation = evaluate(channels, buffer, layout, true);
+          if (verdict(evaluation.rejection, spec.maxRejection, spec.tAlpha) != Verdict::FEASIBLE
+            || verdict(evaluation.waitP99, spec.maxWaitP99, spec.tAlpha) != Verdict::FEASIBLE) {
+            continue;
+          }
+          double cost = channels * channelCost + buffer * spec.slotCost;
+          double rejection = mean(evaluation.rejection);
+          // Равная стоимость - лучшая по p_отк расстановка (на общих случайных числах сравнение парное)
+          if (!best.feasible || cost < best.cost || (cost == best.cost && rejection < best.rejection)) {
+            best = PlanCandidate{ channels, buffer, layout, cost, true, rejection, halfWidth(evaluation.rejection, spec.tAlpha),
+              mean(evaluation.waitP99), halfWidth(evaluation.waitP99, spec.tAlpha), static_cast<int>(evaluation.rejection.size()) };
+          }
+        }
+      }
+      std::cout << "Оценено конфигураций: " << cache.size() << ", прогонов: " << runs << "\n";
+      return best;
+    }
+  };
+
+}
+
+void PlanSpec::setParameter(const std::string& assignment) {
+  std::size_t equals = assignment.find('=');
+  if (equals == std::string::npos) {
+    throw std::invalid_argument("Параметр планировщика задается как имя=значение: " + assignment);
+  }
+  std::string name = assignment.substr(0, equals);
+  std::string value = assignment.substr(equals + 1);
+  if (name == "rejection") {
+    maxRejection = std::stod(value);
+  }
+  else if (name == "wait99") {
+    maxWaitP99 = std::stod(value);
+  }
+  else if (name == "channels") {
+    std::size_t colon = value.find(':');
+    minChannels = std::stoi(value.substr(0, colon));
+    maxChannels = colon == std::string::npos ? minChannels : std::stoi(value.substr(colon + 1));
+  }
+  else if (name == "buffer") {
+    maxBuffer = std::max(1, std::stoi(value));
+  }
+  else if (name == "layouts") {
+    layouts.clear();
+    std::stringstream stream(value);
+    std::string layout;
+    while (std::getline(stream, layout, ',')) {
+      layouts.push_back(layout);
+    }
+  }
+  else if (name == "reps") {
+    replications = std::max(2, std::stoi(value));
+  }
+  else if (name == "max_reps") {
+    maxReplications = std::stoi(value);
+  }
+  else if (name == "slot_cost") {
+    slotCost = std::stod(value);
+  }
+  else if (name == "seed") {
+    seed = static_cast<unsigned>(std::stoul(value));
+  }
+  else if (name == "threads") {
+    threads = static_cast<unsigned>(std::stoul(value));
+  }
+  else {
+    throw std::invalid_argument("Неизвестный параметр планировщика: " + name);
+  }
+  maxReplications = std::max(maxReplications, replications);
+}
+
+PlanCandidate planCapacity(const SimulationConfig& base, const PlanSpec& spec) {
+  if (base.channels.empty() || spec.layouts.empty()) {
+    throw std::invalid_argument("Планировщику нужен сценарий с каналами и хотя бы одна схема приоритетов");
+  }
+  return Planner(base, spec).run();
+}
+
+bool verifyPlanner(unsigned threads) {
+  SimulationConfig base = SimulationConfig::variant17(3, 5, 3, 100000, 17);
+  PlanSpec spec;
+  spec.maxRejection = 0.01;
+  spec.maxWaitP99 = 15.0;
+  spec.minChannels = 11;
+  spec.maxChannels = 14;
+  spec.threads = threads;
+  PlanCandidate tiny = planCapacity(base, spec);
+  bool tinyOk = tiny.feasible && tiny.channels == 11 && tiny.bufferCapacity == 1;
+
+  spec.minChannels = 3;
+  spec.maxChannels = 3;
+  spec.maxBuffer = 1;
+  PlanCandidate limited = planCapacity(base, spec);
+  bool limitedOk = !limited.feasible;
+
+  std::cout << "Наименьший буфер - одно место (11 каналов, буфер " << tiny.bufferCapacity << "): " << (tinyOk ? "да" : "нет") << "\n"
+    << "При buffer=1 и 3 каналах ограничение не выполнено: " << (limitedOk ? "да" : "нет") << "\n";
+  return tinyOk && limitedOk;
+}
\ No newline at end of file
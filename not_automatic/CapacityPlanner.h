@@ -0,0 +1,55 @@
+// CapacityPlanner.h
+#ifndef CAPACITY_PLANNER_H
+#define CAPACITY_PLANNER_H
+
+#include "SimulationConfig.h"
+#include <string>
+#include <vector>
+
+// Поиск самой дешевой конфигурации (каналов, мест в буфере, расстановки приоритетов),
+// при которой p_отк <= maxRejection и 99-й процентиль T_ож <= maxWaitP99.
+// Поток источников и закон обслуживания - из сценария; добавленные каналы - копии последнего
+struct PlanSpec {
+  double maxRejection = 0.01;
+  double maxWaitP99 = 10.0;
+  int minChannels = 1;
+  int maxChannels = 12;
+  int maxBuffer = 64;
+  std::vector<std::string> layouts = { "asc" }; // Схемы приоритетов (SimulationConfig::setPriorityScheme)
+  int replications = 8; // Начальное число реплик оценки
+  int maxReplications = 64; // Реплики удваиваются, пока решение не станет однозначным
+  double slotCost = 0.1; // Стоимость места в буфере; канала - [autoscale] cost сценария
+  double tAlpha = 1.643; // Доверительная вероятность 0.9, как T_ALPHA в automatic/CMO.py (при малом числе реплик - по Стьюденту)
+  unsigned seed = 17; // Реплика r всех конфигураций - на зерне seed + r (общие случайные числа)
+  unsigned threads = 0; // Реплики оценки - параллельно; 0 - по числу ядер
+
+  // "имя=значение": rejection, wait99, channels (от:до), buffer, layouts, reps, max_reps, slot_cost, seed, threads
+  void setParameter(const std::string& assignment);
+};
+
+struct PlanCandidate {
+  int channels;
+  int bufferCapacity;
+  std::string layout;
+  double cost;
+  bool feasible; // Оба ограничения выполнены с доверительной вероятностью tAlpha (по верхним границам)
+  double rejection;
+  double rejectionHalf; // Полуширина интервала по репликам
+  double waitP99;
+  double waitP99Half;
+  int replications;
+};
+
+// Для каждого числа каналов (по возрастанию, пока оно само не дороже найденного) - наименьший буфер
+// с выполненным ограничением p_отк: бисекция по монотонному p_отк(K), начальная вилка - по аналитической
+// оценке (AnalyticalModel). У наименьшего буфера проверяется процентиль T_ож - он с ростом K только растет.
+// Зашумленные решения - последовательно: реплики удваиваются, пока интервал не окажется по одну сторону
+// порога; среди расстановок с одинаковой стоимостью выбирается лучшая по p_отк.
+// Печатает ход поиска; feasible = false - ни одна конфигурация в пределах не подошла
+PlanCandidate planCapacity(const SimulationConfig& base, const PlanSpec& spec);
+
+// Самопроверка на Варианте 17: при 11+ каналах p_отк <= 0.01 уже при одном месте в буфере, и поиск
+// не должен опускаться до пустого буфера; при buffer=1 и 3 каналах - честный отказ. true - оба случая верны
+bool verifyPlanner(unsigned threads);
+
+#endif // CAPACITY_PLANNER_H
\ No newline at end of file
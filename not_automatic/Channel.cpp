@@ -1,32 +1,95 @@
 // Channel.cpp
 #include "Channel.h"
-#include <stdexcept> //  throw
+#include "Checkpoint.h"
+#include <stdexcept> // Для throw
 
-Channel::Channel(int id, int priority, double minTime, double maxTime)
+Channel::Channel(int id, int priority, double minTime, double maxTime, unsigned seed)
   : id(id), priority(priority), isBusy(false), serviceTimeMin(minTime), serviceTimeMax(maxTime),
-  rng(std::random_device()()), uniformDist(minTime, maxTime) {
+  serviceLaw(ServiceLaw::UNIFORM), serviceTimeMean((minTime + maxTime) / 2), rng(seed),
+  uniformDist(minTime, maxTime), expDist(1.0),
+  batchLimit(1), batchSetup(0.0), batchPerItem(0.0) {
+}
+
+Channel::Channel(const ChannelConfig& config, unsigned seed)
+  : id(config.id), priority(config.priority), isBusy(false),
+  serviceTimeMin(config.minServiceTime), serviceTimeMax(config.maxServiceTime),
+  serviceLaw(config.serviceLaw), serviceTimeMean(config.meanServiceTime), rng(seed),
+  uniformDist(config.minServiceTime, config.maxServiceTime),
+  expDist(config.meanServiceTime > 0 ? 1.0 / config.meanServiceTime : 1.0),
+  batchLimit(config.batchSize > 1 ? config.batchSize : 1), batchSetup(config.batchSetup), batchPerItem(config.batchPerItem) {
+  if (batchLimit > 1) {
+    batch.reserve(batchLimit);
+  }
 }
 
 int Channel::getId() const { return id; }
+void Channel::reseed(unsigned seed) { rng.seed(seed); }
+void Channel::setAntithetic(bool enabled) { rng.setAntithetic(enabled); }
 int Channel::getPriority() const { return priority; }
 bool Channel::isChannelBusy() const { return isBusy; }
 
-double Channel::startProcessing(Notification notification) {
+double Channel::getExpectedServiceTime() const {
+  if (batchLimit > 1) {
+    return (batchSetup + batchPerItem * batchLimit) / batchLimit;
+  }
+  return serviceLaw == ServiceLaw::UNIFORM ? (serviceTimeMin + serviceTimeMax) / 2 : serviceTimeMean;
+}
+
+double Channel::startProcessing(Notification notification, double currentTime) {
   if (isBusy) {
     throw std::runtime_error("Channel is already busy");
   }
 
+  if (batchLimit > 1) {
+    batch.assign(1, notification);
+    return startBatch(batch, currentTime);
+  }
+
   isBusy = true;
   currentNotification = notification;
-  currentNotification.setEnterChannelTime(); //     
+  currentNotification.setEnterChannelTime(currentTime); // Устанавливаем время входа в канал
   currentNotification.setStatus(NotificationStatus::PROCESSING);
 
-  //    (32 - )
-  return uniformDist(rng);
+  // Генерируем время обслуживания (П32 - равномерное, либо закон из сценария)
+  switch (serviceLaw) {
+  case ServiceLaw::EXPONENTIAL:
+    return expDist(rng);
+  case ServiceLaw::CONSTANT:
+    return serviceTimeMean;
+  default:
+    return uniformDist(rng);
+  }
+}
+
+double Channel::startBatch(const std::vector<Notification>& notifications, double currentTime) {
+  if (isBusy) {
+    throw std::runtime_error("Channel is already busy");
+  }
+  if (notifications.empty()) {
+    throw std::invalid_argument("Empty batch");
+  }
+
+  isBusy = true;
+  if (&notifications != &batch) {
+    batch.assign(notifications.begin(), notifications.end());
+  }
+  for (auto& notification : batch) {
+    notification.setEnterChannelTime(currentTime);
+    notification.setStatus(NotificationStatus::PROCESSING);
+  }
+  currentNotification = batch.front();
+  return batchSetup + batchPerItem * static_cast<double>(batch.size());
+}
+
+int Channel::getBatchLimit() const { return batchLimit; }
+
+const std::vector<Notification>& Channel::getBatch() const {
+  return batch;
 }
 
 void Channel::freeChannel() {
   isBusy = false;
+  batch.clear();
 }
 
 Notification Channel::getCurrentNotification() const {
@@ -39,4 +102,46 @@ int Channel::getCurrentNotificationId() const {
 
 int Channel::getCurrentNotificationSourceId() const {
   return currentNotification.getSourceId();
+}
+
+void Channel::saveState(BinaryWriter& writer) const {
+  writer.writePod(id);
+  writer.writePod(priority);
+  writer.writePod(isBusy);
+  currentNotification.saveState(writer);
+  writer.writePod(serviceTimeMin);
+  writer.writePod(serviceTimeMax);
+  writer.writePod(serviceLaw);
+  writer.writePod(serviceTimeMean);
+  writer.writePod(rng);
+  writer.writePod(uniformDist);
+  writer.writePod(expDist);
+  writer.writePod(batchLimit);
+  writer.writePod(batchSetup);
+  writer.writePod(batchPerItem);
+  writer.writePod<unsigned long long>(batch.size());
+  for (const auto& notification : batch) {
+    notification.saveState(writer);
+  }
+}
+
+void Channel::loadState(BinaryReader& reader) {
+  reader.readPod(id);
+  reader.readPod(priority);
+  reader.readPod(isBusy);
+  currentNotification.loadState(reader);
+  reader.readPod(serviceTimeMin);
+  reader.readPod(serviceTimeMax);
+  reader.readPod(serviceLaw);
+  reader.readPod(serviceTimeMean);
+  reader.readPod(rng);
+  reader.readPod(uniformDist);
+  reader.readPod(expDist);
+  reader.readPod(batchLimit);
+  reader.readPod(batchSetup);
+  reader.readPod(batchPerItem);
+  batch.resize(static_cast<std::size_t>(reader.readPod<unsigned long long>()));
+  for (auto& notification : batch) {
+    notification.loadState(reader);
+  }
 }
\ No newline at end of file
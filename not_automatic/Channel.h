@@ -3,28 +3,53 @@
 #define CHANNEL_H
 
 #include "Notification.h"
+#include "SimulationConfig.h" // Для ChannelConfig
+#include "RandomEngine.h"
 #include <random>
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
 
 class Channel {
 private:
   int id;
-  int priority; //   (21 -   )
+  int priority; // Приоритет канала (Д2П1 - выбор по приоритету)
   bool isBusy;
   Notification currentNotification;
   double serviceTimeMin;
   double serviceTimeMax;
-  std::mt19937 rng;
-  std::uniform_real_distribution<double> uniformDist; //    (32)
+  ServiceLaw serviceLaw;
+  double serviceTimeMean; // Для EXPONENTIAL и CONSTANT
+  RandomEngine rng;
+  std::uniform_real_distribution<double> uniformDist; // Для времени обслуживания (П32)
+  std::exponential_distribution<double> expDist;
+  // --- Пакетное обслуживание ---
+  int batchLimit; // Сколько уведомлений канал забирает за один захват, 1 - по одному
+  double batchSetup; // Время пачки из n: batchSetup + n * batchPerItem
+  double batchPerItem;
+  std::vector<Notification> batch; // Текущая пачка (в пакетном режиме); currentNotification - ее первое
 
 public:
-  Channel(int id, int priority, double minTime, double maxTime);
+  Channel(int id, int priority, double minTime, double maxTime, unsigned seed = std::random_device()());
+  Channel(const ChannelConfig& config, unsigned seed);
 
   int getId() const;
+  void reseed(unsigned seed); // Новый поток случайных чисел с текущего состояния (клон траектории)
+  void setAntithetic(bool enabled); // Поток выдает 1 - U (см. RandomEngine)
   int getPriority() const;
+  double getExpectedServiceTime() const; // Среднее по закону обслуживания; для пакетного - на уведомление полной пачки
   bool isChannelBusy() const;
 
-  //   ,   
-  double startProcessing(Notification notification);
+  // Начать обработку уведомления, возвращает время обслуживания
+  // (в пакетном режиме - как пачки из одного)
+  double startProcessing(Notification notification, double currentTime);
+
+  // Начать обработку пачки (в порядке выборки из буфера), возвращает время пачки.
+  // Все уведомления пачки входят в канал и завершаются вместе
+  double startBatch(const std::vector<Notification>& notifications, double currentTime);
+  int getBatchLimit() const; // 1 - канал не пакетный
+  const std::vector<Notification>& getBatch() const;
 
   void freeChannel();
 
@@ -33,6 +58,10 @@ public:
   int getCurrentNotificationId() const;
 
   int getCurrentNotificationSourceId() const;
+
+  // Контрольная точка: занятость, текущее уведомление и состояние генератора
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
 };
 
 #endif // CHANNEL_H
\ No newline at end of file
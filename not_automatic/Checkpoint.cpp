@@ -0,0 +1,109 @@
+// Checkpoint.cpp
+#include "Checkpoint.h"
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --- BinaryWriter ---
+BinaryWriter::BinaryWriter() : data() {}
+
+void BinaryWriter::writeBoolVector(const std::vector<bool>& values) {
+  writePod<unsigned long long>(values.size());
+  for (bool value : values) {
+    data.push_back(value ? 1 : 0);
+  }
+}
+
+void BinaryWriter::writeString(const std::string& value) {
+  writePod<unsigned long long>(value.size());
+  data.insert(data.end(), value.begin(), value.end());
+}
+
+const std::vector<char>& BinaryWriter::getData() const { return data; }
+
+void BinaryWriter::clear() { data.clear(); }
+
+void BinaryWriter::saveToFile(const std::string& path) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Не удалось открыть файл контрольной точки: " + path);
+  }
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!out) {
+    throw std::runtime_error("Ошибка записи контрольной точки: " + path);
+  }
+}
+
+// --- BinaryReader ---
+BinaryReader::BinaryReader(const char* data, std::size_t size) : cursor(data), end(data + size) {}
+
+void BinaryReader::readBoolVector(std::vector<bool>& values) {
+  std::size_t count = static_cast<std::size_t>(readPod<unsigned long long>());
+  require(count);
+  values.assign(count, false);
+  for (std::size_t i = 0; i < count; i++) {
+    values[i] = cursor[i] != 0;
+  }
+  cursor += count;
+}
+
+std::string BinaryReader::readString() {
+  std::size_t count = static_cast<std::size_t>(readPod<unsigned long long>());
+  require(count);
+  std::string value(cursor, count);
+  cursor += count;
+  return value;
+}
+
+bool BinaryReader::atEnd() const { return cursor == end; }
+
+// --- MappedFile ---
+MappedFile::MappedFile(const std::string& path) : mapped(nullptr), size(0), fallback() {
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Не удалось открыть контрольную точку: " + path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Не удалось получить размер контрольной точки: " + path);
+  }
+  size = static_cast<std::size_t>(info.st_size);
+  if (size > 0) {
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      mapped = static_cast<const char*>(address);
+    }
+  }
+  ::close(fd);
+  if (mapped || size == 0) {
+    return;
+  }
+#endif
+  // Запасной путь - обычное чтение файла в память
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    throw std::runtime_error("Не удалось открыть контрольную точку: " + path);
+  }
+  size = static_cast<std::size_t>(in.tellg());
+  fallback.resize(size);
+  in.seekg(0);
+  in.read(fallback.data(), static_cast<std::streamsize>(size));
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+  if (mapped) {
+    ::munmap(const_cast<char*>(mapped), size);
+  }
+#endif
+}
+
+const char* MappedFile::data() const { return mapped ? mapped : fallback.data(); }
+std::size_t MappedFile::getSize() const { return size; }
\ No newline at end of file
@@ -0,0 +1,151 @@
+// Checkpoint.h
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Двоичная запись состояния модели (контрольные точки).
+// Формат - сырые байты в порядке машины: файл читается той же сборкой, что его записала
+class BinaryWriter {
+private:
+  std::vector<char> data;
+
+public:
+  BinaryWriter();
+
+  template <typename T>
+  void writePod(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "writePod: тип должен быть тривиально копируемым");
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+  }
+
+  template <typename T>
+  void writePodVector(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value, "writePodVector: тип должен быть тривиально копируемым");
+    writePod<unsigned long long>(values.size());
+    const char* bytes = reinterpret_cast<const char*>(values.data());
+    data.insert(data.end(), bytes, bytes + values.size() * sizeof(T));
+  }
+
+  // Массив без префикса длины (длина записана отдельно)
+  template <typename T>
+  void writePodArray(const T* values, std::size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "writePodArray: тип должен быть тривиально копируемым");
+    const char* bytes = reinterpret_cast<const char*>(values);
+    data.insert(data.end(), bytes, bytes + count * sizeof(T));
+  }
+
+  template <typename K, typename V>
+  void writeMap(const std::map<K, V>& values) {
+    writePod<unsigned long long>(values.size());
+    for (const auto& entry : values) {
+      writePod(entry.first);
+      writePod(entry.second);
+    }
+  }
+
+  void writeBoolVector(const std::vector<bool>& values);
+  void writeString(const std::string& value);
+
+  const std::vector<char>& getData() const;
+  void clear();
+  void saveToFile(const std::string& path) const;
+};
+
+// Чтение состояния из непрерывного блока памяти (отображенный файл или буфер)
+class BinaryReader {
+private:
+  const char* cursor;
+  const char* end;
+
+  void require(std::size_t bytes) const {
+    if (static_cast<std::size_t>(end - cursor) < bytes) {
+      throw std::runtime_error("Контрольная точка повреждена или обрезана");
+    }
+  }
+
+  // count элементов по size байт: сравнение без умножения - испорченный count не переполнит size_t
+  void require(std::size_t count, std::size_t size) const {
+    if (count > static_cast<std::size_t>(end - cursor) / size) {
+      throw std::runtime_error("Контрольная точка повреждена или обрезана");
+    }
+  }
+
+public:
+  BinaryReader(const char* data, std::size_t size);
+
+  template <typename T>
+  T readPod() {
+    static_assert(std::is_trivially_copyable<T>::value, "readPod: тип должен быть тривиально копируемым");
+    require(sizeof(T));
+    T value;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return value;
+  }
+
+  template <typename T>
+  void readPod(T& value) {
+    value = readPod<T>();
+  }
+
+  template <typename T>
+  void readPodVector(std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value, "readPodVector: тип должен быть тривиально копируемым");
+    std::size_t count = static_cast<std::size_t>(readPod<unsigned long long>());
+    require(count, sizeof(T));
+    values.resize(count);
+    std::memcpy(values.data(), cursor, count * sizeof(T));
+    cursor += count * sizeof(T);
+  }
+
+  template <typename T>
+  void readPodArray(T* values, std::size_t count) {
+    static_assert(std::is_trivially_copyable<T>::value, "readPodArray: тип должен быть тривиально копируемым");
+    require(count, sizeof(T));
+    std::memcpy(values, cursor, count * sizeof(T));
+    cursor += count * sizeof(T);
+  }
+
+  template <typename K, typename V>
+  void readMap(std::map<K, V>& values) {
+    values.clear();
+    std::size_t count = static_cast<std::size_t>(readPod<unsigned long long>());
+    for (std::size_t i = 0; i < count; i++) {
+      K key = readPod<K>();
+      V value = readPod<V>();
+      values.emplace_hint(values.end(), key, value);
+    }
+  }
+
+  void readBoolVector(std::vector<bool>& values);
+  std::string readString();
+
+  bool atEnd() const;
+};
+
+// Файл, отображенный в память только для чтения (mmap). Там, где mmap нет, читается целиком
+class MappedFile {
+private:
+  const char* mapped;
+  std::size_t size;
+  std::vector<char> fallback;
+
+public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* data() const;
+  std::size_t getSize() const;
+};
+
+#endif // CHECKPOINT_H
\ No newline at end of file
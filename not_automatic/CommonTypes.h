@@ -2,40 +2,51 @@
 #ifndef COMMON_TYPES_H
 #define COMMON_TYPES_H
 
+#include "Event.h" // Event, EventComparator, EventQueue
 #include <chrono>
 #include <string>
-#include <functional> //  std::function
+#include <vector>
+#include <functional> // Для std::function
 
-//   ()
+// Статусы уведомлений (Заявок)
 enum class NotificationStatus {
   CREATED,
   BUFFERED,
   PROCESSING,
   PROCESSED,
-  REJECTED
+  REJECTED,
+  EXPIRED, // Срок жизни (TTL) истек в буфере
+  THROTTLED // Не пропущено ограничением интенсивности источника на входе
 };
 
-//  
-struct Event {
-  double time;
-  std::string type; // "GEN", "FREE_CHAN"
-  int sourceId;     //   
-  int notificationId; //   
-  int channelId;    //    
+// Закон времени обслуживания канала
+enum class ServiceLaw {
+  UNIFORM,     // Равномерное на [min, max] (П32)
+  EXPONENTIAL, // Экспоненциальное со средним mean
+  CONSTANT     // Постоянное, равное mean
+};
 
-  Event(double t, const std::string& tp, int src = -1, int nid = -1, int cid = -1)
-    : time(t), type(tp), sourceId(src), notificationId(nid), channelId(cid) {
-  }
+// Выбор из буфера с классами уведомлений (0 - высший класс)
+enum class ClassSelection {
+  NONE,     // Классов нет - одно кольцо Д2Б3
+  STRICT,   // Всегда самый высокий непустой класс
+  WEIGHTED  // Взвешенно-справедливо: доля выборок класса пропорциональна его весу
 };
 
-//   std::priority_queue (min-heap  )
-struct EventComparator {
-  bool operator()(const Event& a, const Event& b) const {
-    return a.time > b.time; // min-heap  
-  }
+// Выбор свободного канала диспетчером постановки
+enum class DispatchPolicy {
+  PRIORITY,       // Д2П1 - наивысший приоритет среди свободных
+  SHORTEST_QUEUE, // JSQ: очередей у каналов нет, у всех свободных длина 0 - из них дольше всех простаивающий
+  POWER_OF_D,     // d случайных каналов, из свободных - с наименьшей накопленной занятостью
+  FASTEST         // Наименьшее ожидаемое время обслуживания (для пакетного - на одно уведомление полной пачки)
 };
 
-//    
-using EventQueue = std::priority_queue<Event, std::vector<Event>, EventComparator>;
+// Политика автомасштабирования пула каналов
+enum class ScalingPolicy {
+  NONE,           // Каналы фиксированы
+  THRESHOLD,      // Пороги заполнения буфера и доли отказов: +step / -step
+  PID,            // ПИД-регулятор заполнения буфера (скоростная форма)
+  TARGET_TRACKING // Число каналов под целевую загрузку: ceil(текущее * загрузка / цель)
+};
 
 #endif // COMMON_TYPES_H
\ No newline at end of file
@@ -1,234 +1,603 @@
 // Database.cpp
 #include "Database.h"
+#include "Checkpoint.h"
 #include <iostream>
 #include <iomanip>
-#include <cmath> //  sqrt,   stddev
+#include <algorithm> // Для std::max
+#include <cmath> // Для sqrt, если понадобится stddev
+#include <stdexcept>
 
-Database::Database() : deliveredCount(0), rejectedCount(0) {}
+namespace {
+
+  template <typename T>
+  void addInto(std::vector<T>& target, const std::vector<T>& other) {
+    for (std::size_t i = 0; i < target.size() && i < other.size(); i++) {
+      target[i] += other[i];
+    }
+  }
+
+  // Обнуление без освобождения памяти - сброс статистики идет внутри цикла событий
+  template <typename T>
+  void zeroFill(std::vector<T>& values) {
+    std::fill(values.begin(), values.end(), T());
+  }
+
+  template <typename Resettable>
+  void resetAll(std::vector<Resettable>& items) {
+    for (auto& item : items) {
+      item.reset();
+    }
+  }
+
+  template <typename Histogram>
+  void mergeInto(std::vector<Histogram>& target, const std::vector<Histogram>& other) {
+    for (std::size_t i = 0; i < target.size() && i < other.size(); i++) {
+      target[i].merge(other[i]);
+    }
+  }
+
+}
+
+Database::Database(int numSources, int numChannels)
+  : numSources(numSources), numChannels(numChannels), deliveredCount(0), rejectedCount(0), expiredCount(0), coalescedCount(0), retryCount(0), throttledCount(0), forwardedCount(0), statisticsStart(0.0),
+  sourceGeneratedCount(numSources + 1), sourceDelivered(numSources + 1), sourceRejected(numSources + 1), sourceExpired(numSources + 1),
+  sourceCoalesced(numSources + 1), sourceRetries(numSources + 1), sourceThrottled(numSources + 1), sourceForwarded(numSources + 1),
+  sourceTotalWaitTime(numSources + 1), sourceTotalWaitTimeSquared(numSources + 1), sourceWaitedCount(numSources + 1),
+  sourceTotalServiceTime(numSources + 1), sourceTotalServiceTimeSquared(numSources + 1), sourceServicedCount(numSources + 1),
+  sourceTotalSystemTime(numSources + 1), sourceTotalSystemTimeSquared(numSources + 1), sourceProcessedCount(numSources + 1),
+  channelUsage(numChannels + 1), channelTotalServiceTime(numChannels + 1), channelTotalServiceTimeSquared(numChannels + 1),
+  channelBatchItems(numChannels + 1), channelBufferDrained(numChannels + 1),
+  channelOnlineSince(numChannels + 1, -1.0), channelOnlineTime(numChannels + 1),
+  sourceWaitHistogram(numSources + 1), sourceServiceHistogram(numSources + 1),
+  numClasses(0), batchCapacity(0), batchTAlpha(0.0),
+  series(numSources, numChannels), snapshotRow(4 * numSources + numChannels) {}
+
+bool Database::isSource(int sourceId) const { return sourceId >= 1 && sourceId <= numSources; }
+bool Database::isChannel(int channelId) const { return channelId >= 1 && channelId <= numChannels; }
 
 void Database::recordDelivery(const Notification& notification, double serviceTime, int channelId) {
+  recordSourceDelivery(notification, serviceTime);
+
+  // --- Учёт канала ---
+  channelUsage[channelId]++;
+  channelTotalServiceTime[channelId] += serviceTime;
+  channelTotalServiceTimeSquared[channelId] += serviceTime * serviceTime;
+  // -----------------
+}
+
+void Database::recordBatchDelivery(const std::vector<Notification>& batch, double batchTime, int channelId, int fromBuffer) {
+  // Каждое уведомление пачки находится в канале все время пачки - это его T_об
+  for (const auto& notification : batch) {
+    recordSourceDelivery(notification, batchTime);
+  }
+
+  // Канал занят один раз на всю пачку
+  channelUsage[channelId]++;
+  channelTotalServiceTime[channelId] += batchTime;
+  channelTotalServiceTimeSquared[channelId] += batchTime * batchTime;
+  channelBatchItems[channelId] += static_cast<long long>(batch.size());
+  channelBufferDrained[channelId] += fromBuffer;
+}
+
+void Database::recordSourceDelivery(const Notification& notification, double serviceTime) {
   deliveredCount++;
-  sourceDelivered[notification.getSourceId()]++; //   ( )
+  sourceDelivered[notification.getSourceId()]++; // Учёт доставленных (начало обслуживания)
 
-  // ---    (T_) ---
-  //       **  ( )
+  // --- Учёт времени ожидания (T_ож) ---
+  // Время от входа в буфер до *покидания* буфера (начало обслуживания)
   double waitTime = notification.getWaitTime();
-  if (waitTime >= 0) { //   0,    
+  BatchMeans* batches = batchCapacity > 0 ? &sourceBatchMeans[notification.getSourceId() * static_cast<int>(SourceMetric::COUNT)] : nullptr;
+  if (batches) {
+    batches[static_cast<int>(SourceMetric::REJECTION)].add(0.0);
+    batches[static_cast<int>(SourceMetric::SERVICE_TIME)].add(serviceTime);
+  }
+  if (waitTime >= 0) { // Засчитываем даже 0, если уведомление не ждало
+    if (batches) {
+      batches[static_cast<int>(SourceMetric::WAIT_TIME)].add(waitTime);
+    }
     sourceTotalWaitTime[notification.getSourceId()] += waitTime;
     sourceTotalWaitTimeSquared[notification.getSourceId()] += waitTime * waitTime;
-    sourceWaitedCount[notification.getSourceId()]++; //       T_
+    sourceWaitedCount[notification.getSourceId()]++; // Увеличиваем счётчик для усреднения и дисперсии T_ож
+    sourceWaitHistogram[notification.getSourceId()].record(waitTime);
+    if (numClasses > 0) {
+      int cls = sourceClass[notification.getSourceId()];
+      classWaitHistogram[cls].record(waitTime);
+      classResponseHistogram[cls].record(waitTime + serviceTime);
+    }
+    waitHistogram.record(waitTime);
+    responseHistogram.record(waitTime + serviceTime);
   }
   // --------------------------------------
 
-  // ---    (T_) ---
-  //  serviceTime,   Channel (,   )
+  // --- Учёт времени обслуживания (T_об) ---
+  // Используем serviceTime, переданный из Channel (время, проведённое в канале)
   sourceTotalServiceTime[notification.getSourceId()] += serviceTime;
   sourceTotalServiceTimeSquared[notification.getSourceId()] += serviceTime * serviceTime;
-  sourceServicedCount[notification.getSourceId()]++; //       T_
+  sourceServicedCount[notification.getSourceId()]++; // Увеличиваем счётчик для усреднения и дисперсии T_об
+  sourceServiceHistogram[notification.getSourceId()].record(serviceTime);
   // ------------------------------------------
 
-  // ---    (T_) ---
-  //     *  * ( )
+  // --- Учёт времени пребывания (T_преб) ---
+  // Время от генерации до *входа в канал* (конец обслуживания)
   double systemTime = notification.getSystemTime();
-  if (systemTime >= 0) { // ,   
+  if (systemTime >= 0) { // Убедимся, что время корректно
     sourceTotalSystemTime[notification.getSourceId()] += systemTime;
     sourceTotalSystemTimeSquared[notification.getSourceId()] += systemTime * systemTime;
-    sourceProcessedCount[notification.getSourceId()]++; //       T_
+    sourceProcessedCount[notification.getSourceId()]++; // Увеличиваем счётчик для усреднения и дисперсии T_преб
+    if (batches) {
+      batches[static_cast<int>(SourceMetric::SYSTEM_TIME)].add(systemTime);
+    }
   }
   // ------------------------------------------
-
-  // ---   ---
-  channelUsage[channelId]++;
-  channelTotalServiceTime[channelId] += serviceTime;
-  channelTotalServiceTimeSquared[channelId] += serviceTime * serviceTime;
-  // -----------------
 }
 
 void Database::recordRejection(const Notification& notification) {
   rejectedCount++;
-  sourceRejected[notification.getSourceId()]++; //  
+  sourceRejected[notification.getSourceId()]++; // Учёт вытесненных
+  if (batchCapacity > 0) {
+    sourceBatchMeans[notification.getSourceId() * static_cast<int>(SourceMetric::COUNT) + static_cast<int>(SourceMetric::REJECTION)].add(1.0);
+  }
+}
+
+void Database::recordExpiry(const Notification& notification) {
+  expiredCount++;
+  sourceExpired[notification.getSourceId()]++; // Учёт истекших по TTL
+}
+
+void Database::recordCoalescing(const Notification& notification) {
+  coalescedCount++;
+  sourceCoalesced[notification.getSourceId()]++; // Учёт объединенных
+}
+
+void Database::recordRetry(const Notification& notification) {
+  retryCount++;
+  sourceRetries[notification.getSourceId()]++; // Учёт попыток повтора
+}
+
+void Database::recordThrottle(const Notification& notification) {
+  throttledCount++;
+  sourceThrottled[notification.getSourceId()]++; // Учёт не пропущенных на входе
+}
+
+void Database::recordForward(const Notification& notification) {
+  forwardedCount++;
+  sourceForwarded[notification.getSourceId()]++; // Учёт переданных в другой шард
 }
 
 void Database::recordGeneration(int sourceId) {
-  sourceGeneratedCount[sourceId]++; //  
+  sourceGeneratedCount[sourceId]++; // Учёт сгенерированных
 }
 
-void Database::reset() {
+void Database::recordChannelOnline(int channelId, double time) {
+  if (isChannel(channelId) && channelOnlineSince[channelId] < 0) {
+    channelOnlineSince[channelId] = time;
+  }
+}
+
+void Database::recordChannelOffline(int channelId, double time) {
+  if (isChannel(channelId) && channelOnlineSince[channelId] >= 0) {
+    channelOnlineTime[channelId] += time - channelOnlineSince[channelId];
+    channelOnlineSince[channelId] = -1.0;
+  }
+}
+
+void Database::reset(double time) {
+  // Все накопители - заново, на месте: размеры и емкость векторов сохраняются, выделений нет.
+  // Работающие каналы продолжают работать - их периоды начинаются с момента сброса.
+  // Ряды графиков не трогаются: строки только дописываются, и снимки шкалы времени до сброса
+  // остаются верными (строки до сброса - накопленные с 0, после - с момента сброса)
   deliveredCount = 0;
   rejectedCount = 0;
-  sourceGeneratedCount.clear(); //  n_gen
-  sourceDelivered.clear();
-  sourceRejected.clear();
-  sourceTotalWaitTime.clear();
-  sourceTotalWaitTimeSquared.clear();
-  sourceWaitedCount.clear();
-  sourceTotalServiceTime.clear();
-  sourceTotalServiceTimeSquared.clear();
-  sourceServicedCount.clear();
-  sourceTotalSystemTime.clear();
-  sourceTotalSystemTimeSquared.clear();
-  sourceProcessedCount.clear();
-  channelUsage.clear();
-  channelTotalServiceTime.clear();
-  channelTotalServiceTimeSquared.clear();
-  //  
-  timePointsForGraphs.clear();
-  rejectionRatesOverTime.clear();
-  avgWaitTimesOverTime.clear();
-  avgServiceTimesOverTime.clear();
-  avgSystemTimesOverTime.clear();
-  channelLoadsOverTime.clear();
-}
-
-// ---   (const-friendly   find/at) ---
-int Database::getSourceGeneratedCount(int sourceId) const {
-  auto it = sourceGeneratedCount.find(sourceId);
-  return (it != sourceGeneratedCount.end()) ? it->second : 0; // n_gen
-}
-
-int Database::getSourceDeliveredCount(int sourceId) const {
-  auto it = sourceDelivered.find(sourceId);
-  return (it != sourceDelivered.end()) ? it->second : 0; // n_delivered
-}
-
-int Database::getSourceRejectedCount(int sourceId) const {
-  auto it = sourceRejected.find(sourceId);
-  return (it != sourceRejected.end()) ? it->second : 0; // m_rejected
+  expiredCount = 0;
+  coalescedCount = 0;
+  retryCount = 0;
+  throttledCount = 0;
+  forwardedCount = 0;
+  statisticsStart = time;
+  zeroFill(sourceGeneratedCount);
+  zeroFill(sourceDelivered);
+  zeroFill(sourceRejected);
+  zeroFill(sourceExpired);
+  zeroFill(sourceCoalesced);
+  zeroFill(sourceRetries);
+  zeroFill(sourceThrottled);
+  zeroFill(sourceForwarded);
+  zeroFill(sourceTotalWaitTime);
+  zeroFill(sourceTotalWaitTimeSquared);
+  zeroFill(sourceWaitedCount);
+  zeroFill(sourceTotalServiceTime);
+  zeroFill(sourceTotalServiceTimeSquared);
+  zeroFill(sourceServicedCount);
+  zeroFill(sourceTotalSystemTime);
+  zeroFill(sourceTotalSystemTimeSquared);
+  zeroFill(sourceProcessedCount);
+  zeroFill(channelUsage);
+  zeroFill(channelTotalServiceTime);
+  zeroFill(channelTotalServiceTimeSquared);
+  zeroFill(channelBatchItems);
+  zeroFill(channelBufferDrained);
+  zeroFill(channelOnlineTime);
+  for (double& since : channelOnlineSince) {
+    since = since >= 0 ? time : -1.0;
+  }
+  resetAll(sourceWaitHistogram);
+  resetAll(sourceServiceHistogram);
+  waitHistogram.reset();
+  responseHistogram.reset();
+  resetAll(classWaitHistogram);
+  resetAll(classResponseHistogram);
+  resetAll(sourceBatchMeans);
 }
 
-double Database::getSourceRejectionRate(int sourceId) const {
-  int generated = getSourceGeneratedCount(sourceId); // n_gen
-  int rejected = getSourceRejectedCount(sourceId);   // m_rej
-  // :   0  
-  return (generated > 0) ? static_cast<double>(rejected) / generated : 0.0; // p_ = m/n
+void Database::merge(const Database& other) {
+  if (other.numSources != numSources || other.numChannels != numChannels || other.numClasses != numClasses) {
+    throw std::runtime_error("Сливаемая статистика от другого сценария (источники, каналы или классы не совпадают)");
+  }
+  deliveredCount += other.deliveredCount;
+  rejectedCount += other.rejectedCount;
+  expiredCount += other.expiredCount;
+  coalescedCount += other.coalescedCount;
+  retryCount += other.retryCount;
+  throttledCount += other.throttledCount;
+  forwardedCount += other.forwardedCount;
+  statisticsStart += other.statisticsStart; // Суммарное время реплик минус сумма отсечений - время наблюдения
+  addInto(sourceGeneratedCount, other.sourceGeneratedCount);
+  addInto(sourceDelivered, other.sourceDelivered);
+  addInto(sourceRejected, other.sourceRejected);
+  addInto(sourceExpired, other.sourceExpired);
+  addInto(sourceCoalesced, other.sourceCoalesced);
+  addInto(sourceRetries, other.sourceRetries);
+  addInto(sourceThrottled, other.sourceThrottled);
+  addInto(sourceForwarded, other.sourceForwarded);
+  addInto(sourceTotalWaitTime, other.sourceTotalWaitTime);
+  addInto(sourceTotalWaitTimeSquared, other.sourceTotalWaitTimeSquared);
+  addInto(sourceWaitedCount, other.sourceWaitedCount);
+  addInto(sourceTotalServiceTime, other.sourceTotalServiceTime);
+  addInto(sourceTotalServiceTimeSquared, other.sourceTotalServiceTimeSquared);
+  addInto(sourceServicedCount, other.sourceServicedCount);
+  addInto(sourceTotalSystemTime, other.sourceTotalSystemTime);
+  addInto(sourceTotalSystemTimeSquared, other.sourceTotalSystemTimeSquared);
+  addInto(sourceProcessedCount, other.sourceProcessedCount);
+  addInto(channelUsage, other.channelUsage);
+  addInto(channelTotalServiceTime, other.channelTotalServiceTime);
+  addInto(channelTotalServiceTimeSquared, other.channelTotalServiceTimeSquared);
+  addInto(channelBatchItems, other.channelBatchItems);
+  addInto(channelBufferDrained, other.channelBufferDrained);
+  addInto(channelOnlineTime, other.channelOnlineTime);
+  mergeInto(sourceWaitHistogram, other.sourceWaitHistogram);
+  mergeInto(sourceServiceHistogram, other.sourceServiceHistogram);
+  waitHistogram.merge(other.waitHistogram);
+  responseHistogram.merge(other.responseHistogram);
+  mergeInto(classWaitHistogram, other.classWaitHistogram);
+  mergeInto(classResponseHistogram, other.classResponseHistogram);
 }
 
-double Database::getSourceAvgWaitTime(int sourceId) const {
-  auto countIt = sourceWaitedCount.find(sourceId);
-  auto timeIt = sourceTotalWaitTime.find(sourceId);
+void Database::configureClasses(const std::vector<int>& classBySource) {
+  sourceClass.assign(numSources + 1, 0);
+  numClasses = 1;
+  for (int i = 1; i <= numSources && i < static_cast<int>(classBySource.size()); i++) {
+    sourceClass[i] = std::max(0, classBySource[i]);
+    numClasses = std::max(numClasses, sourceClass[i] + 1);
+  }
+  classWaitHistogram.assign(numClasses, QuantileHistogram());
+  classResponseHistogram.assign(numClasses, QuantileHistogram());
+}
+
+void Database::configureBatchMeans(int capacity, double tAlpha) {
+  batchCapacity = std::max(0, capacity);
+  batchTAlpha = tAlpha;
+  sourceBatchMeans.assign(batchCapacity > 0 ? (numSources + 1) * static_cast<int>(SourceMetric::COUNT) : 0, BatchMeans(batchCapacity));
+}
 
-  if (countIt != sourceWaitedCount.end() && countIt->second > 0 &&
-    timeIt != sourceTotalWaitTime.end()) {
-    return timeIt->second / countIt->second; // T_
+bool Database::hasBatchMeans() const { return batchCapacity > 0; }
+
+const BatchMeans& Database::getSourceBatchMeans(int sourceId, SourceMetric metric) const {
+  static const BatchMeans empty;
+  if (batchCapacity == 0 || !isSource(sourceId)) {
+    return empty;
   }
-  return 0.0;
+  return sourceBatchMeans[sourceId * static_cast<int>(SourceMetric::COUNT) + static_cast<int>(metric)];
 }
 
-double Database::getSourceAvgServiceTime(int sourceId) const {
-  auto countIt = sourceServicedCount.find(sourceId);
-  auto timeIt = sourceTotalServiceTime.find(sourceId);
+bool Database::isPrecisionReached(double precision) const {
+  if (batchCapacity == 0) {
+    return false;
+  }
+  for (int i = 1; i <= numSources; i++) {
+    for (int metric = 0; metric < static_cast<int>(SourceMetric::COUNT); metric++) {
+      const BatchMeans& batches = sourceBatchMeans[i * static_cast<int>(SourceMetric::COUNT) + metric];
+      if (!batches.isReliable(batchTAlpha) || batches.getHalfWidth(batchTAlpha) > precision * std::abs(batches.getMean())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// --- Методы получения (const-friendly: номер вне диапазона - нулевая статистика) ---
+long long Database::getSourceGeneratedCount(int sourceId) const {
+  return isSource(sourceId) ? sourceGeneratedCount[sourceId] : 0; // n_gen
+}
+
+long long Database::getSourceDeliveredCount(int sourceId) const {
+  return isSource(sourceId) ? sourceDelivered[sourceId] : 0; // n_delivered
+}
+
+long long Database::getSourceRejectedCount(int sourceId) const {
+  return isSource(sourceId) ? sourceRejected[sourceId] : 0; // m_rejected
+}
+
+long long Database::getSourceExpiredCount(int sourceId) const {
+  return isSource(sourceId) ? sourceExpired[sourceId] : 0;
+}
+
+long long Database::getSourceCoalescedCount(int sourceId) const {
+  return isSource(sourceId) ? sourceCoalesced[sourceId] : 0;
+}
+
+long long Database::getSourceRetryCount(int sourceId) const {
+  return isSource(sourceId) ? sourceRetries[sourceId] : 0;
+}
+
+long long Database::getSourceThrottledCount(int sourceId) const {
+  return isSource(sourceId) ? sourceThrottled[sourceId] : 0;
+}
+
+long long Database::getSourceForwardedCount(int sourceId) const {
+  return isSource(sourceId) ? sourceForwarded[sourceId] : 0;
+}
+
+double Database::getSourceRejectionRate(int sourceId) const {
+  long long generated = getSourceGeneratedCount(sourceId); // n_gen
+  long long rejected = getSourceRejectedCount(sourceId);   // m_rej
+  // ИСПРАВЛЕНО: Проверка на 0 при делении
+  return (generated > 0) ? static_cast<double>(rejected) / generated : 0.0; // p_отк = m/n
+}
+
+namespace {
 
-  if (countIt != sourceServicedCount.end() && countIt->second > 0 &&
-    timeIt != sourceTotalServiceTime.end()) {
-    return timeIt->second / countIt->second; // T_ (  serviceTime)
+  double mean(double total, long long count) {
+    return count > 0 ? total / count : 0.0;
   }
-  return 0.0;
+
+  double variance(double total, double totalSquared, long long count) {
+    if (count <= 1) { // Дисперсия требует > 1 наблюдения
+      return 0.0;
+    }
+    double average = total / count;
+    return totalSquared / count - average * average;
+  }
+
+}
+
+double Database::getSourceAvgWaitTime(int sourceId) const {
+  return isSource(sourceId) ? mean(sourceTotalWaitTime[sourceId], sourceWaitedCount[sourceId]) : 0.0; // T_ож
+}
+
+double Database::getSourceAvgServiceTime(int sourceId) const {
+  // T_об (приблизительно из serviceTime)
+  return isSource(sourceId) ? mean(sourceTotalServiceTime[sourceId], sourceServicedCount[sourceId]) : 0.0;
 }
 
 double Database::getSourceAvgSystemTime(int sourceId) const {
-  auto countIt = sourceProcessedCount.find(sourceId);
-  auto timeIt = sourceTotalSystemTime.find(sourceId);
+  return isSource(sourceId) ? mean(sourceTotalSystemTime[sourceId], sourceProcessedCount[sourceId]) : 0.0; // T_преб
+}
+
+LatencyHistogram Database::getSourceWaitHistogram(int sourceId) const {
+  return isSource(sourceId) ? sourceWaitHistogram[sourceId] : LatencyHistogram();
+}
 
-  if (countIt != sourceProcessedCount.end() && countIt->second > 0 &&
-    timeIt != sourceTotalSystemTime.end()) {
-    return timeIt->second / countIt->second; // T_
+LatencyHistogram Database::getSourceServiceHistogram(int sourceId) const {
+  return isSource(sourceId) ? sourceServiceHistogram[sourceId] : LatencyHistogram();
+}
+
+const QuantileHistogram& Database::getWaitHistogram() const { return waitHistogram; }
+
+const QuantileHistogram& Database::getResponseHistogram() const { return responseHistogram; }
+
+int Database::getClassCount() const { return numClasses; }
+
+double Database::getClassRejectionRate(int cls) const {
+  long long generated = 0;
+  long long rejected = 0;
+  for (int i = 1; i <= numSources && cls >= 0 && cls < numClasses; i++) {
+    if (sourceClass[i] == cls) {
+      generated += sourceGeneratedCount[i];
+      rejected += sourceRejected[i];
+    }
   }
-  return 0.0;
+  return (generated > 0) ? static_cast<double>(rejected) / generated : 0.0;
 }
 
-double Database::getSourceVarianceWaitTime(int sourceId) const {
-  auto countIt = sourceWaitedCount.find(sourceId);
-  auto timeIt = sourceTotalWaitTime.find(sourceId);
-  auto timeSqIt = sourceTotalWaitTimeSquared.find(sourceId);
+const QuantileHistogram& Database::getClassWaitHistogram(int cls) const {
+  static const QuantileHistogram empty;
+  return (cls >= 0 && cls < numClasses) ? classWaitHistogram[cls] : empty;
+}
+
+const QuantileHistogram& Database::getClassResponseHistogram(int cls) const {
+  static const QuantileHistogram empty;
+  return (cls >= 0 && cls < numClasses) ? classResponseHistogram[cls] : empty;
+}
 
-  if (countIt != sourceWaitedCount.end() && countIt->second > 1 && //   > 1 
-    timeIt != sourceTotalWaitTime.end() && timeSqIt != sourceTotalWaitTimeSquared.end()) {
-    double mean = timeIt->second / countIt->second;
-    double meanSq = timeSqIt->second / countIt->second;
-    return meanSq - (mean * mean); // D_
+double Database::getSourceVarianceWaitTime(int sourceId) const {
+  if (!isSource(sourceId)) {
+    return 0.0;
   }
-  return 0.0; //  0,      
+  return variance(sourceTotalWaitTime[sourceId], sourceTotalWaitTimeSquared[sourceId], sourceWaitedCount[sourceId]); // D_ож
 }
 
 double Database::getSourceVarianceServiceTime(int sourceId) const {
-  auto countIt = sourceServicedCount.find(sourceId);
-  auto timeIt = sourceTotalServiceTime.find(sourceId);
-  auto timeSqIt = sourceTotalServiceTimeSquared.find(sourceId);
-
-  if (countIt != sourceServicedCount.end() && countIt->second > 1 && //   > 1 
-    timeIt != sourceTotalServiceTime.end() && timeSqIt != sourceTotalServiceTimeSquared.end()) {
-    double mean = timeIt->second / countIt->second;
-    double meanSq = timeSqIt->second / countIt->second;
-    return meanSq - (mean * mean); // D_ ( serviceTime)
+  if (!isSource(sourceId)) {
+    return 0.0;
   }
-  return 0.0; //  0,      
+  // D_об (из serviceTime)
+  return variance(sourceTotalServiceTime[sourceId], sourceTotalServiceTimeSquared[sourceId], sourceServicedCount[sourceId]);
 }
 
-int Database::getDeliveredCount() const { return deliveredCount; }
-int Database::getRejectedCount() const { return rejectedCount; }
-int Database::getTotalProcessed() const { return deliveredCount + rejectedCount; }
+long long Database::getDeliveredCount() const { return deliveredCount; }
+long long Database::getRejectedCount() const { return rejectedCount; }
+long long Database::getExpiredCount() const { return expiredCount; }
+long long Database::getCoalescedCount() const { return coalescedCount; }
+long long Database::getRetryCount() const { return retryCount; }
+long long Database::getThrottledCount() const { return throttledCount; }
+long long Database::getForwardedCount() const { return forwardedCount; }
+long long Database::getReceivedDeliveredCount() const { return sourceDelivered[0]; }
+long long Database::getReceivedRejectedCount() const { return sourceRejected[0]; }
+long long Database::getTotalProcessed() const { return deliveredCount + rejectedCount; }
 
 double Database::getRejectionRate() const {
-  int total = getTotalProcessed();
+  long long total = getTotalProcessed();
   return (total > 0) ? static_cast<double>(rejectedCount) / total : 0.0;
 }
 
-int Database::getChannelUsage(int channelId) const {
-  auto it = channelUsage.find(channelId);
-  return (it != channelUsage.end()) ? it->second : 0;
+namespace {
+
+  // Сумма по всем источникам / число по всем источникам
+  double pooledMean(const std::vector<double>& totals, const std::vector<long long>& counts) {
+    double total = 0.0;
+    long long count = 0;
+    for (double value : totals) {
+      total += value;
+    }
+    for (long long value : counts) {
+      count += value;
+    }
+    return count > 0 ? total / count : 0.0;
+  }
+
 }
 
-// --- :  totalTime ---
-double Database::getChannelUtilization(int channelId, double totalTime) const {
-  auto usageIt = channelUsage.find(channelId);
-  auto timeIt = channelTotalServiceTime.find(channelId);
+double Database::getAvgWaitTime() const { return pooledMean(sourceTotalWaitTime, sourceWaitedCount); }
+double Database::getAvgServiceTime() const { return pooledMean(sourceTotalServiceTime, sourceServicedCount); }
+double Database::getAvgSystemTime() const { return pooledMean(sourceTotalSystemTime, sourceProcessedCount); }
 
-  if (usageIt != channelUsage.end() && timeIt != channelTotalServiceTime.end()) {
-    //  = (  ) / (  )
-    return totalTime > 0 ? timeIt->second / totalTime : 0.0;
+double Database::getTotalWaitTime() const {
+  double total = 0.0;
+  for (double value : sourceTotalWaitTime) {
+    total += value;
   }
-  return 0.0;
+  return total;
+}
+
+long long Database::getWaitedCount() const {
+  long long total = 0;
+  for (long long value : sourceWaitedCount) {
+    total += value;
+  }
+  return total;
+}
+
+double Database::getStatisticsStart() const { return statisticsStart; }
+
+long long Database::getChannelBatchItems(int channelId) const {
+  return isChannel(channelId) ? channelBatchItems[channelId] : 0;
+}
+
+long long Database::getChannelBufferDrained(int channelId) const {
+  return isChannel(channelId) ? channelBufferDrained[channelId] : 0;
+}
+
+long long Database::getChannelUsage(int channelId) const {
+  return isChannel(channelId) ? channelUsage[channelId] : 0;
+}
+
+// --- ИСПРАВЛЕНО: Добавлен totalTime ---
+double Database::getChannelUtilization(int channelId, double totalTime) const {
+  // Утилизация = (суммарное время обслуживания) / (время моделирования после сброса)
+  double observed = totalTime - statisticsStart;
+  return (isChannel(channelId) && observed > 0) ? channelTotalServiceTime[channelId] / observed : 0.0;
 }
 // ---------------------------------------
 
-double Database::getChannelVarianceServiceTime(int channelId, double totalTime) const {
-  auto usageIt = channelUsage.find(channelId);
-  auto timeIt = channelTotalServiceTime.find(channelId);
-  auto timeSqIt = channelTotalServiceTimeSquared.find(channelId);
+double Database::getChannelBusyTime(int channelId) const {
+  return isChannel(channelId) ? channelTotalServiceTime[channelId] : 0.0;
+}
 
-  if (usageIt != channelUsage.end() && usageIt->second > 1 && //   > 1 
-    timeIt != channelTotalServiceTime.end() && timeSqIt != channelTotalServiceTimeSquared.end()) {
-    double mean = timeIt->second / usageIt->second;
-    double meanSq = timeSqIt->second / usageIt->second;
-    return meanSq - (mean * mean);
+double Database::getTotalBusyTime() const {
+  double total = 0.0;
+  for (double value : channelTotalServiceTime) {
+    total += value;
   }
-  return 0.0; //  0,      
+  return total;
 }
 
-// ---   (:  totalTime ) ---
+bool Database::wasChannelOnline(int channelId) const {
+  return isChannel(channelId) && (channelOnlineSince[channelId] >= 0 || channelOnlineTime[channelId] > 0);
+}
+
+double Database::getChannelHours(double currentTime) const {
+  double total = 0.0;
+  for (int i = 1; i <= numChannels; i++) {
+    total += channelOnlineTime[i] + (channelOnlineSince[i] >= 0 ? currentTime - channelOnlineSince[i] : 0.0);
+  }
+  return total;
+}
+
+long long Database::getGeneratedCount() const {
+  long long total = 0;
+  for (long long value : sourceGeneratedCount) {
+    total += value;
+  }
+  return total;
+}
+
+UtilizationBalance Database::getUtilizationBalance(double totalTime) const {
+  UtilizationBalance balance{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+  double sum = 0.0;
+  double sumSquared = 0.0;
+  int counted = 0;
+  for (int i = 1; i <= numChannels; i++) {
+    if (!wasChannelOnline(i)) {
+      continue; // Ячейки автомасштабирования, так и не введенные в работу
+    }
+    double utilization = getChannelUtilization(i, totalTime);
+    balance.min = counted == 0 ? utilization : std::min(balance.min, utilization);
+    balance.max = std::max(balance.max, utilization);
+    sum += utilization;
+    sumSquared += utilization * utilization;
+    counted++;
+  }
+  if (counted == 0) {
+    return balance;
+  }
+  balance.mean = sum / counted;
+  double spread = sumSquared / counted - balance.mean * balance.mean;
+  balance.cv = balance.mean > 0 ? std::sqrt(std::max(0.0, spread)) / balance.mean : 0.0;
+  balance.jain = sumSquared > 0 ? sum * sum / (counted * sumSquared) : 1.0;
+  return balance;
+}
+
+double Database::getChannelVarianceServiceTime(int channelId, double totalTime) const {
+  if (!isChannel(channelId)) {
+    return 0.0;
+  }
+  return variance(channelTotalServiceTime[channelId], channelTotalServiceTimeSquared[channelId], channelUsage[channelId]);
+}
+
+// --- Метод вывода (ИСПРАВЛЕНО: Принимает totalTime извне) ---
 void Database::printStatistics(double totalTime) const {
-  std::cout << "\n=====   (1) =====\n";
+  std::cout << "\n===== СВОДНАЯ ТАБЛИЦА (ОР1) =====\n";
 
-  // ---  1:   ---
-  std::cout << "\n---  1:    ---\n";
-  //      
-  std::cout << "  |   (n_gen) | p_ | T_ | T_ (T_) | T_ | D_ (D_) | D_\n";
+  // --- Таблица 1: Характеристики источников ---
+  std::cout << "\n--- Таблица 1: Характеристики источников ВС ---\n";
+  // Печатаем заголовок в соответствии с требованиями
+  std::cout << "№ источника | Количество заявок (n_gen) | p_отк | T_преб | T_БП (T_ож) | T_обсл | D_БП (D_ож) | D_обсл\n";
   std::cout << "------------|---------------------------|-------|--------|-------------|--------|-------------|-------\n";
 
-  for (int i = 1; i <= 3; i++) { //  3 
-    //  const-friendly  (find/at)
-    int n_gen = getSourceGeneratedCount(i);
-    int n_deliv = getSourceDeliveredCount(i);
-    int m_rej = getSourceRejectedCount(i);
-    double p_otk = (n_gen > 0) ? static_cast<double>(m_rej) / n_gen : 0.0; // p_ = m/n_gen
-    double avg_system_time = getSourceAvgSystemTime(i); // T_
-    double avg_wait_time = getSourceAvgWaitTime(i);     // T_ (T_)
-    double avg_service_time = getSourceAvgServiceTime(i); // T_ ()
-    double var_wait_time = getSourceVarianceWaitTime(i);  // D_ (D_)
-    double var_service_time = getSourceVarianceServiceTime(i); // D_ (  serviceTime)
+  for (int i = 1; i <= numSources; i++) {
+    // ИСПОЛЬЗУЕМ const-friendly методы (find/at)
+    long long n_gen = getSourceGeneratedCount(i);
+    long long n_deliv = getSourceDeliveredCount(i);
+    long long m_rej = getSourceRejectedCount(i);
+    double p_otk = (n_gen > 0) ? static_cast<double>(m_rej) / n_gen : 0.0; // p_отк = m/n_gen
+    double avg_system_time = getSourceAvgSystemTime(i); // T_преб
+    double avg_wait_time = getSourceAvgWaitTime(i);     // T_ож (T_БП)
+    double avg_service_time = getSourceAvgServiceTime(i); // T_об (приблизительно)
+    double var_wait_time = getSourceVarianceWaitTime(i);  // D_ож (D_БП)
+    double var_service_time = getSourceVarianceServiceTime(i); // D_об (приблизительно из serviceTime)
 
     std::cout << std::setw(11) << i << " | "
-      << std::setw(25) << n_gen << " | " //  n_gen
+      << std::setw(25) << n_gen << " | " // Используем n_gen
       << std::fixed << std::setprecision(4)
       << std::setw(5) << p_otk << " | "
       << std::setw(6) << avg_system_time << " | "
@@ -237,146 +606,366 @@ void Database::printStatistics(double totalTime) const {
       << std::setw(11) << var_wait_time << " | "
       << std::setw(6) << var_service_time << "\n";
 
-    //  T_ = T_ + T_ ()
+    // Проверка T_преб = T_ож + T_об (приблизительно)
     double sum_components = avg_wait_time + avg_service_time;
-    if (std::abs(avg_system_time - sum_components) > 1e-3) { //    
-      std::cout << "      (: T_ (" << avg_system_time << ") ~= T_ (" << avg_wait_time << ") + T_ (" << avg_service_time << ") = " << sum_components << ")\n";
+    if (std::abs(avg_system_time - sum_components) > 1e-3) { // Простая проверка с погрешностью
+      std::cout << "      (Проверка: T_преб (" << avg_system_time << ") ~= T_ож (" << avg_wait_time << ") + T_об (" << avg_service_time << ") = " << sum_components << ")\n";
     }
   }
   // ------------------------------------------
 
-  // ---  2:   ---
-  std::cout << "\n---  2:    ---\n";
-  std::cout << " |  \n";
-  std::cout << "-------|---------------------------\n";
+  // --- Истекшие по TTL (только если TTL задан и что-то истекло) ---
+  if (expiredCount > 0) {
+    std::cout << "\n--- Истекшие в буфере по TTL (всего " << expiredCount << ") ---\n";
+    std::cout << "№ источника | Истекло | Доля от n_gen\n";
+    std::cout << "------------|---------|--------------\n";
+    for (int i = 1; i <= numSources; i++) {
+      long long n_gen = getSourceGeneratedCount(i);
+      long long n_exp = getSourceExpiredCount(i);
+      std::cout << std::setw(11) << i << " | "
+        << std::setw(7) << n_exp << " | "
+        << std::fixed << std::setprecision(4)
+        << std::setw(12) << ((n_gen > 0) ? static_cast<double>(n_exp) / n_gen : 0.0) << "\n";
+    }
+  }
+  // ------------------------------------------
 
-  for (int i = 1; i <= 3; i++) { //  3 
-    // :  totalTime
-    double utilization = getChannelUtilization(i, totalTime);
-    std::cout << std::setw(5) << i << " | "
-      << std::fixed << std::setprecision(5)
-      << std::setw(27) << utilization << "\n";
+  // --- Объединенные (только в режиме объединения) ---
+  if (coalescedCount > 0) {
+    std::cout << "\n--- Объединенные в буфере (всего " << coalescedCount << ", столько же обслуживаний сэкономлено) ---\n";
+    std::cout << "№ источника | Объединено | Доля от n_gen\n";
+    std::cout << "------------|------------|--------------\n";
+    for (int i = 1; i <= numSources; i++) {
+      long long n_gen = getSourceGeneratedCount(i);
+      long long n_coal = getSourceCoalescedCount(i);
+      std::cout << std::setw(11) << i << " | "
+        << std::setw(10) << n_coal << " | "
+        << std::fixed << std::setprecision(4)
+        << std::setw(12) << ((n_gen > 0) ? static_cast<double>(n_coal) / n_gen : 0.0) << "\n";
+    }
   }
   // ------------------------------------------
-}
-// ---------------------------
 
-// ---    (:  currentTime,  totalTime) ---
-void Database::snapshotStatistics(double currentTime) {
-  timePointsForGraphs.push_back(currentTime);
-
-  //  p_   
-  std::map<int, double> currentRejRates;
-  for (int i = 1; i <= 3; i++) { //  3 
-    //  const-friendly  (find/at)
-    int gen = getSourceGeneratedCount(i); // n_gen
-    int rej = getSourceRejectedCount(i);  // m_rej
-    currentRejRates[i] = (gen > 0) ? static_cast<double>(rej) / gen : 0.0;
-  }
-  rejectionRatesOverTime.push_back(currentRejRates);
-
-  //  avg T_   
-  std::map<int, double> currentAvgWaitTimes;
-  for (int i = 1; i <= 3; i++) {
-    //  const-friendly  (find/at)
-    auto countIt = sourceWaitedCount.find(i);
-    auto timeIt = sourceTotalWaitTime.find(i);
-    if (countIt != sourceWaitedCount.end() && countIt->second > 0 && timeIt != sourceTotalWaitTime.end()) {
-      currentAvgWaitTimes[i] = timeIt->second / countIt->second;
+  // --- Ограничение интенсивности на входе (только если что-то не пропущено) ---
+  if (throttledCount > 0) {
+    // Доля не пропущенных и p_отк рядом: хорошо подобранный предел снимает отказы у остальных источников
+    std::cout << "\n--- Ограничение интенсивности на входе (всего " << throttledCount << ") ---\n";
+    std::cout << "№ источника | Не пропущено | Доля от n_gen | p_отк\n";
+    std::cout << "------------|--------------|---------------|------\n";
+    for (int i = 1; i <= numSources; i++) {
+      long long n_gen = getSourceGeneratedCount(i);
+      long long n_thr = getSourceThrottledCount(i);
+      std::cout << std::setw(11) << i << " | "
+        << std::setw(12) << n_thr << " | "
+        << std::fixed << std::setprecision(4)
+        << std::setw(13) << ((n_gen > 0) ? static_cast<double>(n_thr) / n_gen : 0.0) << " | "
+        << getSourceRejectionRate(i) << "\n";
     }
-    else {
-      currentAvgWaitTimes[i] = 0.0;
+  }
+  // ------------------------------------------
+
+  // --- Передача между шардами (только если была) ---
+  if (forwardedCount > 0 || sourceDelivered[0] + sourceRejected[0] > 0) {
+    std::cout << "\n--- Передача переполнения между шардами (передано " << forwardedCount << ") ---\n";
+    std::cout << "№ источника | Передано | Доля от n_gen\n";
+    std::cout << "------------|----------|--------------\n";
+    for (int i = 1; i <= numSources; i++) {
+      long long n_gen = getSourceGeneratedCount(i);
+      long long n_fwd = getSourceForwardedCount(i);
+      std::cout << std::setw(11) << i << " | "
+        << std::setw(8) << n_fwd << " | "
+        << std::fixed << std::setprecision(4)
+        << std::setw(12) << ((n_gen > 0) ? static_cast<double>(n_fwd) / n_gen : 0.0) << "\n";
     }
+    std::cout << "Принято из других шардов: доставлено " << sourceDelivered[0] << ", вытеснено " << sourceRejected[0] << "\n";
   }
-  avgWaitTimesOverTime.push_back(currentAvgWaitTimes);
+  // ------------------------------------------
+
+  // --- Интервалы методом пачек (только если ведутся) ---
+  if (batchCapacity > 0) {
+    std::cout << "\n--- Таблица 1: доверительные интервалы одного прогона (метод пачек, t_alpha " << batchTAlpha << ") ---\n";
+    std::cout << "№ источника | Показатель | Среднее     | Полуширина | Пачек | Длина пачки | r1\n";
+    std::cout << "------------|------------|-------------|------------|-------|-------------|-------\n";
+    const char* names[] = { "p_отк", "T_преб", "T_ож", "T_обсл" };
+    for (int i = 1; i <= numSources; i++) {
+      for (int metric = 0; metric < static_cast<int>(SourceMetric::COUNT); metric++) {
+        const BatchMeans& batches = sourceBatchMeans[i * static_cast<int>(SourceMetric::COUNT) + metric];
+        std::cout << std::setw(11) << i << " | "
+          << std::setw(10) << names[metric] << " | "
+          << std::fixed << std::setprecision(5)
+          << std::setw(11) << batches.getMean() << " | "
+          << std::setw(10) << batches.getHalfWidth(batchTAlpha) << " | "
+          << std::setw(5) << batches.getBatchCount() << " | "
+          << std::setw(11) << batches.getBatchSize() << " | "
+          << std::setprecision(3) << std::setw(6) << batches.getLag1Autocorrelation()
+          << (batches.isReliable(batchTAlpha) ? "" : " (пачки коррелированы или их мало)") << "\n";
+      }
+    }
+  }
+  // ------------------------------------------
 
-  //  avg T_   
-  std::map<int, double> currentAvgServiceTimes;
-  for (int i = 1; i <= 3; i++) {
-    //  const-friendly  (find/at)
-    auto countIt = sourceServicedCount.find(i);
-    auto timeIt = sourceTotalServiceTime.find(i);
-    if (countIt != sourceServicedCount.end() && countIt->second > 0 && timeIt != sourceTotalServiceTime.end()) {
-      currentAvgServiceTimes[i] = timeIt->second / countIt->second;
+  // --- Повторы (только если были) ---
+  double observed = totalTime - statisticsStart;
+  if (retryCount > 0 && observed > 0) {
+    // Предложенная нагрузка = новые + повторы; полезная - доставленные (начавшие обслуживание)
+    std::cout << "\n--- Повторы вытесненных: полезная пропускная способность против предложенной нагрузки ---\n";
+    std::cout << "№ источника | n_gen | Повторов | Усиление | Предложено/ед. | Доставлено/ед.\n";
+    std::cout << "------------|-------|----------|----------|----------------|---------------\n";
+    long long totalGenerated = 0;
+    for (int i = 1; i <= numSources; i++) {
+      long long n_gen = getSourceGeneratedCount(i);
+      long long n_retry = getSourceRetryCount(i);
+      totalGenerated += n_gen;
+      std::cout << std::setw(11) << i << " | "
+        << std::setw(5) << n_gen << " | "
+        << std::setw(8) << n_retry << " | "
+        << std::fixed << std::setprecision(4)
+        << std::setw(8) << ((n_gen > 0) ? static_cast<double>(n_gen + n_retry) / n_gen : 0.0) << " | "
+        << std::setw(14) << (n_gen + n_retry) / observed << " | "
+        << std::setw(13) << getSourceDeliveredCount(i) / observed << "\n";
     }
-    else {
-      currentAvgServiceTimes[i] = 0.0;
+    std::cout << "Всего: предложено " << (totalGenerated + retryCount) / observed
+      << " в ед. времени (новых " << totalGenerated / observed << "), доставлено " << deliveredCount / observed << "\n";
+  }
+  // ------------------------------------------
+
+  // --- Классы уведомлений (только если их больше одного) ---
+  if (numClasses > 1) {
+    std::cout << "\n--- Классы уведомлений (0 - высший): квантили (погрешность < 1/64) ---\n";
+    std::cout << "Класс | p_отк  | T_ож p50 | T_ож p95 | T_ож p99 | T_откл p50 | T_откл p95 | T_откл p99\n";
+    std::cout << "------|--------|----------|----------|----------|------------|------------|-----------\n";
+    for (int cls = 0; cls < numClasses; cls++) {
+      const QuantileHistogram& wait = classWaitHistogram[cls];
+      const QuantileHistogram& response = classResponseHistogram[cls];
+      std::cout << std::setw(5) << cls << " | "
+        << std::fixed << std::setprecision(4)
+        << std::setw(6) << getClassRejectionRate(cls) << " | "
+        << std::setw(8) << wait.quantile(0.50) << " | "
+        << std::setw(8) << wait.quantile(0.95) << " | "
+        << std::setw(8) << wait.quantile(0.99) << " | "
+        << std::setw(10) << response.quantile(0.50) << " | "
+        << std::setw(10) << response.quantile(0.95) << " | "
+        << std::setw(10) << response.quantile(0.99) << "\n";
     }
   }
-  avgServiceTimesOverTime.push_back(currentAvgServiceTimes);
+  // ------------------------------------------
 
-  //  avg T_   
-  std::map<int, double> currentAvgSystemTimes;
-  for (int i = 1; i <= 3; i++) {
-    //  const-friendly  (find/at)
-    auto countIt = sourceProcessedCount.find(i);
-    auto timeIt = sourceTotalSystemTime.find(i);
-    if (countIt != sourceProcessedCount.end() && countIt->second > 0 && timeIt != sourceTotalSystemTime.end()) {
-      currentAvgSystemTimes[i] = timeIt->second / countIt->second;
+  // --- Таблица 2: Характеристики приборов ---
+  std::cout << "\n--- Таблица 2: Характеристики приборов ВС ---\n";
+  std::cout << "Канал | Коэффициент использования\n";
+  std::cout << "-------|---------------------------\n";
+
+  for (int i = 1; i <= numChannels; i++) {
+    if (!wasChannelOnline(i)) {
+      continue;
     }
-    else {
-      currentAvgSystemTimes[i] = 0.0;
+    // ИСПРАВЛЕНО: передаём totalTime
+    double utilization = getChannelUtilization(i, totalTime);
+    std::cout << std::setw(5) << i << " | "
+      << std::fixed << std::setprecision(5)
+      << std::setw(27) << utilization << "\n";
+  }
+  // ------------------------------------------
+
+  // Равномерность загрузки и хвост задержек - по ним сравниваются политики выбора канала
+  UtilizationBalance balance = getUtilizationBalance(totalTime);
+  std::cout << "Загрузка: мин " << std::setprecision(4) << balance.min << ", макс " << balance.max
+    << ", средняя " << balance.mean << ", CV " << balance.cv << ", индекс Джейна " << balance.jain
+    << "; T_ож p99 " << waitHistogram.quantile(0.99)
+    << "; T_отклика p50 " << responseHistogram.quantile(0.50) << ", p99 " << responseHistogram.quantile(0.99) << "\n";
+  // ------------------------------------------
+
+  // --- Пакетные каналы (только если пачки были) ---
+  bool anyBatches = false;
+  for (int i = 1; i <= numChannels; i++) {
+    anyBatches = anyBatches || channelBatchItems[i] > 0;
+  }
+  if (anyBatches) {
+    std::cout << "\n--- Пакетное обслуживание ---\n";
+    std::cout << "Канал | Захватов | Уведомлений | Ср. пачка | Уведомлений на ед. занятости | Ячеек буфера освобождено\n";
+    std::cout << "------|----------|-------------|-----------|------------------------------|-------------------------\n";
+    for (int i = 1; i <= numChannels; i++) {
+      if (channelBatchItems[i] == 0) {
+        continue;
+      }
+      // Прирост пропускной способности - уведомлений за единицу занятости против 1 / T_об одиночного;
+      // разгрузка буфера - сколько ячеек освобождено сверх одной за захват
+      double avgBatch = static_cast<double>(channelBatchItems[i]) / channelUsage[i];
+      double perBusyTime = channelTotalServiceTime[i] > 0 ? channelBatchItems[i] / channelTotalServiceTime[i] : 0.0;
+      std::cout << std::setw(5) << i << " | "
+        << std::setw(8) << channelUsage[i] << " | "
+        << std::setw(11) << channelBatchItems[i] << " | "
+        << std::fixed << std::setprecision(3)
+        << std::setw(9) << avgBatch << " | "
+        << std::setw(28) << perBusyTime << " | "
+        << std::setw(12) << channelBufferDrained[i]
+        << " (сверх одного: " << std::max(0LL, channelBufferDrained[i] - channelUsage[i]) << ")\n";
     }
   }
-  avgSystemTimesOverTime.push_back(currentAvgSystemTimes);
+  // ------------------------------------------
+}
+// ---------------------------
 
-  //   
-  std::map<int, double> currentChannelLoads;
-  for (int i = 1; i <= 3; i++) {
-    // :  totalTime
-    currentChannelLoads[i] = getChannelUtilization(i, totalTime > 0 ? totalTime : 1.0); //  totalTime   
+// --- Методы для графиков (ИСПРАВЛЕНО: Принимают currentTime, используют totalTime) ---
+void Database::snapshotStatistics(double currentTime) {
+  // Строка снапшота в порядке колонок TimeSeriesStore::columnIndex
+  double* values = snapshotRow.data();
+
+  for (int i = 1; i <= numSources; i++) {
+    values[series.columnIndex(SeriesMetric::REJECTION_RATE, i)] = getSourceRejectionRate(i); // p_отк = m_rej / n_gen
+    values[series.columnIndex(SeriesMetric::AVG_WAIT_TIME, i)] = getSourceAvgWaitTime(i); // avg T_ож
+    values[series.columnIndex(SeriesMetric::AVG_SERVICE_TIME, i)] = getSourceAvgServiceTime(i); // avg T_об
+    values[series.columnIndex(SeriesMetric::AVG_SYSTEM_TIME, i)] = getSourceAvgSystemTime(i); // avg T_преб
   }
-  channelLoadsOverTime.push_back(currentChannelLoads);
+
+  // Снимок загрузки каналов
+  for (int i = 1; i <= numChannels; i++) {
+    // Загрузка на момент снимка - делим на прошедшее модельное время
+    values[series.columnIndex(SeriesMetric::CHANNEL_LOAD, i)] = getChannelUtilization(i, currentTime > 0 ? currentTime : 1.0);
+  }
+
+  series.appendRow(currentTime, values);
 }
 
 void Database::printGraphData() const {
-  std::cout << "\n=====    (2) =====\n";
+  std::cout << "\n===== ДАННЫЕ ДЛЯ ГРАФИКОВ (ОР2) =====\n";
 
-  size_t numSnapshots = timePointsForGraphs.size();
-  if (numSnapshots == 0) {
-    std::cout << "    (snapshotStatistics  ).\n";
+  if (series.getLength() == 0) {
+    std::cout << "Нет данных для графиков (snapshotStatistics не вызывался).\n";
     return;
   }
 
-  std::cout << "\n--- :     ---\n";
+  std::cout << "\n--- График: Вероятность отказа по источникам ---\n";
   std::cout << "Time\tSource\tP_Otk\n";
-  for (size_t i = 0; i < numSnapshots; ++i) {
-    for (int j = 1; j <= 3; j++) {
-      //  at()  
-      std::cout << timePointsForGraphs[i] << "\t" << j << "\t" << rejectionRatesOverTime[i].at(j) << "\n";
-    }
-  }
+  series.printMetric(SeriesMetric::REJECTION_RATE);
 
-  std::cout << "\n--- :      ---\n";
+  std::cout << "\n--- График: Среднее время ожидания по источникам ---\n";
   std::cout << "Time\tSource\tT_Wait\n";
-  for (size_t i = 0; i < numSnapshots; ++i) {
-    for (int j = 1; j <= 3; j++) {
-      std::cout << timePointsForGraphs[i] << "\t" << j << "\t" << avgWaitTimesOverTime[i].at(j) << "\n";
-    }
-  }
+  series.printMetric(SeriesMetric::AVG_WAIT_TIME);
 
-  std::cout << "\n--- :      ---\n";
+  std::cout << "\n--- График: Среднее время обслуживания по источникам ---\n";
   std::cout << "Time\tSource\tT_Service\n";
-  for (size_t i = 0; i < numSnapshots; ++i) {
-    for (int j = 1; j <= 3; j++) {
-      std::cout << timePointsForGraphs[i] << "\t" << j << "\t" << avgServiceTimesOverTime[i].at(j) << "\n";
-    }
-  }
+  series.printMetric(SeriesMetric::AVG_SERVICE_TIME);
 
-  std::cout << "\n--- :       ---\n";
+  std::cout << "\n--- График: Среднее время в системе по источникам ---\n";
   std::cout << "Time\tSource\tT_System\n";
-  for (size_t i = 0; i < numSnapshots; ++i) {
-    for (int j = 1; j <= 3; j++) {
-      std::cout << timePointsForGraphs[i] << "\t" << j << "\t" << avgSystemTimesOverTime[i].at(j) << "\n";
-    }
-  }
+  series.printMetric(SeriesMetric::AVG_SYSTEM_TIME);
 
-  std::cout << "\n--- :   ---\n";
+  std::cout << "\n--- График: Загрузка каналов ---\n";
   std::cout << "Time\tChannel\tLoad\n";
-  for (size_t i = 0; i < numSnapshots; ++i) {
-    for (int j = 1; j <= 3; j++) {
-      std::cout << timePointsForGraphs[i] << "\t" << j << "\t" << channelLoadsOverTime[i].at(j) << "\n";
-    }
+  series.printMetric(SeriesMetric::CHANNEL_LOAD);
+}
+
+void Database::reserveSeries(std::size_t snapshots) { series.reserve(snapshots); }
+const TimeSeriesStore& Database::getSeries() const { return series; }
+// ---------------------------
+
+// --- Контрольная точка ---
+void Database::saveState(BinaryWriter& writer, bool withSeries) const {
+  writer.writePod(deliveredCount);
+  writer.writePod(rejectedCount);
+  writer.writePod(expiredCount);
+  writer.writePod(coalescedCount);
+  writer.writePod(retryCount);
+  writer.writePod(throttledCount);
+  writer.writePod(forwardedCount);
+  writer.writePod(statisticsStart);
+  writer.writePodVector(sourceGeneratedCount);
+  writer.writePodVector(sourceDelivered);
+  writer.writePodVector(sourceRejected);
+  writer.writePodVector(sourceExpired);
+  writer.writePodVector(sourceCoalesced);
+  writer.writePodVector(sourceRetries);
+  writer.writePodVector(sourceThrottled);
+  writer.writePodVector(sourceForwarded);
+  writer.writePodVector(sourceTotalWaitTime);
+  writer.writePodVector(sourceTotalWaitTimeSquared);
+  writer.writePodVector(sourceWaitedCount);
+  writer.writePodVector(sourceTotalServiceTime);
+  writer.writePodVector(sourceTotalServiceTimeSquared);
+  writer.writePodVector(sourceServicedCount);
+  writer.writePodVector(sourceTotalSystemTime);
+  writer.writePodVector(sourceTotalSystemTimeSquared);
+  writer.writePodVector(sourceProcessedCount);
+  writer.writePodVector(channelUsage);
+  writer.writePodVector(channelTotalServiceTime);
+  writer.writePodVector(channelTotalServiceTimeSquared);
+  writer.writePodVector(channelBatchItems);
+  writer.writePodVector(channelBufferDrained);
+  writer.writePodVector(channelOnlineSince);
+  writer.writePodVector(channelOnlineTime);
+  writer.writePodVector(sourceWaitHistogram);
+  writer.writePodVector(sourceServiceHistogram);
+  waitHistogram.saveState(writer);
+  responseHistogram.saveState(writer);
+  writer.writePod(numClasses);
+  writer.writePodVector(sourceClass);
+  for (int cls = 0; cls < numClasses; cls++) {
+    classWaitHistogram[cls].saveState(writer);
+    classResponseHistogram[cls].saveState(writer);
+  }
+  writer.writePod(batchCapacity);
+  writer.writePod(batchTAlpha);
+  writer.writePod<unsigned long long>(sourceBatchMeans.size());
+  for (const auto& batches : sourceBatchMeans) {
+    batches.saveState(writer);
   }
+  series.saveState(writer, withSeries);
 }
-// ---------------------------
\ No newline at end of file
+
+void Database::loadState(BinaryReader& reader, bool withSeries) {
+  reader.readPod(deliveredCount);
+  reader.readPod(rejectedCount);
+  reader.readPod(expiredCount);
+  reader.readPod(coalescedCount);
+  reader.readPod(retryCount);
+  reader.readPod(throttledCount);
+  reader.readPod(forwardedCount);
+  reader.readPod(statisticsStart);
+  reader.readPodVector(sourceGeneratedCount);
+  reader.readPodVector(sourceDelivered);
+  reader.readPodVector(sourceRejected);
+  reader.readPodVector(sourceExpired);
+  reader.readPodVector(sourceCoalesced);
+  reader.readPodVector(sourceRetries);
+  reader.readPodVector(sourceThrottled);
+  reader.readPodVector(sourceForwarded);
+  reader.readPodVector(sourceTotalWaitTime);
+  reader.readPodVector(sourceTotalWaitTimeSquared);
+  reader.readPodVector(sourceWaitedCount);
+  reader.readPodVector(sourceTotalServiceTime);
+  reader.readPodVector(sourceTotalServiceTimeSquared);
+  reader.readPodVector(sourceServicedCount);
+  reader.readPodVector(sourceTotalSystemTime);
+  reader.readPodVector(sourceTotalSystemTimeSquared);
+  reader.readPodVector(sourceProcessedCount);
+  reader.readPodVector(channelUsage);
+  // Размеры - по загруженным векторам: статистику можно читать в Database по умолчанию (ферма реплик)
+  numSources = static_cast<int>(sourceGeneratedCount.size()) - 1;
+  numChannels = static_cast<int>(channelUsage.size()) - 1;
+  reader.readPodVector(channelTotalServiceTime);
+  reader.readPodVector(channelTotalServiceTimeSquared);
+  reader.readPodVector(channelBatchItems);
+  reader.readPodVector(channelBufferDrained);
+  reader.readPodVector(channelOnlineSince);
+  reader.readPodVector(channelOnlineTime);
+  reader.readPodVector(sourceWaitHistogram);
+  reader.readPodVector(sourceServiceHistogram);
+  waitHistogram.loadState(reader);
+  responseHistogram.loadState(reader);
+  reader.readPod(numClasses);
+  reader.readPodVector(sourceClass);
+  classWaitHistogram.assign(numClasses, QuantileHistogram());
+  classResponseHistogram.assign(numClasses, QuantileHistogram());
+  for (int cls = 0; cls < numClasses; cls++) {
+    classWaitHistogram[cls].loadState(reader);
+    classResponseHistogram[cls].loadState(reader);
+  }
+  reader.readPod(batchCapacity);
+  reader.readPod(batchTAlpha);
+  sourceBatchMeans.resize(static_cast<std::size_t>(reader.readPod<unsigned long long>()));
+  for (auto& batches : sourceBatchMeans) {
+    batches.loadState(reader);
+  }
+  series.loadState(reader, withSeries);
+}
\ No newline at end of file
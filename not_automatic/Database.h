@@ -3,96 +3,227 @@
 #define DATABASE_H
 
 #include "Notification.h"
-#include <map>
+#include "TimeSeries.h"
+#include "LatencyHistogram.h"
+#include "QuantileHistogram.h"
+#include "BatchMeans.h"
 #include <string>
 #include <vector>
 
-//   (forward declaration)
+// Предварительное объявление (forward declaration)
 class Database;
+class BinaryWriter;
+class BinaryReader;
 
-//     
+// Равномерность загрузки каналов (для выбора политики диспетчера)
+struct UtilizationBalance {
+  double min;
+  double max;
+  double mean;
+  double cv; // Коэффициент вариации загрузок
+  double jain; // Индекс Джейна: 1 - поровну, 1/n - вся нагрузка на одном канале
+};
+
+// Показатели Таблицы 1, для которых ведутся интервалы методом пачек
+enum class SourceMetric {
+  REJECTION = 0, // p_отк: исход уведомления - 1 вытеснено, 0 доставлено
+  SYSTEM_TIME,   // T_преб
+  WAIT_TIME,     // T_ож
+  SERVICE_TIME,  // T_об
+  COUNT
+};
+
+// Класс Базы Данных для статистики
 class Database {
 private:
-  int deliveredCount;
-  int rejectedCount;
-  // ---  p_ = m/n_gen ---
-  std::map<int, int> sourceGeneratedCount; //    (n_gen) -    delivered/rejected
+  // Источники и каналы нумеруются с 1: накопители - векторы, индекс = номер.
+  // Ячейка 0 источников - уведомления, принятые из других шардов (см. ShardedSimulation)
+  int numSources;
+  int numChannels;
+  long long deliveredCount;
+  long long rejectedCount;
+  long long expiredCount; // Истекшие в буфере по TTL - отдельный исход, не отказ Д1ОО4
+  long long coalescedCount; // Влитые в уже ожидающее уведомление - ни ячейки, ни обслуживания
+  long long retryCount; // Переотправок вытесненных (каждая - дополнительное поступление)
+  long long throttledCount; // Не пропущенных ограничением интенсивности на входе - отдельный исход, не отказ Д1ОО4
+  long long forwardedCount; // Вытесненных, переданных в другой шард вместо отказа
+  double statisticsStart; // Модельное время последнего сброса: загрузка и интенсивности - за время с него
+  // --- Для p_отк = m/n_gen ---
+  std::vector<long long> sourceGeneratedCount; // Общее количество сгенерированных (n_gen) - нужно отдельно от delivered/rejected
   // -----------------------------
-  std::map<int, int> sourceDelivered; //   ( )
-  std::map<int, int> sourceRejected;  //   (m_rej)
-  // ---  T_ (T_) ---
-  std::map<int, double> sourceTotalWaitTime; //  T_
-  std::map<int, double> sourceTotalWaitTimeSquared; //   T_ ( )
-  std::map<int, int> sourceWaitedCount; //  ,   (    T_)
+  std::vector<long long> sourceDelivered; // Количество доставленных (начало обслуживания)
+  std::vector<long long> sourceRejected;  // Количество вытесненных (m_rej)
+  std::vector<long long> sourceExpired;   // Количество истекших по TTL
+  std::vector<long long> sourceCoalesced; // Количество объединенных с ожидающими
+  std::vector<long long> sourceRetries; // Попыток повтора по источникам
+  std::vector<long long> sourceThrottled; // Не пропущенных на входе по источникам
+  std::vector<long long> sourceForwarded; // Переданных в другой шард по источникам
+  // --- Для T_ожидания (T_БП) ---
+  std::vector<double> sourceTotalWaitTime; // Сумма T_ожидания
+  std::vector<double> sourceTotalWaitTimeSquared; // Сумма квадратов T_ожидания (для дисперсии)
+  std::vector<long long> sourceWaitedCount; // Количество заявок, которые ждали (для усреднения и дисперсии T_ож)
   // ------------------------------
-  // ---  T_ (T_) ---
-  std::map<int, double> sourceTotalServiceTime; //  T_ (  )
-  std::map<int, double> sourceTotalServiceTimeSquared; //   T_ ( )
-  std::map<int, int> sourceServicedCount; //  ,   (    T_)
+  // --- Для T_обслуживания (T_об) ---
+  std::vector<double> sourceTotalServiceTime; // Сумма T_обслуживания (переданное из канала)
+  std::vector<double> sourceTotalServiceTimeSquared; // Сумма квадратов T_обслуживания (для дисперсии)
+  std::vector<long long> sourceServicedCount; // Количество заявок, которые обслуживались (для усреднения и дисперсии T_об)
   // -----------------------------------
-  // ---  T_ (T_) ---
-  std::map<int, double> sourceTotalSystemTime; //  T_ (  T_ + T_)
-  std::map<int, double> sourceTotalSystemTimeSquared; //   T_ ( )
-  std::map<int, int> sourceProcessedCount; //  ,   (    T_)
+  // --- Для T_пребывания (T_преб) ---
+  std::vector<double> sourceTotalSystemTime; // Сумма T_пребывания (для проверки T_ож + T_об)
+  std::vector<double> sourceTotalSystemTimeSquared; // Сумма квадратов T_пребывания (для дисперсии)
+  std::vector<long long> sourceProcessedCount; // Количество заявок, завершивших обслуживание (для усреднения и дисперсии T_преб)
   // ----------------------------------
-  std::map<int, int> channelUsage; //  ,    
-  std::map<int, double> channelTotalServiceTime; //    
-  std::map<int, double> channelTotalServiceTimeSquared; //      ( )
-
-  // ---    ---
-  std::vector<double> timePointsForGraphs;
-  std::vector<std::map<int, double>> rejectionRatesOverTime; // p_ = rejected / generated
-  std::vector<std::map<int, double>> avgWaitTimesOverTime; // avg T_
-  std::vector<std::map<int, double>> avgServiceTimesOverTime; // avg T_
-  std::vector<std::map<int, double>> avgSystemTimesOverTime; // avg T_
-  std::vector<std::map<int, double>> channelLoadsOverTime; // load
+  std::vector<long long> channelUsage; // Количество раз, когда канал начал обслуживание
+  std::vector<double> channelTotalServiceTime; // Суммарное время обслуживания каналом
+  std::vector<double> channelTotalServiceTimeSquared; // Сумма квадратов времени обслуживания каналом (для дисперсии)
+  std::vector<long long> channelBatchItems; // Уведомлений, обслуженных пачками (для пакетного канала захват = пачка)
+  std::vector<long long> channelBufferDrained; // Из них выбрано из буфера
+  // --- Время работы каналов (для автомасштабирования - канало-часы) ---
+  std::vector<double> channelOnlineSince; // Начало текущего периода работы, -1 - канал не работает
+  std::vector<double> channelOnlineTime; // Сумма закрытых периодов работы
+  // Все накопители каналов - по номеру: автомасштабирование отдает номер снятого канала следующему
+  // введенному, и их статистика складывается (загрузка номера - доля времени, когда он обслуживал)
+  // --- Распределения времен (для экспорта метрик) ---
+  std::vector<LatencyHistogram> sourceWaitHistogram; // T_ож по источникам
+  std::vector<LatencyHistogram> sourceServiceHistogram; // T_об по источникам
+  // По всем источникам - точные квантили для сравнения политик и плана мощности
+  QuantileHistogram waitHistogram; // T_ож
+  QuantileHistogram responseHistogram; // T_отклика = T_ож + T_об (T_преб Таблицы 1 - только до входа в канал)
+  // --- Классы уведомлений (только если заданы через configureClasses) ---
+  int numClasses; // 0 - классы не учитываются
+  std::vector<int> sourceClass; // Класс уведомлений источника
+  // Квантили по классам - для SLO транзакционного класса: корзины 16-корзинной гистограммы
+  // различают p99 только с точностью до двух раз
+  std::vector<QuantileHistogram> classWaitHistogram; // T_ож по классам
+  std::vector<QuantileHistogram> classResponseHistogram; // T_отклика по классам
+  // --- Интервалы одного длинного прогона (только если заданы через configureBatchMeans) ---
+  int batchCapacity; // Пачек на показатель, 0 - не ведутся
+  double batchTAlpha;
+  std::vector<BatchMeans> sourceBatchMeans; // [номер источника * SourceMetric::COUNT + показатель]
+
+  // --- Данные для графиков ---
+  // p_отк, avg T_ож, avg T_об, avg T_преб по источникам и загрузка каналов - по колонкам
+  TimeSeriesStore series;
+  std::vector<double> snapshotRow; // Строка снапшота (без выделения памяти на каждый снапшот)
   // ---------------------------
 
+  bool isSource(int sourceId) const;
+  bool isChannel(int channelId) const;
+  void recordSourceDelivery(const Notification& notification, double serviceTime); // Накопители источника
+
 public:
-  Database();
+  Database(int numSources = 3, int numChannels = 3);
 
-  // ---   ---
-  // serviceTime   
+  // --- Методы записи ---
+  // serviceTime передаётся из канала
   void recordDelivery(const Notification& notification, double serviceTime, int channelId);
+  // Пачка пакетного канала: T_об каждого = время пачки, занятость канала - один раз.
+  // fromBuffer - сколько уведомлений пачки выбрано из буфера
+  void recordBatchDelivery(const std::vector<Notification>& batch, double batchTime, int channelId, int fromBuffer);
   void recordRejection(const Notification& notification);
-  void recordGeneration(int sourceId); // :   n_gen
+  void recordExpiry(const Notification& notification); // Срок жизни истек в буфере
+  void recordCoalescing(const Notification& notification); // Поступившее влито в ожидающее с тем же ключом
+  void recordRetry(const Notification& notification); // Вытесненное запланировано на повтор (вместо отказа)
+  void recordThrottle(const Notification& notification); // Не пропущено маркерной корзиной источника
+  void recordForward(const Notification& notification); // Вытесненное передано в другой шард
+  void recordGeneration(int sourceId); // Новое: для учёта n_gen
+  void recordChannelOnline(int channelId, double time); // Канал введен в работу
+  void recordChannelOffline(int channelId, double time); // Канал снят
   // -------------------
-  void reset();
-
-  // ---   ---
-  //    const-friendly,  find/at
-  int getSourceGeneratedCount(int sourceId) const; // n_gen
-  int getSourceDeliveredCount(int sourceId) const; // n_delivered
-  int getSourceRejectedCount(int sourceId) const; // m_rejected
-  double getSourceRejectionRate(int sourceId) const; // p_ = rejected / generated_for_source
-  double getSourceAvgWaitTime(int sourceId) const; // T_
-  double getSourceAvgServiceTime(int sourceId) const; // T_ (  serviceTime)
-  double getSourceAvgSystemTime(int sourceId) const; // T_
-  double getSourceVarianceWaitTime(int sourceId) const; // D_
-  double getSourceVarianceServiceTime(int sourceId) const; // D_ ( serviceTime)
+  // Сброс накопителей в момент time (отсечение разгона): загрузка и интенсивности далее - за время после time.
+  // На месте, без выделений; классы и настройка пачек сохраняются, ряды графиков продолжаются
+  void reset(double time = 0.0);
+  // Добавить накопители другого прогона того же сценария (реплики, рабочие процессы фермы).
+  // Суммы, счетчики и гистограммы складываются; ряды графиков и открытые периоды работы каналов
+  // не сливаются. Загрузка каналов после слияния - по суммарному модельному времени реплик
+  void merge(const Database& other);
+  // Класс каждого источника (индекс = номер источника) - включает учет по классам
+  void configureClasses(const std::vector<int>& classBySource);
+  // Интервалы по каждому показателю Таблицы 1 каждого источника методом пачек (capacity пачек в памяти).
+  // После reset настройка сохраняется, а пачки начинаются заново; при merge не сливаются
+  void configureBatchMeans(int capacity, double tAlpha);
+  bool hasBatchMeans() const;
+  const BatchMeans& getSourceBatchMeans(int sourceId, SourceMetric metric) const;
+  // Все показатели всех источников: пачки некоррелированы и полуширина <= precision * |среднее|
+  bool isPrecisionReached(double precision) const;
+
+  // --- Методы получения ---
+  // Для номеров вне 1..numSources / 1..numChannels возвращают 0
+  long long getSourceGeneratedCount(int sourceId) const; // n_gen
+  long long getSourceDeliveredCount(int sourceId) const; // n_delivered
+  long long getSourceRejectedCount(int sourceId) const; // m_rejected
+  long long getSourceExpiredCount(int sourceId) const; // Истекшие по TTL
+  long long getSourceCoalescedCount(int sourceId) const; // Объединенные
+  long long getSourceRetryCount(int sourceId) const; // Попытки повтора
+  long long getSourceThrottledCount(int sourceId) const; // Не пропущенные на входе
+  long long getSourceForwardedCount(int sourceId) const; // Переданные в другой шард
+  double getSourceRejectionRate(int sourceId) const; // p_отк = rejected / generated_for_source
+  double getSourceAvgWaitTime(int sourceId) const; // T_ож
+  double getSourceAvgServiceTime(int sourceId) const; // T_об (приблизительно из serviceTime)
+  double getSourceAvgSystemTime(int sourceId) const; // T_преб
+  double getSourceVarianceWaitTime(int sourceId) const; // D_ож
+  double getSourceVarianceServiceTime(int sourceId) const; // D_об (из serviceTime)
+  LatencyHistogram getSourceWaitHistogram(int sourceId) const; // Распределение T_ож
+  LatencyHistogram getSourceServiceHistogram(int sourceId) const; // Распределение T_об
+  const QuantileHistogram& getWaitHistogram() const; // T_ож по всем источникам
+  const QuantileHistogram& getResponseHistogram() const; // T_отклика = T_ож + T_об по всем источникам
+  // По классам: для номеров вне 0..numClasses-1 - нулевая статистика
+  int getClassCount() const;
+  double getClassRejectionRate(int cls) const; // p_отк по всем источникам класса
+  const QuantileHistogram& getClassWaitHistogram(int cls) const;
+  const QuantileHistogram& getClassResponseHistogram(int cls) const;
   // -------------------------
-  int getDeliveredCount() const;
-  int getRejectedCount() const;
-  int getTotalProcessed() const; // delivered + rejected
+  long long getDeliveredCount() const;
+  long long getRejectedCount() const;
+  long long getExpiredCount() const;
+  long long getCoalescedCount() const; // Сэкономленные обслуживания каналов
+  long long getRetryCount() const;
+  long long getThrottledCount() const;
+  long long getForwardedCount() const;
+  long long getReceivedDeliveredCount() const; // Принятые из других шардов: доставлены
+  long long getReceivedRejectedCount() const; // Принятые из других шардов: вытеснены окончательно
+  long long getTotalProcessed() const; // delivered + rejected
 
   double getRejectionRate() const; // (delivered + rejected) > 0 ? rejected / (delivered + rejected) : 0
+  // Средние по всем источникам (взвешены числом заявок)
+  double getAvgWaitTime() const;
+  double getAvgServiceTime() const;
+  double getAvgSystemTime() const;
+  double getTotalWaitTime() const; // Сумма T_ож по всем источникам
+  long long getWaitedCount() const;
+  double getStatisticsStart() const;
 
-  int getChannelUsage(int channelId) const;
-  // --- :  totalTime ---
+  long long getChannelUsage(int channelId) const; // Для пакетного канала - число пачек
+  long long getChannelBatchItems(int channelId) const; // Уведомлений в пачках
+  long long getChannelBufferDrained(int channelId) const; // Из них выбрано из буфера
+  // --- ИСПРАВЛЕНО: Добавлен totalTime ---
   double getChannelUtilization(int channelId, double totalTime) const; // (sum_service_time) / totalTime
+  double getChannelBusyTime(int channelId) const; // Накопленное время обслуживания
+  double getTotalBusyTime() const; // По всем каналам
+  bool wasChannelOnline(int channelId) const; // Работал ли канал хоть раз (ячейки про запас - нет)
+  double getChannelHours(double currentTime) const; // Суммарное время работы всех каналов
+  long long getGeneratedCount() const;
+  UtilizationBalance getUtilizationBalance(double totalTime) const;
   // ---------------------------------------
-  double getChannelVarianceServiceTime(int channelId, double totalTime) const; // D_ ()
+  double getChannelVarianceServiceTime(int channelId, double totalTime) const; // D_канала (аппроксимация)
 
-  // ---   ---
-  // :  totalTime 
+  // --- Метод вывода ---
+  // ИСПРАВЛЕНО: Принимает totalTime извне
   void printStatistics(double totalTime) const;
   // -------------------
 
-  // ---    ---
-  // :  currentTime 
+  // --- Методы для графиков ---
+  // ИСПРАВЛЕНО: Принимает currentTime извне
   void snapshotStatistics(double currentTime);
   void printGraphData() const;
+  void reserveSeries(std::size_t snapshots); // Ожидаемое число снапшотов - без перевыделений
+  const TimeSeriesStore& getSeries() const; // Для выгрузки в CSV / двоичный файл
   // ---------------------------
+
+  // Контрольная точка: все накопители и ряды снапшотов.
+  // withSeries = false - компактный снимок для шкалы времени: от рядов хранится только длина
+  void saveState(BinaryWriter& writer, bool withSeries = true) const;
+  void loadState(BinaryReader& reader, bool withSeries = true);
 };
 
 #endif // DATABASE_H
\ No newline at end of file
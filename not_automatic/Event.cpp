@@ -1,6 +1,26 @@
 // Event.cpp
 #include "Event.h"
+#include <stdexcept>
 
-Event::Event(double t, const std::string& tp, int src, int nid, int cid)
-  : time(t), type(tp), sourceId(src), notificationId(nid), channelId(cid) {
+const char* eventTypeName(EventType type) {
+  switch (type) {
+  case EventType::GEN: return "GEN";
+  case EventType::FREE_CHAN: return "FREE_CHAN";
+  case EventType::RETRY: return "RETRY";
+  case EventType::FORWARD: return "FORWARD";
+  case EventType::SCALE: return "SCALE";
+  case EventType::CHAN_UP: return "CHAN_UP";
+  default: return "UNKNOWN";
+  }
+}
+
+EventType parseEventType(const std::string& name) {
+  const EventType types[] = { EventType::GEN, EventType::FREE_CHAN, EventType::RETRY,
+    EventType::FORWARD, EventType::SCALE, EventType::CHAN_UP };
+  for (EventType type : types) {
+    if (name == eventTypeName(type)) {
+      return type;
+    }
+  }
+  throw std::runtime_error("Неизвестный тип события: " + name);
 }
\ No newline at end of file
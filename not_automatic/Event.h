@@ -2,25 +2,49 @@
 #ifndef EVENT_H
 #define EVENT_H
 
+#include <cstdint>
+#include <queue> // Для std::priority_queue
 #include <string>
-#include <functional>
+#include <vector>
 
+// Тип события календаря. Перечисление вместо строки: событие без выделения памяти,
+// ветвление в processNextEvent() по целому
+enum class EventType : std::uint8_t {
+  GEN,       // Генерация уведомления источником
+  FREE_CHAN, // Освобождение канала
+  RETRY,     // Повтор вытесненного уведомления
+  FORWARD,   // Уведомление, переданное из другого шарда
+  SCALE,     // Шаг контроллера автомасштабирования
+  CHAN_UP    // Готовность заказанного канала
+};
+
+// Имя типа ("GEN", "FREE_CHAN", ...) - для вывода и контрольных точек
+const char* eventTypeName(EventType type);
+// Обратное преобразование; неизвестное имя - исключение
+EventType parseEventType(const std::string& name);
 
+// Структура События
 struct Event {
   double time;
-  std::string type; 
-  int sourceId;    
-  int notificationId; 
-  int channelId;    
+  EventType type;
+  int sourceId;     // Для событий генерации
+  int notificationId; // Для событий генерации
+  int channelId;    // Для событий освобождения канала (и ячейка пула для RETRY/FORWARD)
 
-  Event(double t, const std::string& tp, int src = -1, int nid = -1, int cid = -1);
+  Event() : Event(0.0, EventType::GEN) {}
+  Event(double t, EventType tp, int src = -1, int nid = -1, int cid = -1)
+    : time(t), type(tp), sourceId(src), notificationId(nid), channelId(cid) {
+  }
 };
 
-
+// Компаратор для std::priority_queue (min-heap по времени)
 struct EventComparator {
   bool operator()(const Event& a, const Event& b) const {
-    return a.time > b.time;
+    return a.time > b.time; // min-heap по времени
   }
 };
 
+// Тип для календаря событий
+using EventQueue = std::priority_queue<Event, std::vector<Event>, EventComparator>;
+
 #endif // EVENT_H
\ No newline at end of file
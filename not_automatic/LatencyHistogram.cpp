@@ -0,0 +1,60 @@
+// LatencyHistogram.cpp
+#include "LatencyHistogram.h"
+#include <cmath> // Для ldexp
+#include <limits> // Для numeric_limits
+
+LatencyHistogram::LatencyHistogram() : counts(), count(0), sum(0.0) {}
+
+double LatencyHistogram::upperBound(int bucket) {
+  if (bucket >= kBucketCount - 1) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return std::ldexp(0.0625, bucket);
+}
+
+void LatencyHistogram::record(double value) {
+  int bucket = 0;
+  while (bucket < kBucketCount - 1 && value > upperBound(bucket)) {
+    bucket++;
+  }
+  counts[bucket]++;
+  count++;
+  sum += value;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kBucketCount; i++) {
+    counts[i] += other.counts[i];
+  }
+  count += other.count;
+  sum += other.sum;
+}
+
+void LatencyHistogram::reset() {
+  *this = LatencyHistogram();
+}
+
+long long LatencyHistogram::getCount() const { return count; }
+double LatencyHistogram::getSum() const { return sum; }
+double LatencyHistogram::getMean() const { return count > 0 ? sum / count : 0.0; }
+long long LatencyHistogram::getBucketCount(int bucket) const { return counts[bucket]; }
+
+double LatencyHistogram::quantile(double q) const {
+  if (count == 0) {
+    return 0.0;
+  }
+  double rank = q * count;
+  long long below = 0;
+  for (int i = 0; i < kBucketCount; i++) {
+    if (counts[i] > 0 && below + counts[i] >= rank) {
+      double lower = (i == 0) ? 0.0 : upperBound(i - 1);
+      if (i == kBucketCount - 1) {
+        return lower; // Верхней границы нет - возвращаем нижнюю
+      }
+      double fraction = (rank - below) / counts[i];
+      return lower + (upperBound(i) - lower) * fraction;
+    }
+    below += counts[i];
+  }
+  return upperBound(kBucketCount - 2);
+}
\ No newline at end of file
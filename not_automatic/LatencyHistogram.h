@@ -0,0 +1,35 @@
+// LatencyHistogram.h
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+// Гистограмма времен (T_ож, T_об) с фиксированными границами корзин:
+// 0.0625 * 2^k модельных единиц, k = 0..14, последняя корзина - без верхней границы.
+// Тривиально копируема - пишется в контрольную точку как есть
+class LatencyHistogram {
+public:
+  static const int kBucketCount = 16;
+
+private:
+  long long counts[kBucketCount]; // Не накопительные: число значений в каждой корзине
+  long long count;
+  double sum;
+
+public:
+  LatencyHistogram();
+
+  static double upperBound(int bucket); // Для последней корзины - бесконечность
+
+  void record(double value);
+  void merge(const LatencyHistogram& other);
+  void reset();
+
+  long long getCount() const;
+  double getSum() const;
+  double getMean() const;
+  long long getBucketCount(int bucket) const;
+
+  // Квантиль q (0..1) с линейной интерполяцией внутри корзины
+  double quantile(double q) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
\ No newline at end of file
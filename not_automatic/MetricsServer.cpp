@@ -0,0 +1,262 @@
+// MetricsServer.cpp
+#include "MetricsServer.h"
+#include "SocketAddress.h"
+#include <charconv> // Для to_chars
+#include <cmath> // Для isinf
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// --- Формат экспозиции ---
+namespace {
+
+  void appendNumber(std::string& out, double value) {
+    if (std::isinf(value)) {
+      out += "+Inf";
+      return;
+    }
+    char text[32];
+    auto result = std::to_chars(text, text + sizeof(text), value);
+    out.append(text, result.ptr);
+  }
+
+  void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help; // Только ASCII: исходники в cp1251, а формат требует UTF-8
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+  }
+
+  void appendSample(std::string& out, const char* name, const char* label, int id, double value) {
+    out += name;
+    out += '{';
+    out += label;
+    out += "=\"";
+    out += std::to_string(id);
+    out += "\"} ";
+    appendNumber(out, value);
+    out += '\n';
+  }
+
+  void appendHistogram(std::string& out, const char* name, int sourceId, const LatencyHistogram& histogram) {
+    std::string labels = "source=\"" + std::to_string(sourceId) + "\"";
+    long long cumulative = 0;
+    for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+      cumulative += histogram.getBucketCount(i);
+      out += name;
+      out += "_bucket{" + labels + ",le=\"";
+      appendNumber(out, LatencyHistogram::upperBound(i));
+      out += "\"} " + std::to_string(cumulative) + "\n";
+    }
+    out += name;
+    out += "_sum{" + labels + "} ";
+    appendNumber(out, histogram.getSum());
+    out += '\n';
+    out += name;
+    out += "_count{" + labels + "} " + std::to_string(histogram.getCount()) + "\n";
+  }
+
+}
+
+std::string renderPrometheus(const MetricsSnapshot& snapshot) {
+  std::string out;
+  out.reserve(8192);
+
+  appendHeader(out, "notifyme_model_time", "gauge", "Current model time");
+  out += "notifyme_model_time ";
+  appendNumber(out, snapshot.modelTime);
+  out += '\n';
+  appendHeader(out, "notifyme_events_total", "counter", "Processed calendar events");
+  out += "notifyme_events_total " + std::to_string(snapshot.events) + "\n";
+
+  appendHeader(out, "notifyme_generated_total", "counter", "Notifications generated per source");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_generated_total", "source", source.id, source.generated);
+  }
+  appendHeader(out, "notifyme_delivered_total", "counter", "Notifications that started service per source");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_delivered_total", "source", source.id, source.delivered);
+  }
+  appendHeader(out, "notifyme_rejected_total", "counter", "Notifications evicted from the buffer per source");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_rejected_total", "source", source.id, source.rejected);
+  }
+  appendHeader(out, "notifyme_expired_total", "counter", "Notifications whose TTL ran out in the buffer per source");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_expired_total", "source", source.id, source.expired);
+  }
+  appendHeader(out, "notifyme_throttled_total", "counter", "Arrivals refused by the per-source token bucket at ingress");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_throttled_total", "source", source.id, source.throttled);
+  }
+  appendHeader(out, "notifyme_coalesced_total", "counter", "Notifications merged into a buffered one with the same collapse key per source");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_coalesced_total", "source", source.id, source.coalesced);
+  }
+  appendHeader(out, "notifyme_rejection_rate", "gauge", "Rejected / generated per source");
+  for (const auto& source : snapshot.sources) {
+    appendSample(out, "notifyme_rejection_rate", "source", source.id, source.rejectionRate);
+  }
+
+  appendHeader(out, "notifyme_buffer_occupancy", "gauge", "Occupied buffer slots");
+  out += "notifyme_buffer_occupancy " + std::to_string(snapshot.bufferUsed) + "\n";
+  appendHeader(out, "notifyme_buffer_capacity", "gauge", "Buffer capacity");
+  out += "notifyme_buffer_capacity " + std::to_string(snapshot.bufferCapacity) + "\n";
+
+  appendHeader(out, "notifyme_channel_busy", "gauge", "1 if the channel is serving a notification");
+  for (const auto& channel : snapshot.channels) {
+    appendSample(out, "notifyme_channel_busy", "channel", channel.id, channel.busy ? 1.0 : 0.0);
+  }
+  appendHeader(out, "notifyme_channel_services_total", "counter", "Services started per channel");
+  for (const auto& channel : snapshot.channels) {
+    appendSample(out, "notifyme_channel_services_total", "channel", channel.id, channel.usage);
+  }
+  appendHeader(out, "notifyme_channel_batch_items_total", "counter", "Notifications served in batches per channel");
+  for (const auto& channel : snapshot.channels) {
+    appendSample(out, "notifyme_channel_batch_items_total", "channel", channel.id, channel.batchItems);
+  }
+  appendHeader(out, "notifyme_channel_utilization", "gauge", "Busy time / model time per channel");
+  for (const auto& channel : snapshot.channels) {
+    appendSample(out, "notifyme_channel_utilization", "channel", channel.id, channel.utilization);
+  }
+
+  appendHeader(out, "notifyme_wait_time", "histogram", "Time in buffer before service, model time units");
+  for (const auto& source : snapshot.sources) {
+    appendHistogram(out, "notifyme_wait_time", source.id, source.waitTime);
+  }
+  appendHeader(out, "notifyme_service_time", "histogram", "Service time, model time units");
+  for (const auto& source : snapshot.sources) {
+    appendHistogram(out, "notifyme_service_time", source.id, source.serviceTime);
+  }
+  return out;
+}
+
+// --- MetricsExchange ---
+MetricsExchange::MetricsExchange() : slots(), middle(1), back(0), front(2) {}
+
+MetricsSnapshot& MetricsExchange::writeSlot() { return slots[back]; }
+
+void MetricsExchange::publish() {
+  back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & ~kFresh;
+}
+
+const MetricsSnapshot& MetricsExchange::read() {
+  if (middle.load(std::memory_order_relaxed) & kFresh) {
+    front = middle.exchange(front, std::memory_order_acq_rel) & ~kFresh;
+  }
+  return slots[front];
+}
+
+// --- MetricsServer ---
+MetricsServer::MetricsServer(const std::string& address)
+  : exchange(), address(address), unixPath(), listenFd(-1), stopping(false), scrapes(0), worker() {
+#ifdef _WIN32
+  throw std::runtime_error("Сервер метрик доступен только на POSIX-системах");
+#else
+  unixPath = unixSocketPath(address);
+  listenFd = openStreamSocket(address, true, 16);
+  if (listenFd < 0) {
+    throw std::runtime_error("Не удалось открыть адрес сервера метрик: " + address);
+  }
+  worker = std::thread(&MetricsServer::serve, this);
+#endif
+}
+
+MetricsServer::~MetricsServer() {
+  stop();
+}
+
+MetricsSnapshot& MetricsServer::writeSlot() { return exchange.writeSlot(); }
+void MetricsServer::publish() { exchange.publish(); }
+const std::string& MetricsServer::getAddress() const { return address; }
+long long MetricsServer::getScrapes() const { return scrapes.load(); }
+
+void MetricsServer::stop() {
+  if (stopping.exchange(true)) {
+    return;
+  }
+  if (worker.joinable()) {
+    worker.join();
+  }
+#ifndef _WIN32
+  if (listenFd >= 0) {
+    ::close(listenFd);
+    listenFd = -1;
+  }
+  if (!unixPath.empty()) {
+    ::unlink(unixPath.c_str());
+  }
+#endif
+}
+
+void MetricsServer::serve() {
+#ifndef _WIN32
+  while (!stopping.load()) {
+    // Ожидание с таймаутом - чтобы вовремя заметить stop()
+    pollfd waitFor{ listenFd, POLLIN, 0 };
+    if (::poll(&waitFor, 1, 200) <= 0) {
+      continue;
+    }
+    int client = ::accept(listenFd, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    handleClient(client);
+    ::close(client);
+  }
+#endif
+}
+
+void MetricsServer::handleClient(int client) {
+#ifndef _WIN32
+  // Читаем заголовки запроса (до пустой строки), ждем не дольше секунды
+  std::string request;
+  char chunk[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+    pollfd waitFor{ client, POLLIN, 0 };
+    if (::poll(&waitFor, 1, 1000) <= 0) {
+      return;
+    }
+    ssize_t received = ::recv(client, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+      break;
+    }
+    request.append(chunk, static_cast<std::size_t>(received));
+  }
+
+  std::string status = "200 OK";
+  std::string body;
+  if (request.rfind("GET /metrics", 0) == 0 || request.rfind("GET / ", 0) == 0) {
+    body = renderPrometheus(exchange.read());
+    scrapes++;
+  }
+  else {
+    status = "404 Not Found";
+    body = "Use GET /metrics\n";
+  }
+
+  std::string response = "HTTP/1.0 " + status + "\r\n"
+    "Content-Type: text/plain; version=0.0.4\r\n"
+    "Content-Length: " + std::to_string(body.size()) + "\r\n"
+    "Connection: close\r\n\r\n" + body;
+  std::size_t sent = 0;
+  while (sent < response.size()) {
+    ssize_t written = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+    if (written <= 0) {
+      return;
+    }
+    sent += static_cast<std::size_t>(written);
+  }
+#else
+  (void)client;
+#endif
+}
\ No newline at end of file
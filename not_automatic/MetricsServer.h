@@ -0,0 +1,94 @@
+// MetricsServer.h
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Текущее состояние прогона для экспорта метрик
+struct MetricsSnapshot {
+  struct SourceMetrics {
+    int id;
+    long long generated;
+    long long delivered;
+    long long rejected;
+    long long expired;
+    long long coalesced;
+    long long throttled;
+    double rejectionRate;
+    LatencyHistogram waitTime;
+    LatencyHistogram serviceTime;
+  };
+  struct ChannelMetrics {
+    int id;
+    bool busy;
+    long long usage;
+    long long batchItems; // Уведомлений в пачках (0 у обычного канала)
+    double utilization;
+  };
+
+  double modelTime = 0.0;
+  long long events = 0;
+  int bufferUsed = 0;
+  int bufferCapacity = 0;
+  std::vector<SourceMetrics> sources;
+  std::vector<ChannelMetrics> channels;
+};
+
+// Текстовый формат экспозиции Prometheus (0.0.4)
+std::string renderPrometheus(const MetricsSnapshot& snapshot);
+
+// Обмен снимками между потоком модели и потоком сервера без блокировок (тройной буфер):
+// модель заполняет свой слот и обменивает его со средним, сервер забирает средний, если он новее.
+// Ни одна сторона не ждет другую
+class MetricsExchange {
+private:
+  static const int kFresh = 4; // Флаг "средний слот еще не прочитан"
+
+  MetricsSnapshot slots[3];
+  std::atomic<int> middle;
+  int back;  // Слот модели
+  int front; // Слот сервера
+
+public:
+  MetricsExchange();
+
+  MetricsSnapshot& writeSlot(); // Только поток модели
+  void publish(); // Только поток модели
+  const MetricsSnapshot& read(); // Только поток сервера
+};
+
+// Встроенный HTTP-сервер метрик в отдельном потоке.
+// address: "порт" или "хост:порт" (по умолчанию 127.0.0.1) или "unix:/путь/к/сокету".
+// Отвечает на GET /metrics; пример: curl http://127.0.0.1:9464/metrics
+class MetricsServer {
+private:
+  MetricsExchange exchange;
+  std::string address;
+  std::string unixPath;
+  int listenFd;
+  std::atomic<bool> stopping;
+  std::atomic<long long> scrapes;
+  std::thread worker;
+
+  void serve();
+  void handleClient(int client);
+
+public:
+  explicit MetricsServer(const std::string& address);
+  ~MetricsServer();
+  MetricsServer(const MetricsServer&) = delete;
+  MetricsServer& operator=(const MetricsServer&) = delete;
+
+  MetricsSnapshot& writeSlot(); // Заполнить и опубликовать - из потока модели
+  void publish();
+
+  const std::string& getAddress() const;
+  long long getScrapes() const;
+  void stop();
+};
+
+#endif // METRICS_SERVER_H
\ No newline at end of file
@@ -1,41 +1,41 @@
 // Notification.cpp
 #include "Notification.h"
+#include "Checkpoint.h"
 
 Notification::Notification()
-  : id(0), sourceId(0), creationTime(std::chrono::system_clock::now()),
+  : id(0), sourceId(0), creationTime(0.0),
   status(NotificationStatus::REJECTED),
-  enterBufferTime(std::chrono::system_clock::time_point::min()),
-  leaveBufferTime(std::chrono::system_clock::time_point::min()),
-  enterChannelTime(std::chrono::system_clock::time_point::min()) {
+  enterBufferTime(-1.0), leaveBufferTime(-1.0), enterChannelTime(-1.0),
+  deviceId(0), collapseKey(0), payloadId(0), coalescedCount(0), retryCount(0), forwardCount(0), priorityClass(0) {
 }
 
-Notification::Notification(int id, int sourceId)
-  : id(id), sourceId(sourceId), creationTime(std::chrono::system_clock::now()),
+Notification::Notification(int id, int sourceId, double creationTime)
+  : id(id), sourceId(sourceId), creationTime(creationTime),
   status(NotificationStatus::CREATED),
-  enterBufferTime(std::chrono::system_clock::time_point::min()),
-  leaveBufferTime(std::chrono::system_clock::time_point::min()),
-  enterChannelTime(std::chrono::system_clock::time_point::min()) {
+  enterBufferTime(-1.0), leaveBufferTime(-1.0), enterChannelTime(-1.0),
+  deviceId(0), collapseKey(0), payloadId(id), coalescedCount(0), retryCount(0), forwardCount(0), priorityClass(0) {
 }
 
 int Notification::getId() const { return id; }
 int Notification::getSourceId() const { return sourceId; }
+double Notification::getCreationTime() const { return creationTime; }
 NotificationStatus Notification::getStatus() const { return status; }
 void Notification::setStatus(NotificationStatus newStatus) { status = newStatus; }
 
-void Notification::setEnterBufferTime() { enterBufferTime = std::chrono::system_clock::now(); }
-void Notification::setLeaveBufferTime() { leaveBufferTime = std::chrono::system_clock::now(); } // 
-void Notification::setEnterChannelTime() { enterChannelTime = std::chrono::system_clock::now(); }
+void Notification::setEnterBufferTime(double time) { enterBufferTime = time; }
+void Notification::setLeaveBufferTime(double time) { leaveBufferTime = time; }
+void Notification::setEnterChannelTime(double time) { enterChannelTime = time; }
 
 double Notification::getWaitTime() const {
-  if (enterBufferTime.time_since_epoch().count() != 0 && leaveBufferTime.time_since_epoch().count() != 0) {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(leaveBufferTime - enterBufferTime).count() / 1000.0;
+  if (enterBufferTime >= 0.0 && leaveBufferTime >= 0.0) {
+    return leaveBufferTime - enterBufferTime;
   }
   return 0.0;
 }
 
 double Notification::getSystemTime() const {
-  if (creationTime.time_since_epoch().count() != 0 && enterChannelTime.time_since_epoch().count() != 0) {
-    return std::chrono::duration_cast<std::chrono::milliseconds>(enterChannelTime - creationTime).count() / 1000.0;
+  if (enterChannelTime >= 0.0) {
+    return enterChannelTime - creationTime;
   }
   return 0.0;
 }
@@ -47,6 +47,74 @@ std::string Notification::getStatusString() const {
   case NotificationStatus::PROCESSING: return "PROCESSING";
   case NotificationStatus::PROCESSED: return "PROCESSED";
   case NotificationStatus::REJECTED: return "REJECTED";
+  case NotificationStatus::EXPIRED: return "EXPIRED";
+  case NotificationStatus::THROTTLED: return "THROTTLED";
   default: return "UNKNOWN";
   }
+}
+
+void Notification::setAudience(int device, int key) {
+  deviceId = device;
+  collapseKey = key;
+}
+
+int Notification::getDeviceId() const { return deviceId; }
+int Notification::getCollapseKey() const { return collapseKey; }
+int Notification::getPayloadId() const { return payloadId; }
+int Notification::getCoalescedCount() const { return coalescedCount; }
+bool Notification::isCoalescable() const { return collapseKey != 0; }
+
+bool Notification::sameCollapseTarget(const Notification& other) const {
+  return collapseKey == other.collapseKey && deviceId == other.deviceId && sourceId == other.sourceId;
+}
+
+void Notification::coalesce(const Notification& newer) {
+  payloadId = newer.payloadId;
+  coalescedCount += 1 + newer.coalescedCount;
+}
+
+int Notification::getPriorityClass() const { return priorityClass; }
+void Notification::setPriorityClass(int value) { priorityClass = value; }
+
+int Notification::getRetryCount() const { return retryCount; }
+void Notification::markRetry() { retryCount++; }
+
+int Notification::getForwardCount() const { return forwardCount; }
+void Notification::markForwarded() {
+  forwardCount++;
+  sourceId = 0;
+}
+
+void Notification::saveState(BinaryWriter& writer) const {
+  writer.writePod(id);
+  writer.writePod(sourceId);
+  writer.writePod(creationTime);
+  writer.writePod(status);
+  writer.writePod(enterBufferTime);
+  writer.writePod(leaveBufferTime);
+  writer.writePod(enterChannelTime);
+  writer.writePod(deviceId);
+  writer.writePod(collapseKey);
+  writer.writePod(payloadId);
+  writer.writePod(coalescedCount);
+  writer.writePod(retryCount);
+  writer.writePod(forwardCount);
+  writer.writePod(priorityClass);
+}
+
+void Notification::loadState(BinaryReader& reader) {
+  reader.readPod(id);
+  reader.readPod(sourceId);
+  reader.readPod(creationTime);
+  reader.readPod(status);
+  reader.readPod(enterBufferTime);
+  reader.readPod(leaveBufferTime);
+  reader.readPod(enterChannelTime);
+  reader.readPod(deviceId);
+  reader.readPod(collapseKey);
+  reader.readPod(payloadId);
+  reader.readPod(coalescedCount);
+  reader.readPod(retryCount);
+  reader.readPod(forwardCount);
+  reader.readPod(priorityClass);
 }
\ No newline at end of file
@@ -3,40 +3,78 @@
 #define NOTIFICATION_H
 
 #include "CommonTypes.h"
-#include <chrono>
 #include <string>
 
+class BinaryWriter;
+class BinaryReader;
+
 class Notification {
 private:
   int id;
   int sourceId;
-  std::chrono::system_clock::time_point creationTime;
+  double creationTime; // Модельное время генерации
   NotificationStatus status;
-  std::chrono::system_clock::time_point enterBufferTime;
-  std::chrono::system_clock::time_point leaveBufferTime; //     (  )
-  std::chrono::system_clock::time_point enterChannelTime; //     ( )
+  double enterBufferTime; // Модельное время входа в буфер (< 0 - не был в буфере)
+  double leaveBufferTime; // Время выхода из буфера (уход в канал)
+  double enterChannelTime; // Время входа в канал (начало обслуживания)
+  // --- Адресат и объединение (coalescing) ---
+  int deviceId; // Устройство-получатель, 0 - не задано
+  int collapseKey; // Ключ схлопывания, 0 - уведомление не объединяется
+  int payloadId; // Номер уведомления, чье содержимое сейчас несет заявка (после объединения - последнего)
+  int coalescedCount; // Сколько более новых уведомлений влито в эту заявку
+  int retryCount; // Сколько раз клиент переотправлял после вытеснения
+  int forwardCount; // Сколько раз передавалось в другой шард
+  int priorityClass; // Класс уведомления: 0 - высший (транзакционные), больше - ниже
 
 public:
-  Notification(); //   
-  Notification(int id, int sourceId);
+  Notification(); // Для инициализации буфера
+  Notification(int id, int sourceId, double creationTime = 0.0);
 
   int getId() const;
   int getSourceId() const;
+  double getCreationTime() const;
   NotificationStatus getStatus() const;
   void setStatus(NotificationStatus newStatus);
 
-  void setEnterBufferTime();
-  void setLeaveBufferTime(); // 
-  void setEnterChannelTime();
+  // Отметки времени - модельное время из календаря событий
+  void setEnterBufferTime(double time);
+  void setLeaveBufferTime(double time);
+  void setEnterChannelTime(double time);
 
-  //    (T_)
+  // Время в буфере (T_ожидания)
   double getWaitTime() const;
-  //    (T_) - ,   
-  // double getServiceTime() const; //  ,   Channel
-  //    (T_)
+  // Время в канале (T_обслуживания) - рассчитывается, предоставляется или передается
+  // double getServiceTime() const; // Не хранится, передается из Channel
+  // Время в системе (T_пребывания)
   double getSystemTime() const;
 
   std::string getStatusString() const;
+
+  // Адресат: (источник, устройство, ключ) - ключ индекса объединения в буфере
+  void setAudience(int device, int key);
+  int getDeviceId() const;
+  int getCollapseKey() const;
+  int getPayloadId() const;
+  int getCoalescedCount() const;
+  bool isCoalescable() const; // Задан ключ схлопывания
+  bool sameCollapseTarget(const Notification& other) const;
+  // Заменить содержимое более новым уведомлением с тем же ключом. Место в буфере
+  // и отметки времени остаются прежними - T_ож считается от занятия ячейки
+  void coalesce(const Notification& newer);
+
+  int getPriorityClass() const;
+  void setPriorityClass(int value);
+
+  int getRetryCount() const;
+  void markRetry(); // Еще одна переотправка
+
+  int getForwardCount() const;
+  // Принято из другого шарда: в статистике шарда-получателя учитывается под источником 0
+  void markForwarded();
+
+  // Контрольная точка: поля по одному, без байтов выравнивания
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
 };
 
 #endif // NOTIFICATION_H
\ No newline at end of file
@@ -0,0 +1,157 @@
+// NotifyMeApi.cpp
+#include "NotifyMeApi.h"
+#include "PushNotificationSystem.h"
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+struct nm_simulation {
+  SimulationConfig config;
+  std::unique_ptr<PushNotificationSystem> system;
+};
+
+namespace {
+
+  thread_local std::string lastError;
+
+  nm_simulation* create(SimulationConfig config) {
+    auto simulation = std::make_unique<nm_simulation>();
+    simulation->config = std::move(config);
+    simulation->system = std::make_unique<PushNotificationSystem>(simulation->config);
+    simulation->system->setVerbose(false);
+    lastError.clear();
+    return simulation.release();
+  }
+
+  // Граница C: исключение - в текст ошибки и значение-признак
+  template <typename Result, typename Body>
+  Result guarded(Result failure, Body body) {
+    try {
+      return body();
+    }
+    catch (const std::exception& error) {
+      lastError = error.what();
+    }
+    catch (...) {
+      lastError = "неизвестная ошибка";
+    }
+    return failure;
+  }
+
+  bool missing(const void* pointer, const char* what) {
+    if (pointer) {
+      return false;
+    }
+    lastError = std::string("пустой указатель: ") + what;
+    return true;
+  }
+
+}
+
+extern "C" {
+
+int nm_api_version(void) { return NM_API_VERSION; }
+const char* nm_last_error(void) { return lastError.c_str(); }
+
+nm_simulation* nm_create_from_file(const char* path) {
+  return guarded<nm_simulation*>(nullptr, [&]() { return create(SimulationConfig::fromFile(path)); });
+}
+
+nm_simulation* nm_create_from_text(const char* text) {
+  return guarded<nm_simulation*>(nullptr, [&]() {
+    std::istringstream in(text ? text : "");
+    return create(SimulationConfig::fromStream(in, "<nm_create_from_text>"));
+  });
+}
+
+void nm_destroy(nm_simulation* simulation) { delete simulation; }
+
+long long nm_run_events(nm_simulation* simulation, long long events) {
+  if (missing(simulation, "simulation")) {
+    return -1;
+  }
+  return guarded<long long>(-1, [&]() { return simulation->system->runEvents(events); });
+}
+
+long long nm_run(nm_simulation* simulation) {
+  return nm_run_events(simulation, std::numeric_limits<long long>::max());
+}
+
+int nm_source_count(const nm_simulation* simulation) {
+  if (missing(simulation, "simulation")) {
+    return -1;
+  }
+  return static_cast<int>(simulation->config.sources.size());
+}
+
+int nm_channel_count(const nm_simulation* simulation) {
+  if (missing(simulation, "simulation")) {
+    return -1;
+  }
+  return simulation->system->getChannelCount();
+}
+
+int nm_fetch_summary(const nm_simulation* simulation, nm_summary* out) {
+  if (missing(simulation, "simulation") || missing(out, "out")) {
+    return -1;
+  }
+  const PushNotificationSystem& system = *simulation->system;
+  const Database& database = system.getDatabase();
+  out->model_time = system.getCurrentTime();
+  out->events = system.getProcessedEvents();
+  out->generated = database.getGeneratedCount();
+  out->delivered = database.getDeliveredCount();
+  out->rejected = database.getRejectedCount();
+  out->rejection_rate = database.getRejectionRate();
+  out->wait_time = database.getAvgWaitTime();
+  out->service_time = database.getAvgServiceTime();
+  out->statistics_start = database.getStatisticsStart();
+  out->finished = system.isFinished() ? 1 : 0;
+  out->precision_reached = system.isPrecisionReached() ? 1 : 0;
+  return 1;
+}
+
+int nm_fetch_sources(const nm_simulation* simulation, nm_source_stats* out, int capacity) {
+  if (missing(simulation, "simulation") || (capacity > 0 && missing(out, "out"))) {
+    return -1;
+  }
+  const Database& database = simulation->system->getDatabase();
+  int count = std::max(0, std::min(capacity, nm_source_count(simulation)));
+  for (int i = 0; i < count; i++) {
+    int id = i + 1;
+    nm_source_stats& stats = out[i];
+    stats.generated = database.getSourceGeneratedCount(id);
+    stats.delivered = database.getSourceDeliveredCount(id);
+    stats.rejected = database.getSourceRejectedCount(id);
+    stats.rejection_rate = database.getSourceRejectionRate(id);
+    stats.system_time = database.getSourceAvgSystemTime(id);
+    stats.wait_time = database.getSourceAvgWaitTime(id);
+    stats.service_time = database.getSourceAvgServiceTime(id);
+    stats.wait_variance = database.getSourceVarianceWaitTime(id);
+    stats.service_variance = database.getSourceVarianceServiceTime(id);
+  }
+  return count;
+}
+
+int nm_fetch_channels(const nm_simulation* simulation, double* utilization, double* busy_time, int capacity) {
+  if (missing(simulation, "simulation")) {
+    return -1;
+  }
+  const PushNotificationSystem& system = *simulation->system;
+  const Database& database = system.getDatabase();
+  int count = std::max(0, std::min(capacity, nm_channel_count(simulation)));
+  for (int i = 0; i < count; i++) {
+    if (utilization) {
+      utilization[i] = database.getChannelUtilization(i + 1, system.getCurrentTime());
+    }
+    if (busy_time) {
+      busy_time[i] = database.getChannelBusyTime(i + 1);
+    }
+  }
+  return count;
+}
+
+}
\ No newline at end of file
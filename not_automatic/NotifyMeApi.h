@@ -0,0 +1,80 @@
+// NotifyMeApi.h
+#ifndef NOTIFYME_API_H
+#define NOTIFYME_API_H
+
+// Стабильный C-интерфейс модели для внешних программ (automatic/cmo_native.py через ctypes).
+// Библиотека собирается из всех исходников, кроме main.cpp:
+//   g++ -std=c++20 -O2 -fPIC -shared -pthread $(ls not_automatic/*.cpp | grep -v main.cpp) -o libnotifyme.so
+// Исключения через границу не проходят: ошибка - NULL или -1, текст - nm_last_error (свой у каждого потока).
+// Пустой дескриптор или массив результата - тоже ошибка (-1), а не авария.
+// Результаты пишутся прямо в массивы вызывающего - без промежуточных копий.
+// Раскладка структур только расширяется в конец; несовместимое изменение увеличивает NM_API_VERSION
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NM_API_VERSION 1
+
+#if defined(_WIN32)
+#define NM_EXPORT __declspec(dllexport)
+#else
+#define NM_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct nm_simulation nm_simulation;
+
+// Таблица 1 по одному источнику
+typedef struct nm_source_stats {
+  long long generated; // n_gen
+  long long delivered;
+  long long rejected; // m_rej
+  double rejection_rate; // p_отк
+  double system_time; // T_преб
+  double wait_time; // T_ож
+  double service_time; // T_обсл
+  double wait_variance; // D_ож
+  double service_variance; // D_обсл
+} nm_source_stats;
+
+typedef struct nm_summary {
+  double model_time;
+  long long events;
+  long long generated;
+  long long delivered;
+  long long rejected;
+  double rejection_rate;
+  double wait_time;
+  double service_time;
+  double statistics_start; // Момент сброса статистики после разгона, 0 - с начала
+  int finished; // Прогон дальше не пойдет (потолок заявок, пустой календарь или точность)
+  int precision_reached;
+} nm_summary;
+
+NM_EXPORT int nm_api_version(void);
+NM_EXPORT const char* nm_last_error(void);
+
+// Сценарий - INI-файл или его текст (формат SimulationConfig::fromFile)
+NM_EXPORT nm_simulation* nm_create_from_file(const char* path);
+NM_EXPORT nm_simulation* nm_create_from_text(const char* text);
+NM_EXPORT void nm_destroy(nm_simulation* simulation);
+
+// Не больше events событий; возвращает обработанные. nm_run - до конца сценария
+// (потолок notifications или точность [system] precision)
+NM_EXPORT long long nm_run_events(nm_simulation* simulation, long long events);
+NM_EXPORT long long nm_run(nm_simulation* simulation);
+
+NM_EXPORT int nm_source_count(const nm_simulation* simulation);
+// Номера каналов 1..N, заведенные к этому моменту: с автомасштабированием N растет по ходу прогона,
+// снятые каналы остаются в счете (их загрузка - в своей строке Таблицы 2)
+NM_EXPORT int nm_channel_count(const nm_simulation* simulation);
+// Заполняют не больше capacity элементов (источники и каналы с номера 1); возвращают число заполненных
+NM_EXPORT int nm_fetch_summary(const nm_simulation* simulation, nm_summary* out);
+NM_EXPORT int nm_fetch_sources(const nm_simulation* simulation, nm_source_stats* out, int capacity);
+NM_EXPORT int nm_fetch_channels(const nm_simulation* simulation, double* utilization, double* busy_time, int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NOTIFYME_API_H
\ No newline at end of file
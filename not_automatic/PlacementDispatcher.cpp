@@ -1,49 +1,289 @@
 // PlacementDispatcher.cpp
 #include "PlacementDispatcher.h"
-#include <limits> //  numeric_limits
+#include "Checkpoint.h"
+#include "PushNotificationSystem.h" // Для runDispatchComparison
+#include <algorithm> // Для std::sort
+#include <bit> // Для std::countr_zero
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric> // Для std::iota
 
-PlacementDispatcher::PlacementDispatcher(Buffer* buf, std::vector<Channel*>* chans, Database* db)
-  : buffer(buf), channels(chans), database(db) {
+PlacementDispatcher::PlacementDispatcher(Buffer* buf, const std::vector<Channel*>& chans, Database* db)
+  : buffer(buf), channels(chans), database(db),
+  policy(DispatchPolicy::PRIORITY), choices(2), rng(0), idleHead(-1), idleTail(-1),
+  active(chans.size(), 1), activeCount(static_cast<int>(chans.size())) {
+  rebuildFreeSets();
 }
 
-void PlacementDispatcher::handleNewNotification(const Notification& notification) {
-  //  database  addNotification    (14)
-  bool success = buffer->addNotification(notification, database);
+void PlacementDispatcher::setChannels(const std::vector<Channel*>& chans) {
+  channels = chans;
+}
+
+void PlacementDispatcher::setPolicy(DispatchPolicy dispatchPolicy, int sampleChoices, unsigned seed) {
+  policy = dispatchPolicy;
+  choices = sampleChoices > 0 ? sampleChoices : 1;
+  rng.seed(seed);
+  rebuildFreeSets();
+}
+
+void PlacementDispatcher::reseed(unsigned seed) {
+  rng.seed(seed);
+}
+
+void PlacementDispatcher::setAntithetic(bool enabled) {
+  rng.setAntithetic(enabled);
+}
+
+DispatchPolicy PlacementDispatcher::getPolicy() const { return policy; }
+
+void PlacementDispatcher::rebuildRanks() {
+  int count = static_cast<int>(channels.size());
+  // Ранг: при равенстве ключа - по приоритету, затем по номеру (как в прежнем просмотре Д2П1).
+  // Номер - последний ключ, поэтому std::sort (stable_sort берет временный буфер из кучи,
+  // а ранги пересчитываются и в установившемся режиме - при добавлении канала автомасштабированием)
+  byRank.resize(count);
+  std::iota(byRank.begin(), byRank.end(), 0);
+  if (policy == DispatchPolicy::FASTEST) {
+    std::sort(byRank.begin(), byRank.end(), [this](int a, int b) {
+      double ta = channels[a]->getExpectedServiceTime();
+      double tb = channels[b]->getExpectedServiceTime();
+      if (ta != tb) {
+        return ta < tb;
+      }
+      return channels[a]->getPriority() != channels[b]->getPriority() ? channels[a]->getPriority() < channels[b]->getPriority() : a < b;
+    });
+  }
+  else {
+    std::sort(byRank.begin(), byRank.end(), [this](int a, int b) {
+      return channels[a]->getPriority() != channels[b]->getPriority() ? channels[a]->getPriority() < channels[b]->getPriority() : a < b;
+    });
+  }
+  rankOf.assign(count, 0);
+  for (int rank = 0; rank < count; rank++) {
+    rankOf[byRank[rank]] = rank;
+  }
+
+  std::size_t words = (static_cast<std::size_t>(count) + 63) / 64;
+  freeBits.assign(words, 0);
+  freeSummary.assign((words + 63) / 64, 0);
+  // Свободные - ровно те, что стоят в списке простаивающих
+  for (int index = idleHead; index >= 0; index = idleNext[index]) {
+    int rank = rankOf[index];
+    freeBits[rank / 64] |= std::uint64_t(1) << (rank % 64);
+    freeSummary[rank / 4096] |= std::uint64_t(1) << ((rank / 64) % 64);
+  }
+}
+
+void PlacementDispatcher::rebuildFreeSets() {
+  int count = static_cast<int>(channels.size());
+  idleNext.assign(count, -1);
+  idlePrev.assign(count, -1);
+  idleHead = -1;
+  idleTail = -1;
+  rebuildRanks();
+  for (int index = 0; index < count; index++) {
+    if (active[index] && !channels[index]->isChannelBusy()) {
+      markFree(index);
+    }
+  }
+}
+
+void PlacementDispatcher::markFree(int index) {
+  int rank = rankOf[index];
+  freeBits[rank / 64] |= std::uint64_t(1) << (rank % 64);
+  freeSummary[rank / 4096] |= std::uint64_t(1) << ((rank / 64) % 64);
+
+  // В хвост списка простаивающих
+  idleNext[index] = -1;
+  idlePrev[index] = idleTail;
+  if (idleTail >= 0) {
+    idleNext[idleTail] = index;
+  }
+  else {
+    idleHead = index;
+  }
+  idleTail = index;
+}
+
+void PlacementDispatcher::markBusy(Channel* channel) {
+  removeFree(channel->getId() - 1);
+}
+
+void PlacementDispatcher::removeFree(int index) {
+  int rank = rankOf[index];
+  std::uint64_t bit = std::uint64_t(1) << (rank % 64);
+  if (!(freeBits[rank / 64] & bit)) {
+    return; // Уже занят
+  }
+  freeBits[rank / 64] &= ~bit;
+  // Из списка простаивающих
+  if (freeBits[rank / 64] == 0) {
+    freeSummary[rank / 4096] &= ~(std::uint64_t(1) << ((rank / 64) % 64));
+  }
+
+  if (idlePrev[index] >= 0) {
+    idleNext[idlePrev[index]] = idleNext[index];
+  }
+  else {
+    idleHead = idleNext[index];
+  }
+  if (idleNext[index] >= 0) {
+    idlePrev[idleNext[index]] = idlePrev[index];
+  }
+  else {
+    idleTail = idlePrev[index];
+  }
+}
+
+int PlacementDispatcher::firstFreeByRank() const {
+  for (std::size_t s = 0; s < freeSummary.size(); s++) {
+    if (freeSummary[s]) {
+      std::size_t word = s * 64 + static_cast<std::size_t>(std::countr_zero(freeSummary[s]));
+      return byRank[word * 64 + static_cast<std::size_t>(std::countr_zero(freeBits[word]))];
+    }
+  }
+  return -1;
+}
+
+void PlacementDispatcher::handleNewNotification(const Notification& notification, double currentTime) {
+  // Передаем database в addNotification для фиксации вытеснения (Д1ОО4)
+  bool success = buffer->addNotification(notification, currentTime, database);
   if (!success) {
-    //           14  
-    //    addNotification   (  )
-    //       ,      
+    // Это может произойти только если буфер был полон и дисциплина Д1ОО4 не сработала
+    // В нашей реализации addNotification всегда добавляет (заменяет или помещает)
+    // Но если бы были другие дисциплины отказа, это место было бы для них
+  }
+}
+
+Channel* PlacementDispatcher::selectChannel() {
+  int index = -1;
+  switch (policy) {
+  case DispatchPolicy::SHORTEST_QUEUE:
+    index = idleHead;
+    break;
+  case DispatchPolicy::POWER_OF_D: {
+    // d проб по всем каналам; если ни одна не попала в свободный - дольше всех простаивающий
+    std::uint64_t count = byRank.size();
+    double bestBusy = 0.0;
+    for (int k = 0; k < choices && count > 0; k++) {
+      int probe = static_cast<int>(rng() % count);
+      int rank = rankOf[probe];
+      if (freeBits[rank / 64] & (std::uint64_t(1) << (rank % 64))) {
+        double busy = database->getChannelBusyTime(channels[probe]->getId());
+        if (index < 0 || busy < bestBusy) {
+          index = probe;
+          bestBusy = busy;
+        }
+      }
+    }
+    if (index < 0) {
+      index = idleHead;
+    }
+    break;
+  }
+  default:
+    index = firstFreeByRank();
+    break;
   }
+  return index >= 0 ? channels[index] : nullptr;
 }
 
-Channel* PlacementDispatcher::selectChannelByPriority() {
-  Channel* selectedChannel = nullptr;
-  int lowestPriority = std::numeric_limits<int>::max(); //   -  
+bool PlacementDispatcher::releaseChannel(Channel* channel) {
+  channel->freeChannel();
+  int index = channel->getId() - 1;
+  if (!active[index]) {
+    return false;
+  }
+  markFree(index);
+  return true;
+}
 
-  for (Channel* channel : *channels) {
-    if (!channel->isChannelBusy() && channel->getPriority() < lowestPriority) {
-      selectedChannel = channel;
-      lowestPriority = channel->getPriority();
+void PlacementDispatcher::addChannel(Channel* channel) {
+  int index = channel->getId() - 1;
+  if (index >= static_cast<int>(channels.size())) {
+    channels.resize(index + 1, nullptr);
+    active.resize(index + 1, 0);
+    idleNext.resize(index + 1, -1);
+    idlePrev.resize(index + 1, -1);
+  }
+  channels[index] = channel;
+  active[index] = 1;
+  activeCount++;
+  // Ранги всех каналов пересчитываются (O(n log n) на решение масштабирования - редкое событие),
+  // порядок простаивающих сохраняется, новый встает в хвост
+  rebuildRanks();
+  markFree(index);
+}
+
+bool PlacementDispatcher::retireChannel(Channel* channel) {
+  int index = channel->getId() - 1;
+  if (!active[index]) {
+    return false;
+  }
+  active[index] = 0;
+  activeCount--;
+  removeFree(index);
+  return !channel->isChannelBusy();
+}
+
+Channel* PlacementDispatcher::pickRetiree() {
+  if (idleHead >= 0) {
+    return channels[idleHead];
+  }
+  for (int index = static_cast<int>(channels.size()) - 1; index >= 0; index--) {
+    if (active[index]) {
+      return channels[index];
     }
   }
+  return nullptr;
+}
 
-  return selectedChannel;
+int PlacementDispatcher::getActiveCount() const { return activeCount; }
+
+bool PlacementDispatcher::isActive(int channelId) const {
+  return channelId >= 1 && channelId <= static_cast<int>(active.size()) && active[channelId - 1];
 }
 
-void PlacementDispatcher::tryProcessFromBuffer() {
-  Channel* targetChannel = selectChannelByPriority();
+double PlacementDispatcher::startService(Channel* channel, const Notification& notification, double currentTime) {
+  double serviceTime = channel->startProcessing(notification, currentTime);
+  markBusy(channel);
+  if (channel->getBatchLimit() > 1) {
+    database->recordBatchDelivery(channel->getBatch(), serviceTime, channel->getId(), 0);
+  }
+  else {
+    database->recordDelivery(channel->getCurrentNotification(), serviceTime, channel->getId());
+  }
+  return serviceTime;
+}
+
+Channel* PlacementDispatcher::tryProcessFromBuffer(double currentTime, double& serviceTime) {
+  Channel* targetChannel = selectChannel();
+
+  if (targetChannel && !buffer->isEmpty() && targetChannel->getBatchLimit() > 1) {
+    // Пакетный канал: одна выборка до k уведомлений, одно время пачки, одно событие FREE_CHAN
+    batchItems.clear();
+    int taken = buffer->takeNotifications(targetChannel->getBatchLimit(), currentTime, batchItems);
+    serviceTime = targetChannel->startBatch(batchItems, currentTime);
+    markBusy(targetChannel);
+    database->recordBatchDelivery(targetChannel->getBatch(), serviceTime, targetChannel->getId(), taken);
+    return targetChannel;
+  }
 
   if (targetChannel && !buffer->isEmpty()) {
-    Notification notification = buffer->getNextNotification();
+    Notification notification = buffer->getNextNotification(currentTime);
 
-    if (notification.getId() > 0) { // ,   
-      double serviceTime = targetChannel->startProcessing(notification);
+    if (notification.getId() > 0) { // Проверяем, что уведомление валидное
+      serviceTime = targetChannel->startProcessing(notification, currentTime);
+      markBusy(targetChannel);
 
-      //   (       )
-      //      
-      database->recordDelivery(notification, serviceTime, targetChannel->getId());
+      // Записать статистику (в упрощенной модели доставляем при выборе из буфера)
+      // В асинхронной модели это было бы позже
+      database->recordDelivery(targetChannel->getCurrentNotification(), serviceTime, targetChannel->getId());
+      return targetChannel;
     }
   }
+  return nullptr;
 }
 
 int PlacementDispatcher::getBufferPointer() const {
@@ -56,4 +296,57 @@ const std::vector<Notification>& PlacementDispatcher::getBufferNotifications() c
 
 const std::vector<bool>& PlacementDispatcher::getBufferOccupied() const {
   return buffer->getOccupied();
+}
+
+void PlacementDispatcher::saveState(BinaryWriter& writer) const {
+  writer.writePod(policy);
+  writer.writePod(choices);
+  writer.writePod(rng);
+  writer.writePodVector(rankOf);
+  writer.writePodVector(byRank);
+  writer.writePodVector(freeBits);
+  writer.writePodVector(freeSummary);
+  writer.writePodVector(idleNext);
+  writer.writePodVector(idlePrev);
+  writer.writePod(idleHead);
+  writer.writePod(idleTail);
+  writer.writePodVector(active);
+  writer.writePod(activeCount);
+}
+
+void PlacementDispatcher::loadState(BinaryReader& reader) {
+  reader.readPod(policy);
+  reader.readPod(choices);
+  reader.readPod(rng);
+  reader.readPodVector(rankOf);
+  reader.readPodVector(byRank);
+  reader.readPodVector(freeBits);
+  reader.readPodVector(freeSummary);
+  reader.readPodVector(idleNext);
+  reader.readPodVector(idlePrev);
+  reader.readPod(idleHead);
+  reader.readPod(idleTail);
+  reader.readPodVector(active);
+  reader.readPod(activeCount);
+}
+
+void runDispatchComparison(SimulationConfig config) {
+  std::cout << "Политика | Загрузка мин | макс   | CV     | Джейн  | p_отк  | T_ож p99 | T_отклика p99 | Время, с\n";
+  std::cout << "---------|--------------|--------|--------|--------|--------|----------|---------------|---------\n";
+  for (const char* name : { "priority", "jsq", "pod", "fastest" }) {
+    config.setDispatchPolicy(name);
+    PushNotificationSystem system(config);
+    auto start = std::chrono::steady_clock::now();
+    system.runHeadless();
+    double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const Database& database = system.getDatabase();
+    UtilizationBalance balance = database.getUtilizationBalance(system.getCurrentTime());
+    std::cout << std::left << std::setw(8) << name << std::right << " | " << std::fixed << std::setprecision(4)
+      << std::setw(12) << balance.min << " | " << std::setw(6) << balance.max << " | "
+      << std::setw(6) << balance.cv << " | " << std::setw(6) << balance.jain << " | "
+      << std::setw(6) << database.getRejectionRate() << " | "
+      << std::setw(8) << database.getWaitHistogram().quantile(0.99) << " | "
+      << std::setw(13) << database.getResponseHistogram().quantile(0.99) << " | "
+      << std::setprecision(3) << runSeconds << "\n";
+  }
 }
\ No newline at end of file
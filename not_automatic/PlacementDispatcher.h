@@ -2,38 +2,109 @@
 #ifndef PLACEMENT_DISPATCHER_H
 #define PLACEMENT_DISPATCHER_H
 
-#include "Buffer.h" //   
-#include "Channel.h" //   
-#include "Database.h" //   
-#include "Notification.h" //   Notification
+#include "Buffer.h" // Для хранения указателя
+#include "Channel.h" // Для хранения указателя
+#include "Database.h" // Для хранения указателя
+#include "Notification.h" // Для обработки Notification
+#include "CommonTypes.h" // Для DispatchPolicy
+#include "RandomEngine.h"
+#include <cstdint>
 #include <vector>
 
-//   
+class BinaryWriter;
+class BinaryReader;
+struct SimulationConfig;
+
+// Класс Диспетчера постановки
 class PlacementDispatcher {
 private:
   Buffer* buffer;
-  std::vector<Channel*>* channels;
+  std::vector<Channel*> channels; // Индекс = номер канала - 1; каналы принадлежат системе
   Database* database;
+  std::vector<Notification> batchItems; // Пачка для пакетного канала (память переиспользуется)
+
+  // --- Свободные каналы ---
+  // Каналы захватываются и освобождаются только через диспетчер, поэтому набор свободных
+  // ведется при каждом переходе за O(1) и выбор не просматривает все каналы:
+  // битовая карта по рангу (приоритет или ожидаемое время обслуживания) со сводным словом -
+  // первый свободный по рангу через countr_zero; список простаивающих в порядке освобождения
+  DispatchPolicy policy;
+  int choices; // d для POWER_OF_D
+  RandomEngine rng; // Выборка каналов для POWER_OF_D
+  std::vector<int> rankOf; // Ранг по индексу канала (индекс = номер - 1)
+  std::vector<int> byRank; // Индекс канала по рангу
+  std::vector<std::uint64_t> freeBits; // Бит ранга - канал свободен
+  std::vector<std::uint64_t> freeSummary; // Бит слова freeBits - в нем есть свободные
+  std::vector<int> idleNext; // Список простаивающих: голова освободилась раньше всех
+  std::vector<int> idlePrev;
+  int idleHead;
+  int idleTail;
+  std::vector<char> active; // 0 - канал снят (или снимается после текущего обслуживания)
+  int activeCount;
+
+  void rebuildRanks(); // Ранги по политике и битовая карта свободных; список простаивающих не трогается
+  void rebuildFreeSets(); // Ранги и список простаивающих заново - по занятости каналов
+  void markBusy(Channel* channel);
+  void removeFree(int index); // Убрать из набора свободных, если он там
+  void markFree(int index);
+  int firstFreeByRank() const; // Индекс канала или -1
 
 public:
-  PlacementDispatcher(Buffer* buf, std::vector<Channel*>* chans, Database* db);
+  PlacementDispatcher(Buffer* buf, const std::vector<Channel*>& chans, Database* db);
+
+  // Обработать новое уведомление от источника
+  void handleNewNotification(const Notification& notification, double currentTime);
+
+  // Политика выбора канала; seed - зерно выборки для POWER_OF_D
+  void setPolicy(DispatchPolicy dispatchPolicy, int sampleChoices = 2, unsigned seed = 0);
+  void reseed(unsigned seed); // Только генератор выборки, свободные множества не трогаются
+  void setAntithetic(bool enabled);
+  DispatchPolicy getPolicy() const;
 
-  //     
-  void handleNewNotification(const Notification& notification);
+  // Свободный канал по политике (по умолчанию Д2П1 - по приоритету) или nullptr.
+  // O(1) для PRIORITY, SHORTEST_QUEUE, FASTEST (до 4096 каналов на слово сводки), O(d) для POWER_OF_D
+  Channel* selectChannel();
 
-  //     (21)
-  Channel* selectChannelByPriority();
+  // Освободить канал по окончании обслуживания (FREE_CHAN).
+  // false - канал снимался: в набор свободных он не возвращается
+  bool releaseChannel(Channel* channel);
 
-  //     
-  void tryProcessFromBuffer();
+  // --- Переменный набор каналов ---
+  // Номер канала - постоянная ссылка на ячейку: снятый канал остается на месте
+  // до повторного использования ячейки через addChannel
+  void addChannel(Channel* channel); // Новый или переиспользованный номер, канал свободен
+  // Снять канал: свободный - сразу (true), занятый - по окончании обслуживания (false)
+  bool retireChannel(Channel* channel);
+  Channel* pickRetiree(); // Кого снимать: дольше всех простаивающий, иначе занятый с наибольшим номером
+  int getActiveCount() const;
+  bool isActive(int channelId) const;
 
-  //     
+  // Поставить поступившее уведомление прямо в свободный канал и записать статистику.
+  // Возвращает время обслуживания
+  double startService(Channel* channel, const Notification& notification, double currentTime);
+
+  // Попытаться обработать уведомление из буфера
+  // Возвращает занятый канал (или nullptr) и его время обслуживания - для планирования FREE_CHAN.
+  // Пакетный канал забирает за один захват до getBatchLimit() уведомлений в порядке Д2Б3
+  Channel* tryProcessFromBuffer(double currentTime, double& serviceTime);
+
+  // Получить указатель буфера для отображения
   int getBufferPointer() const;
 
-  //     
+  // Получить состояние буфера для отображения
   const std::vector<Notification>& getBufferNotifications() const;
 
   const std::vector<bool>& getBufferOccupied() const;
+
+  // Контрольная точка: политика, генератор выборки, порядок простаивающих и снятые каналы.
+  // Указатели на каналы не сохраняются - перед loadState система передает их через setChannels
+  void setChannels(const std::vector<Channel*>& chans);
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
 };
 
+// Таблица политик выбора канала на одном сценарии (priority, jsq, pod, fastest): равномерность
+// загрузки, p_отк, p99 T_ож и T_отклика, время прогона. Политика из config не учитывается
+void runDispatchComparison(SimulationConfig config);
+
 #endif // PLACEMENT_DISPATCHER_H
\ No newline at end of file
@@ -0,0 +1,206 @@
+// ProcessEngine.cpp
+#include "ProcessEngine.h"
+#include <limits> // Для numeric_limits
+#include <new> // Для ::operator new
+
+namespace {
+
+  const std::size_t kBlockGranularity = 64; // Шаг размеров блоков
+  const std::size_t kSizeClasses = 16; // Блоки до 1 КБ берутся из пула
+  const std::size_t kBlocksPerSlab = 32; // Сколько блоков выделять за одно обращение к куче
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Состояние пула - своё у каждого потока (прогоны в разных потоках не делят кадры)
+  struct FramePoolState {
+    FreeBlock* freeLists[kSizeClasses] = {};
+    std::vector<void*> slabs;
+    long long heapAllocations = 0;
+    long long frameAllocations = 0;
+
+    ~FramePoolState() {
+      for (void* slab : slabs) {
+        ::operator delete(slab);
+      }
+    }
+  };
+
+  thread_local FramePoolState poolState;
+
+  std::size_t sizeClassOf(std::size_t size) {
+    return (size + kBlockGranularity - 1) / kBlockGranularity - 1;
+  }
+
+}
+
+void* FramePool::allocate(std::size_t size) {
+  poolState.frameAllocations++;
+  std::size_t sizeClass = sizeClassOf(size);
+  if (sizeClass >= kSizeClasses) {
+    // Слишком большой кадр - напрямую из кучи
+    poolState.heapAllocations++;
+    return ::operator new(size);
+  }
+
+  FreeBlock*& head = poolState.freeLists[sizeClass];
+  if (!head) {
+    // Список пуст - нарезаем новый слэб на блоки этого размера
+    std::size_t blockSize = (sizeClass + 1) * kBlockGranularity;
+    char* slab = static_cast<char*>(::operator new(blockSize * kBlocksPerSlab));
+    poolState.slabs.push_back(slab);
+    poolState.heapAllocations++;
+    for (std::size_t i = 0; i < kBlocksPerSlab; i++) {
+      FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + i * blockSize);
+      block->next = head;
+      head = block;
+    }
+  }
+
+  FreeBlock* block = head;
+  head = block->next;
+  return block;
+}
+
+void FramePool::deallocate(void* ptr, std::size_t size) noexcept {
+  std::size_t sizeClass = sizeClassOf(size);
+  if (sizeClass >= kSizeClasses) {
+    ::operator delete(ptr);
+    return;
+  }
+  FreeBlock* block = static_cast<FreeBlock*>(ptr);
+  block->next = poolState.freeLists[sizeClass];
+  poolState.freeLists[sizeClass] = block;
+}
+
+long long FramePool::getHeapAllocations() { return poolState.heapAllocations; }
+long long FramePool::getFrameAllocations() { return poolState.frameAllocations; }
+
+// --- SimProcess ---
+SimProcess SimProcess::promise_type::get_return_object() {
+  return SimProcess(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+SimProcess::SimProcess(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+SimProcess::SimProcess(SimProcess&& other) noexcept : handle(other.handle) {
+  other.handle = nullptr;
+}
+
+SimProcess::~SimProcess() {
+  if (handle) {
+    handle.destroy();
+  }
+}
+
+std::coroutine_handle<SimProcess::promise_type> SimProcess::release() {
+  std::coroutine_handle<promise_type> released = handle;
+  handle = nullptr;
+  return released;
+}
+
+// --- ProcessEngine ---
+ProcessEngine::ProcessEngine(std::size_t expectedProcesses)
+  : calendar(), processes(), currentTime(0.0), nextSeq(0), activations(0), stopRequested(false) {
+  // Каждый процесс стоит в календаре не более одного раза - резервируем сразу,
+  // чтобы приостановки не вызывали роста вектора
+  std::vector<Activation> storage;
+  storage.reserve(expectedProcesses * 2);
+  calendar = std::priority_queue<Activation, std::vector<Activation>, ActivationComparator>(ActivationComparator(), std::move(storage));
+  processes.reserve(expectedProcesses);
+}
+
+ProcessEngine::~ProcessEngine() {
+  for (auto handle : processes) {
+    handle.destroy();
+  }
+}
+
+double ProcessEngine::now() const { return currentTime; }
+long long ProcessEngine::getActivations() const { return activations; }
+
+ProcessEngine::DelayAwaiter ProcessEngine::delay(double time) {
+  return DelayAwaiter{ *this, time };
+}
+
+void ProcessEngine::spawn(SimProcess process) {
+  std::coroutine_handle<> handle = process.release();
+  processes.push_back(handle);
+  schedule(handle, currentTime);
+}
+
+void ProcessEngine::schedule(std::coroutine_handle<> handle, double time) {
+  calendar.push(Activation{ time, nextSeq++, handle });
+}
+
+void ProcessEngine::stop() {
+  stopRequested = true;
+}
+
+void ProcessEngine::run() {
+  while (!calendar.empty()) {
+    Activation next = calendar.top();
+    // Остановка - только на границе моментов времени, чтобы каналы,
+    // получившие заявку в этот же момент, успели начать обслуживание
+    if (stopRequested && next.time > currentTime) {
+      break;
+    }
+    calendar.pop();
+    currentTime = next.time;
+    activations++;
+    next.handle.resume();
+  }
+}
+
+// --- BufferResource ---
+BufferResource::BufferResource(ProcessEngine& engine, Buffer& buffer, Database& database, std::size_t maxWaiters)
+  : engine(engine), buffer(buffer), database(database), waiters() {
+  waiters.reserve(maxWaiters);
+}
+
+BufferResource::PutAwaiter BufferResource::put(const Notification& notification) {
+  return PutAwaiter{ *this, notification };
+}
+
+BufferResource::AcquireAwaiter BufferResource::acquire(Channel& channel) {
+  return AcquireAwaiter{ *this, channel, Notification() };
+}
+
+void BufferResource::place(const Notification& notification) {
+  if (waiters.empty()) {
+    // Свободных каналов нет - в буфер (Д1ОЗ1, при переполнении Д1ОО4)
+    buffer.addNotification(notification, engine.now(), &database);
+    return;
+  }
+
+  // Выбор канала по приоритету (Д2П1) - наименьшее число среди ожидающих
+  std::size_t selected = 0;
+  int lowestPriority = std::numeric_limits<int>::max();
+  for (std::size_t i = 0; i < waiters.size(); i++) {
+    if (waiters[i].channel->getPriority() < lowestPriority) {
+      selected = i;
+      lowestPriority = waiters[i].channel->getPriority();
+    }
+  }
+
+  Waiter waiter = waiters[selected];
+  waiters[selected] = waiters.back();
+  waiters.pop_back();
+
+  *waiter.slot = notification;
+  engine.schedule(waiter.handle, engine.now());
+}
+
+bool BufferResource::AcquireAwaiter::await_ready() {
+  if (resource.buffer.isEmpty()) {
+    return false;
+  }
+  // Выбор из буфера по кольцу (Д2Б3)
+  result = resource.buffer.getNextNotification(resource.engine.now());
+  return true;
+}
+
+void BufferResource::AcquireAwaiter::await_suspend(std::coroutine_handle<> handle) {
+  resource.waiters.push_back(Waiter{ &channel, handle, &result });
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+// ProcessEngine.h
+#ifndef PROCESS_ENGINE_H
+#define PROCESS_ENGINE_H
+
+#include "Buffer.h" // Для BufferResource
+#include "Channel.h" // Для BufferResource
+#include "Database.h" // Для статистики вытеснения (Д1ОО4)
+#include "Notification.h"
+#include <coroutine>
+#include <cstddef>
+#include <queue>
+#include <vector>
+
+// Пул кадров сопрограмм: блоки кратные 64 байтам, освобожденные кадры идут
+// в список свободных своего размера и повторно выдаются без обращения к куче
+class FramePool {
+public:
+  static void* allocate(std::size_t size);
+  static void deallocate(void* ptr, std::size_t size) noexcept;
+
+  static long long getHeapAllocations(); // Сколько раз пул обращался к ::operator new
+  static long long getFrameAllocations(); // Сколько кадров выдано всего
+};
+
+// Процесс модели (сопрограмма). Запускается и возобновляется только движком
+class SimProcess {
+public:
+  struct promise_type {
+    SimProcess get_return_object();
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { throw; }
+
+    static void* operator new(std::size_t size) { return FramePool::allocate(size); }
+    static void operator delete(void* ptr, std::size_t size) noexcept { FramePool::deallocate(ptr, size); }
+  };
+
+  explicit SimProcess(std::coroutine_handle<promise_type> handle);
+  SimProcess(SimProcess&& other) noexcept;
+  SimProcess(const SimProcess&) = delete;
+  SimProcess& operator=(const SimProcess&) = delete;
+  ~SimProcess();
+
+  std::coroutine_handle<promise_type> release();
+
+private:
+  std::coroutine_handle<promise_type> handle;
+};
+
+// Движок процессной модели: календарь активаций сопрограмм (min-heap по времени)
+class ProcessEngine {
+private:
+  struct Activation {
+    double time;
+    long long seq; // Порядок постановки - FIFO при равном времени
+    std::coroutine_handle<> handle;
+  };
+
+  struct ActivationComparator {
+    bool operator()(const Activation& a, const Activation& b) const {
+      return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+    }
+  };
+
+  std::priority_queue<Activation, std::vector<Activation>, ActivationComparator> calendar;
+  std::vector<std::coroutine_handle<>> processes; // Владеем кадрами всех процессов
+  double currentTime;
+  long long nextSeq;
+  long long activations;
+  bool stopRequested;
+
+public:
+  // Ожидание модельного времени: co_await engine.delay(t)
+  struct DelayAwaiter {
+    ProcessEngine& engine;
+    double delay;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) { engine.schedule(handle, engine.currentTime + delay); }
+    void await_resume() const noexcept {}
+  };
+
+  // expectedProcesses - для резервирования календаря (одна активация на процесс)
+  explicit ProcessEngine(std::size_t expectedProcesses = 16);
+  ~ProcessEngine();
+  ProcessEngine(const ProcessEngine&) = delete;
+  ProcessEngine& operator=(const ProcessEngine&) = delete;
+
+  double now() const;
+  long long getActivations() const;
+
+  DelayAwaiter delay(double time);
+
+  // Процесс стартует в текущий момент модельного времени
+  void spawn(SimProcess process);
+  void schedule(std::coroutine_handle<> handle, double time);
+
+  // Останов после обработки всех активаций текущего момента времени
+  void stop();
+
+  // Возобновлять процессы, пока календарь не пуст и не вызван stop()
+  void run();
+};
+
+// Буфер как ресурс процессной модели: источники кладут заявки (put),
+// свободные каналы ждут их (acquire). Дисциплины те же, что у PlacementDispatcher
+class BufferResource {
+private:
+  struct Waiter {
+    Channel* channel;
+    std::coroutine_handle<> handle;
+    Notification* slot; // Куда передать заявку напрямую, минуя буфер
+  };
+
+  ProcessEngine& engine;
+  Buffer& buffer;
+  Database& database;
+  std::vector<Waiter> waiters; // Свободные каналы, ожидающие заявку
+
+public:
+  // Постановка заявки: не приостанавливает источник (Д1ОО4 вытесняет, а не блокирует)
+  struct PutAwaiter {
+    BufferResource& resource;
+    const Notification& notification;
+
+    bool await_ready() const noexcept { return true; }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    void await_resume() { resource.place(notification); }
+  };
+
+  // Получение заявки каналом: приостанавливает, пока буфер пуст
+  struct AcquireAwaiter {
+    BufferResource& resource;
+    Channel& channel;
+    Notification result;
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> handle);
+    Notification await_resume() const noexcept { return result; }
+  };
+
+  BufferResource(ProcessEngine& engine, Buffer& buffer, Database& database, std::size_t maxWaiters);
+
+  PutAwaiter put(const Notification& notification);
+  AcquireAwaiter acquire(Channel& channel);
+
+private:
+  void place(const Notification& notification);
+};
+
+#endif // PROCESS_ENGINE_H
\ No newline at end of file
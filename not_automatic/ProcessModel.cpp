@@ -0,0 +1,68 @@
+// ProcessModel.cpp
+#include "ProcessModel.h"
+#include "PushNotificationSystem.h" // Для streamSeed
+
+ProcessModel::ProcessModel(int numSources, int bufferCapacity, int maxNotifs, unsigned seed)
+  : sources(), buffer(bufferCapacity), channels(), database(),
+  engine(numSources + 3), bufferResource(engine, buffer, database, 3),
+  totalNotifications(0), maxNotifications(maxNotifs) {
+
+  // Источники (ИБ, ИЗ1) - те же, что в PushNotificationSystem
+  sources.reserve(numSources);
+  for (int i = 1; i <= numSources; i++) {
+    sources.emplace_back(i, 0.5, PushNotificationSystem::streamSeed(seed, 0, i));
+  }
+
+  // Каналы (Д2П1, П32)
+  channels = {
+      Channel(1, 1, 2.0, 5.0, PushNotificationSystem::streamSeed(seed, 1, 1)),
+      Channel(2, 2, 2.0, 5.0, PushNotificationSystem::streamSeed(seed, 1, 2)),
+      Channel(3, 3, 2.0, 5.0, PushNotificationSystem::streamSeed(seed, 1, 3))
+  };
+
+  // Каналы стартуют первыми: к первой заявке они уже ждут в acquire()
+  for (auto& channel : channels) {
+    engine.spawn(channelProcess(channel));
+  }
+  for (auto& source : sources) {
+    engine.spawn(sourceProcess(source));
+    totalNotifications++; // Как и в PushNotificationSystem, учитываем первую запланированную заявку
+  }
+}
+
+SimProcess ProcessModel::sourceProcess(Source& source) {
+  for (;;) {
+    co_await engine.delay(source.getNextInterval());
+
+    Notification notification = source.generateNotification(engine.now());
+    database.recordGeneration(source.getId());
+    co_await bufferResource.put(notification);
+
+    totalNotifications++;
+    if (totalNotifications >= maxNotifications) {
+      engine.stop();
+    }
+  }
+}
+
+SimProcess ProcessModel::channelProcess(Channel& channel) {
+  for (;;) {
+    Notification notification = co_await bufferResource.acquire(channel);
+
+    double serviceTime = channel.startProcessing(notification, engine.now());
+    database.recordDelivery(channel.getCurrentNotification(), serviceTime, channel.getId());
+    co_await engine.delay(serviceTime);
+
+    channel.freeChannel();
+  }
+}
+
+void ProcessModel::run() {
+  if (totalNotifications < maxNotifications) {
+    engine.run();
+  }
+}
+
+double ProcessModel::getCurrentTime() const { return engine.now(); }
+long long ProcessModel::getActivations() const { return engine.getActivations(); }
+const Database& ProcessModel::getDatabase() const { return database; }
\ No newline at end of file
@@ -0,0 +1,41 @@
+// ProcessModel.h
+#ifndef PROCESS_MODEL_H
+#define PROCESS_MODEL_H
+
+#include "Source.h"
+#include "Buffer.h"
+#include "Channel.h"
+#include "Database.h"
+#include "ProcessEngine.h"
+#include <vector>
+
+// Процессная модель той же системы: каждый источник и каждый канал - цикл-сопрограмма
+// вместо ветвей "GEN"/"FREE_CHAN" в PushNotificationSystem::processNextEvent()
+class ProcessModel {
+private:
+  std::vector<Source> sources;
+  Buffer buffer;
+  std::vector<Channel> channels;
+  Database database;
+  ProcessEngine engine;
+  BufferResource bufferResource;
+
+  int totalNotifications;
+  int maxNotifications;
+
+public:
+  // Параметры и зерна совпадают с PushNotificationSystem - при одном seed результаты идентичны
+  ProcessModel(int numSources, int bufferCapacity, int maxNotifs, unsigned seed);
+
+  void run();
+
+  double getCurrentTime() const;
+  long long getActivations() const;
+  const Database& getDatabase() const;
+
+private:
+  SimProcess sourceProcess(Source& source);
+  SimProcess channelProcess(Channel& channel);
+};
+
+#endif // PROCESS_MODEL_H
\ No newline at end of file
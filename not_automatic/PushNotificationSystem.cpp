@@ -1,57 +1,159 @@
 // PushNotificationSystem.cpp
 #include "PushNotificationSystem.h"
+#include "Checkpoint.h"
 #include <iostream>
 #include <iomanip>
-#include <exception> //  std::exception
-
-PushNotificationSystem::PushNotificationSystem(int numSources, int bufferCapacity, int numChannels, int maxNotifs)
-  : sources(), buffer(bufferCapacity), channels(), database(),
-  dispatcher(&buffer, nullptr, &database), //  channels 
-  eventCalendar(), //  typedef
-  currentTime(0.0), simulationComplete(false), totalNotifications(0), maxNotifications(maxNotifs),
-  // ---     ---
-  snapshotIntervalTime(5.0), // ,   5  
-  snapshotIntervalCount(100) //   100  
+#include <exception> // Для std::exception
+#include <random> // Для std::seed_seq
+#include <algorithm> // Для std::upper_bound
+#include <stdexcept>
+#include <limits>
+
+namespace {
+
+  // Пределы маркерных корзин по номеру источника (burst = true - емкости)
+  std::vector<double> rateLimitsBySource(const SimulationConfig& config, bool burst) {
+    std::vector<double> values(config.sources.size() + 1, 0.0);
+    for (const auto& source : config.sources) {
+      values[source.id] = burst ? source.rateBurst : source.rateLimit;
+    }
+    return values;
+  }
+
+}
+
+// Зерно отдельного потока случайных чисел (0 - недетерминированный запуск)
+unsigned PushNotificationSystem::streamSeed(unsigned seed, int kind, int id) {
+  if (seed == 0) {
+    return std::random_device()();
+  }
+  std::seed_seq seq{ seed, static_cast<unsigned>(kind), static_cast<unsigned>(id) };
+  unsigned result;
+  seq.generate(&result, &result + 1);
+  return result;
+}
+
+PushNotificationSystem::PushNotificationSystem(int numSources, int bufferCapacity, int numChannels, long long maxNotifs, unsigned seed)
+  : PushNotificationSystem(SimulationConfig::variant17(numSources, bufferCapacity, numChannels, maxNotifs, seed)) {
+}
+
+PushNotificationSystem::PushNotificationSystem(const SimulationConfig& config)
+  : sources(), buffer(config.bufferCapacity), channels(),
+  database(static_cast<int>(config.sources.size()), channelSlots(config)),
+  dispatcher(&buffer, {}, &database), // Установим channels позже
+  eventCalendar(), // Используем typedef
+  currentTime(0.0), simulationComplete(false), totalNotifications(0), maxNotifications(config.maxNotifications),
+  // --- Установка интервалов для снапшотов ---
+  snapshotIntervalTime(5.0), // Например, снимок каждые 5 единиц времени
+  snapshotIntervalCount(config.snapshotInterval), // Или каждые N обработанных событий (по умолчанию 100)
+  verbose(true), processedEvents(0), snapshotCounter(0),
+  timeline(), timelineInterval(0),
+  rateLimiter(rateLimitsBySource(config, false), rateLimitsBySource(config, true)),
+  warmup(config.warmupBatch), warmupResetTime(-1.0), targetPrecision(config.precision),
+  retryPolicy(config.retry),
+  retryPool(config.retry.maxAttempts > 0
+    ? (config.retry.poolSize > 0 ? config.retry.poolSize : 4 * config.bufferCapacity + static_cast<int>(config.sources.size()))
+    : 0),
+  retryRng(streamSeed(config.seed, 3, 0)),
+  autoscaler(config.autoscale, static_cast<int>(config.channels.size())),
+  channelTemplate(config.channels.empty() ? ChannelConfig{ 0, 1, 2.0, 5.0 } : config.channels.back()),
+  pendingChannels(0), heldChannels(0), provisionedChannels(0), retiredChannels(0),
+  provisionRng(streamSeed(config.seed, 5, 0)),
+  forwardDelay(0.0), outbox(), forwardPool(0, true),
+  metricsServer(nullptr), metricsInterval(1024)
 {
 
-  //   (, 1)
-  for (int i = 1; i <= numSources; i++) {
-    sources.emplace_back(i, 0.5); // Lambda = 0.5 (  2.0)
+  // Инициализация источников (ИБ, ИЗ1)
+  sources.reserve(config.sources.size());
+  for (const auto& source : config.sources) {
+    sources.emplace_back(source.id, source.lambda, streamSeed(config.seed, 0, source.id));
+    sources.back().setAudience(source.devices, source.collapseKeys);
+    sources.back().setPriorityClass(source.priorityClass);
+    sources.back().setAntithetic(config.antithetic);
   }
 
-  //   (21, 32)
-  channels = {
-      Channel(1, 1, 2.0, 5.0), //  1 -  
-      Channel(2, 2, 2.0, 5.0), //  2
-      Channel(3, 3, 2.0, 5.0)  //  3 -  
-  };
+  // Инициализация каналов (Д2П1, П32)
+  channels.reserve(channelSlots(config));
+  freeChannelSlots.reserve(channelSlots(config));
+  for (const auto& channel : config.channels) {
+    channels.emplace_back(channel, streamSeed(config.seed, 1, channel.id));
+    channels.back().setAntithetic(config.antithetic);
+    database.recordChannelOnline(channel.id, 0.0);
+  }
 
-  //      
-  std::vector<Channel*>* channelPtrs = new std::vector<Channel*>();
+  // Указатели на каналы в диспетчере (ячейки не перемещаются - память зарезервирована)
+  std::vector<Channel*> channelPtrs;
+  channelPtrs.reserve(channels.size());
   for (auto& ch : channels) {
-    channelPtrs->push_back(&ch);
+    channelPtrs.push_back(&ch);
   }
   dispatcher = PlacementDispatcher(&buffer, channelPtrs, &database);
+  dispatcher.setPolicy(config.dispatchPolicy, config.dispatchChoices, streamSeed(config.seed, 4, 0));
+  dispatcher.setAntithetic(config.antithetic);
+  retryRng.setAntithetic(config.antithetic);
+  provisionRng.setAntithetic(config.antithetic); // По нему же - режим потоков добавляемых каналов
+
+  // Сроки жизни в буфере - только если хотя бы у одного источника задан TTL
+  std::vector<double> ttlBySource(sources.size() + 1, 0.0);
+  bool anyTtl = false;
+  for (const auto& source : config.sources) {
+    ttlBySource[source.id] = source.ttl;
+    anyTtl = anyTtl || source.ttl > 0;
+  }
+  if (anyTtl) {
+    buffer.enableExpiry(ttlBySource, config.ttlTick);
+  }
+  if (config.coalescing) {
+    buffer.enableCoalescing();
+  }
+  if (retryPolicy.maxAttempts > 0) {
+    buffer.enableDisplacementRetry();
+  }
+  // Классы уведомлений: кольца по классам в общей емкости буфера, учет задержек по классам
+  if (config.classSelection != ClassSelection::NONE) {
+    std::vector<int> classBySource(sources.size() + 1, 0);
+    int classCount = 1;
+    for (const auto& source : config.sources) {
+      classBySource[source.id] = source.priorityClass;
+      classCount = std::max(classCount, source.priorityClass + 1);
+    }
+    buffer.enableClasses(classCount, config.classSelection, config.classWeights);
+    database.configureClasses(classBySource);
+  }
+  if (targetPrecision > 0) {
+    // 64 пачки на показатель; t_alpha - как T_ALPHA в automatic/CMO.py (доверительная вероятность 0.9)
+    database.configureBatchMeans(64, 1.643);
+  }
 
-  //       
+  // Запланировать первые события генерации для каждого источника.
+  // В календаре одновременно не больше одного GEN на источник, одного FREE_CHAN на канал
+  // и одного RETRY на ячейку пула - место резервируется сразу, куча строится за O(n)
+  // (а с автомасштабированием - одного SCALE и CHAN_UP на каждый заказанный канал)
+  std::vector<Event> initialEvents;
+  initialEvents.reserve(sources.size() + channels.capacity() + retryPool.getCapacity() + 1);
   for (auto& source : sources) {
     double nextGenTime = source.getNextGenerationTime(currentTime);
-    Notification firstNotif = source.generateNotification();
-    //  
-    database.recordGeneration(source.getId());
-    eventCalendar.push(Event(nextGenTime, "GEN", source.getId(), firstNotif.getId()));
+    Notification firstNotif = source.generateNotification(nextGenTime);
+    // Генерация учитывается при наступлении события GEN
+    initialEvents.push_back(Event(nextGenTime, EventType::GEN, source.getId(), firstNotif.getId()));
     totalNotifications++;
   }
+  if (autoscaler.isEnabled()) {
+    initialEvents.push_back(Event(autoscaler.getConfig().interval, EventType::SCALE));
+  }
+  eventCalendar = EventQueue(EventComparator(), std::move(initialEvents));
 
   startTime = std::chrono::system_clock::now();
 }
 
 void PushNotificationSystem::runStepByStep() {
   std::cout << "Push Notification Delivery System Simulation (Variant 17)\n";
-  std::cout << "Disciplines: |1|2|11|14|21|23|32|2\n";
+  std::cout << "Disciplines: ИБ|ИЗ1|ПЗ2|Д1ОЗ1|Д1ОО4|Д2П1|Д2Б3|П32|ОД2\n";
   std::cout << "--------------------------------------------------------\n";
 
-  int snapshotCounter = 0; //      
+  if (timelineInterval == 0) {
+    enableTimeline(4096);
+  }
 
   while (!simulationComplete && totalNotifications < maxNotifications) {
     displayState();
@@ -60,7 +162,9 @@ void PushNotificationSystem::runStepByStep() {
     std::cout << "\nCommands:\n";
     std::cout << "S - Next Step (Process one event)\n";
     std::cout << "R - Run until next notification generation\n";
-    std::cout << "T - Run until next channel free\n"; //    ,  FREE_CHAN 
+    std::cout << "T - Run until next channel free\n";
+    std::cout << "B - Step back (undo one event)\n";
+    std::cout << "G - Go to event #k or time t\n";
     std::cout << "F - Finish simulation (run all events)\n";
     std::cout << "Q - Quit\n";
     std::cout << "Enter command: ";
@@ -70,39 +174,48 @@ void PushNotificationSystem::runStepByStep() {
     switch (command) {
     case 'S':
       if (!eventCalendar.empty()) {
-        processNextEvent();
-        snapshotCounter++;
-        //      
-        if (snapshotCounter >= snapshotIntervalCount) {
-          database.snapshotStatistics(currentTime);
-          snapshotCounter = 0; //  
-        }
+        advance();
       }
       else {
         simulationComplete = true;
       }
       break;
     case 'R':
-      runUntilEventType("GEN");
+      runUntilEventType(EventType::GEN);
       break;
-    case 'T': // ---  T ---
-      //       (FREE_CHAN)  !
-      //  T    "Run until limit",   .
-      //    T,    FREE_CHAN.
-      //   : Channel  **,   .
-      // PushNotificationSystem    FREE_CHAN  .
-      // processNextEvent    FREE_CHAN.
-      //  , T          (  - ).
-      runUntilEventType("FREE_CHAN");
+    case 'T': // --- КОМАНДА T ---
+      // Выполнить события до ближайшего освобождения канала (FREE_CHAN) включительно
+      runUntilEventType(EventType::FREE_CHAN);
       break;
+    case 'B':
+      if (processedEvents > 0) {
+        goToEvent(processedEvents - 1);
+      }
+      else {
+        std::cout << "Already at the beginning of the run.\n";
+      }
+      break;
+    case 'G': {
+      // Номер события (например 150) или момент времени с префиксом t (например t42.5)
+      std::string target;
+      std::cout << "Go to (event number or t<time>): ";
+      std::cin >> target;
+      try {
+        if (!target.empty() && (target[0] == 't' || target[0] == 'T')) {
+          goToTime(std::stod(target.substr(1)));
+        }
+        else {
+          goToEvent(std::stoll(target[0] == '#' ? target.substr(1) : target));
+        }
+      }
+      catch (const std::exception&) {
+        std::cout << "Invalid target.\n";
+      }
+      break;
+    }
     case 'F':
       while (!eventCalendar.empty() && totalNotifications < maxNotifications) {
-        processNextEvent();
-        snapshotCounter++;
-        if (snapshotCounter >= snapshotIntervalCount) {
-          database.snapshotStatistics(currentTime);
-          snapshotCounter = 0;
-        }
+        advance();
       }
       simulationComplete = true;
       break;
@@ -119,7 +232,7 @@ void PushNotificationSystem::runStepByStep() {
   }
 
   if (simulationComplete) {
-    finalizeSimulation(); //  
+    finalizeSimulation(); // Вызываем финализацию
   }
 }
 
@@ -132,129 +245,471 @@ void PushNotificationSystem::processNextEvent() {
   Event event = eventCalendar.top();
   eventCalendar.pop();
   currentTime = event.time;
+  processedEvents++;
 
-  std::cout << "\n--- PROCESSING EVENT ---\n";
-  std::cout << "Time: " << std::fixed << std::setprecision(3) << currentTime
-    << ", Type: " << event.type;
-  if (event.type == "GEN") {
-    std::cout << ", Source: " << event.sourceId << ", Notification: " << event.notificationId;
+  // Истечение TTL - пачкой при продвижении времени, без событий в календаре
+  int expired = buffer.expireNotifications(currentTime, &database);
+  if (verbose && expired > 0) {
+    std::cout << "\n" << expired << " notification(s) expired in Buffer (TTL).\n";
   }
-  else if (event.type == "PROC_END" || event.type == "FREE_CHAN") {
-    std::cout << ", Channel: " << event.channelId;
+
+  if (verbose) {
+    std::cout << "\n--- PROCESSING EVENT ---\n";
+    std::cout << "Time: " << std::fixed << std::setprecision(3) << currentTime
+      << ", Type: " << eventTypeName(event.type);
+    if (event.type == EventType::GEN) {
+      std::cout << ", Source: " << event.sourceId << ", Notification: " << event.notificationId;
+    }
+    else if (event.type == EventType::FREE_CHAN) {
+      std::cout << ", Channel: " << event.channelId;
+    }
+    else if (event.type == EventType::RETRY) {
+      std::cout << ", Source: " << event.sourceId << ", Notification: " << event.notificationId << " (retry)";
+    }
+    else if (event.type == EventType::FORWARD) {
+      std::cout << ", Notification: " << event.notificationId << " (from another shard)";
+    }
+    std::cout << "\n";
   }
-  std::cout << "\n";
 
   try {
-    if (event.type == "GEN") {
-      //   
-      Notification newNotification = Notification(event.notificationId, event.sourceId);
+    if (event.type == EventType::GEN) {
+      // Обработка события генерации
+      Notification newNotification = Notification(event.notificationId, event.sourceId, currentTime);
+      sources[event.sourceId - 1].assignAudience(newNotification); // Устройство и ключ схлопывания
 
-      //  
+      // ЗАПИСАТЬ ГЕНЕРАЦИЮ
       database.recordGeneration(event.sourceId);
 
-      //    
-      //     
-      Channel* targetChannel = dispatcher.selectChannelByPriority();
-      if (targetChannel) {
-        double serviceTime = targetChannel->startProcessing(newNotification);
-        //       (  )
-        // serviceTime   
-        database.recordDelivery(newNotification, serviceTime, targetChannel->getId());
-        std::cout << "Notification " << event.notificationId << " from Source " << event.sourceId << " sent to Channel " << targetChannel->getId() << ".\n";
-      }
-      else {
-        //   ,   
-        dispatcher.handleNewNotification(newNotification);
-        std::cout << "Notification " << event.notificationId << " from Source " << event.sourceId << " sent to Buffer.\n";
-      }
+      // Обработать уведомление диспетчером постановки
+      placeArrival(newNotification);
 
-      //       
-      Source& source = sources[event.sourceId - 1]; //   0
+      // Запланировать следующее событие генерации от этого источника
+      Source& source = sources[event.sourceId - 1]; // Индексация с 0
       double nextGenTime = source.getNextGenerationTime(currentTime);
-      Notification nextNotif = source.generateNotification();
-      //   
-      database.recordGeneration(source.getId());
-      eventCalendar.push(Event(nextGenTime, "GEN", source.getId(), nextNotif.getId()));
+      Notification nextNotif = source.generateNotification(nextGenTime);
+      eventCalendar.push(Event(nextGenTime, EventType::GEN, source.getId(), nextNotif.getId()));
       totalNotifications++;
 
-      //     ,    
-      dispatcher.tryProcessFromBuffer();
+      // Попытаться обработать уведомление из буфера, если есть свободный канал
+      double serviceTime = 0.0;
+      Channel* startedChannel = dispatcher.tryProcessFromBuffer(currentTime, serviceTime);
+      if (startedChannel) {
+        scheduleChannelRelease(startedChannel, serviceTime);
+      }
 
     }
-    else if (event.type == "FREE_CHAN") { //     (    )
+    else if (event.type == EventType::RETRY) {
+      // Клиент переотправляет вытесненное: то же уведомление (время создания прежнее) поступает заново
+      placeArrival(retryPool.release(event.channelId));
+
+      double serviceTime = 0.0;
+      Channel* startedChannel = dispatcher.tryProcessFromBuffer(currentTime, serviceTime);
+      if (startedChannel) {
+        scheduleChannelRelease(startedChannel, serviceTime);
+      }
+    }
+    else if (event.type == EventType::FORWARD) {
+      // Переполнение другого шарда: поступает как новое, учитывается под источником 0
+      placeArrival(forwardPool.release(event.channelId));
+
+      double serviceTime = 0.0;
+      Channel* startedChannel = dispatcher.tryProcessFromBuffer(currentTime, serviceTime);
+      if (startedChannel) {
+        scheduleChannelRelease(startedChannel, serviceTime);
+      }
+    }
+    else if (event.type == EventType::SCALE) {
+      rescaleChannels();
+    }
+    else if (event.type == EventType::CHAN_UP) {
+      provisionChannel();
+
+      double serviceTime = 0.0;
+      Channel* startedChannel = dispatcher.tryProcessFromBuffer(currentTime, serviceTime);
+      if (startedChannel) {
+        scheduleChannelRelease(startedChannel, serviceTime);
+      }
+    }
+    else if (event.type == EventType::FREE_CHAN) { // Обработка события освобождения канала
       int channelId = event.channelId;
-      Channel& channel = channels[channelId - 1]; //   0
+      Channel& channel = channels[channelId - 1]; // Индексация с 0
 
       if (channel.isChannelBusy()) {
         Notification finishedNotification = channel.getCurrentNotification();
 
-        //   *   *
-        // double serviceTime = finishedNotification.getSystemTime() - finishedNotification.getWaitTime(); // 
-        // database.recordDelivery(finishedNotification, serviceTime, channelId); //      
+        // Записать статистику *только при завершении обслуживания*
+        // double serviceTime = finishedNotification.getSystemTime() - finishedNotification.getWaitTime(); // Приблизительно
+        // database.recordDelivery(finishedNotification, serviceTime, channelId); // Уже записано при выборе из буфера
 
-        //  
-        channel.freeChannel();
+        // Освободить канал; снимаемый после этого обслуживания - выводится из работы
+        if (!dispatcher.releaseChannel(&channel)) {
+          takeChannelOffline(channelId);
+        }
 
-        std::cout << "Channel " << channelId << " finished processing Notification " << finishedNotification.getId() << " and became free.\n";
+        if (verbose) {
+          std::cout << "Channel " << channelId << " finished processing Notification " << finishedNotification.getId() << " and became free.\n";
+        }
 
-        //     ,    
-        dispatcher.tryProcessFromBuffer();
+        // Попытаться обработать уведомление из буфера, так как канал освободился
+        double serviceTime = 0.0;
+        Channel* startedChannel = dispatcher.tryProcessFromBuffer(currentTime, serviceTime);
+        if (startedChannel) {
+          scheduleChannelRelease(startedChannel, serviceTime);
+        }
       }
-      else {
+      else if (verbose) {
         std::cout << "Channel " << channelId << " was already free. No action taken.\n";
       }
     }
   }
   catch (const std::exception& e) {
     std::cerr << "Exception during processing event: " << e.what() << std::endl;
-    //    (,  )
+    // Логика обработки исключения (например, пропустить событие)
+  }
+}
+
+void PushNotificationSystem::placeArrival(const Notification& notification) {
+  // Маркерная корзина источника - до канала и буфера: не пропущенное не вытесняет чужие
+  if (rateLimiter.isEnabled() && !rateLimiter.admit(notification.getSourceId(), currentTime)) {
+    database.recordThrottle(notification);
+    if (verbose) {
+      std::cout << "Notification " << notification.getId() << " from Source " << notification.getSourceId() << " throttled at ingress.\n";
+    }
+    return;
+  }
+  // Сначала пробуем поставить в канал
+  Channel* targetChannel = dispatcher.selectChannel();
+  if (targetChannel) {
+    // Записать статистику при постановке в канал (в пошаговом режиме)
+    // serviceTime передаётся из канала
+    double serviceTime = dispatcher.startService(targetChannel, notification, currentTime);
+    scheduleChannelRelease(targetChannel, serviceTime);
+    if (verbose) {
+      std::cout << "Notification " << notification.getId() << " from Source " << notification.getSourceId() << " sent to Channel " << targetChannel->getId() << ".\n";
+    }
+  }
+  else {
+    // Если каналов нет, поставить в буфер
+    dispatcher.handleNewNotification(notification, currentTime);
+    if (verbose) {
+      std::cout << "Notification " << notification.getId() << " from Source " << notification.getSourceId() << " sent to Buffer.\n";
+    }
+    scheduleRetry();
+  }
+}
+
+void PushNotificationSystem::scheduleRetry() {
+  Notification displaced;
+  if (!buffer.takeDisplaced(displaced)) {
+    return;
+  }
+  // Шард: переполнение региона уходит в соседний, уже переданное - по обычным правилам
+  if (forwardDelay > 0 && displaced.getForwardCount() == 0) {
+    database.recordForward(displaced);
+    outbox.push_back({ currentTime + forwardDelay, displaced });
+    if (verbose) {
+      std::cout << "Notification " << displaced.getId() << " from Source " << displaced.getSourceId()
+        << " displaced, forwarded to another shard.\n";
+    }
+    return;
+  }
+  if (displaced.getRetryCount() < retryPolicy.maxAttempts) {
+    displaced.markRetry();
+    int slot = retryPool.acquire(displaced);
+    if (slot >= 0) {
+      double u = std::uniform_real_distribution<double>(0.0, 1.0)(retryRng);
+      double retryTime = currentTime + retryPolicy.delay(displaced.getRetryCount(), u);
+      eventCalendar.push(Event(retryTime, EventType::RETRY, displaced.getSourceId(), displaced.getId(), slot));
+      database.recordRetry(displaced);
+      if (verbose) {
+        std::cout << "Notification " << displaced.getId() << " from Source " << displaced.getSourceId()
+          << " displaced, retry #" << displaced.getRetryCount() << " at " << retryTime << ".\n";
+      }
+      return;
+    }
+  }
+  // Попытки исчерпаны или пул заполнен - окончательный отказ (Д1ОО4)
+  database.recordRejection(displaced);
+}
+
+int PushNotificationSystem::channelSlots(const SimulationConfig& config) {
+  int initial = static_cast<int>(config.channels.size());
+  if (config.autoscale.policy == ScalingPolicy::NONE) {
+    return initial;
+  }
+  int maximum = config.autoscale.maxChannels > 0 ? config.autoscale.maxChannels : std::max(config.autoscale.minChannels, 2 * initial);
+  return 2 * std::max(initial, maximum);
+}
+
+void PushNotificationSystem::rescaleChannels() {
+  int active = dispatcher.getActiveCount();
+  int planned = active + pendingChannels + heldChannels;
+  int desired = autoscaler.decide(currentTime, static_cast<double>(buffer.getUsedSlots()) / buffer.getCapacity(),
+    database.getGeneratedCount(), database.getRejectedCount(), database.getTotalBusyTime(), active, planned);
+
+  // Рост - заказ каналов, готовых через provisionDelay
+  for (; planned < desired; planned++) {
+    pendingChannels++;
+    eventCalendar.push(Event(currentTime + autoscaler.getConfig().provisionDelay, EventType::CHAN_UP));
+  }
+  // Сокращение - сначала отменяются ждущие ячейки, затем снимаются работающие (заказанные доводятся до ввода)
+  for (; planned > desired; planned--) {
+    if (heldChannels > 0) {
+      heldChannels--;
+      continue;
+    }
+    Channel* channel = dispatcher.pickRetiree();
+    if (!channel) {
+      break;
+    }
+    retiredChannels++;
+    if (dispatcher.retireChannel(channel)) {
+      takeChannelOffline(channel->getId());
+    }
+  }
+  if (verbose) {
+    std::cout << "Autoscaler: occupancy " << autoscaler.getLastOccupancy() << ", rejection " << autoscaler.getLastRejectionRate()
+      << ", utilization " << autoscaler.getLastUtilization() << " -> " << desired << " channel(s), active "
+      << dispatcher.getActiveCount() << ", pending " << pendingChannels << ", waiting for a slot " << heldChannels << ".\n";
+  }
+
+  eventCalendar.push(Event(currentTime + autoscaler.getConfig().interval, EventType::SCALE));
+}
+
+void PushNotificationSystem::provisionChannel() {
+  pendingChannels--;
+  if (freeChannelSlots.empty() && channels.size() == channels.capacity()) {
+    // Ячейки заняты работающими и снятыми, но еще дорабатывающими каналами (частые колебания при долгом
+    // обслуживании): заказ ждет первой освободившейся ячейки в takeChannelOffline
+    heldChannels++;
+    if (verbose) {
+      std::cout << "Channel order waits for a slot: all slots are busy or draining.\n";
+    }
+    return;
+  }
+  bringChannelOnline();
+}
+
+void PushNotificationSystem::bringChannelOnline() {
+  ChannelConfig config = channelTemplate;
+  if (!freeChannelSlots.empty()) {
+    // Номер и ячейка снятого канала - заново. Накопители Database по этому номеру не сбрасываются:
+    // строка Таблицы 2 - загрузка номера за весь прогон, канало-часы и занятость - без потерь
+    config.id = freeChannelSlots.back();
+    freeChannelSlots.pop_back();
+    channels[config.id - 1] = Channel(config, static_cast<unsigned>(provisionRng()));
+  }
+  else {
+    config.id = static_cast<int>(channels.size()) + 1;
+    channels.emplace_back(config, static_cast<unsigned>(provisionRng()));
+  }
+  provisionedChannels++;
+  channels[config.id - 1].setAntithetic(provisionRng.isAntithetic());
+  dispatcher.addChannel(&channels[config.id - 1]);
+  database.recordChannelOnline(config.id, currentTime);
+  if (verbose) {
+    std::cout << "Channel " << config.id << " provisioned.\n";
+  }
+}
+
+void PushNotificationSystem::takeChannelOffline(int channelId) {
+  database.recordChannelOffline(channelId, currentTime);
+  freeChannelSlots.push_back(channelId);
+  if (verbose) {
+    std::cout << "Channel " << channelId << " retired.\n";
+  }
+  if (heldChannels > 0) {
+    heldChannels--;
+    bringChannelOnline();
+  }
+}
+
+void PushNotificationSystem::enableForwarding(double delay) {
+  forwardDelay = delay;
+  if (forwardDelay > 0) {
+    buffer.enableDisplacementRetry(); // Вытесненное придерживается буфером до решения
+  }
+}
+
+double PushNotificationSystem::getNextEventTime() const {
+  if (eventCalendar.empty() || totalNotifications >= maxNotifications) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return eventCalendar.top().time;
+}
+
+void PushNotificationSystem::step() {
+  advance();
+}
+
+void PushNotificationSystem::runUntil(double bound) {
+  while (!eventCalendar.empty() && totalNotifications < maxNotifications && eventCalendar.top().time < bound) {
+    advance();
+  }
+}
+
+std::vector<ForwardedNotification>& PushNotificationSystem::getOutbox() { return outbox; }
+
+void PushNotificationSystem::acceptForwarded(const ForwardedNotification& message) {
+  Notification notification = message.notification;
+  notification.markForwarded();
+  int slot = forwardPool.acquire(notification);
+  eventCalendar.push(Event(message.time, EventType::FORWARD, notification.getSourceId(), notification.getId(), slot));
+}
+
+const Autoscaler& PushNotificationSystem::getAutoscaler() const { return autoscaler; }
+int PushNotificationSystem::getActiveChannels() const { return dispatcher.getActiveCount(); }
+int PushNotificationSystem::getChannelCount() const { return static_cast<int>(channels.size()); }
+long long PushNotificationSystem::getProvisionedChannels() const { return provisionedChannels; }
+long long PushNotificationSystem::getRetiredChannels() const { return retiredChannels; }
+
+void PushNotificationSystem::advance() {
+  processNextEvent();
+  snapshotCounter++;
+  if (warmup.isActive() && warmup.observe(currentTime, buffer.getUsedSlots(), database.getTotalWaitTime(), database.getWaitedCount())) {
+    // Отсчеты до найденной точки смещены к пустой системе; после нее уже накоплены вместе с ними -
+    // сбрасывается все, статистика дальше копится от текущего момента
+    autoscaler.rebase(database.getGeneratedCount(), database.getRejectedCount(), database.getTotalBusyTime());
+    database.reset(currentTime);
+    warmupResetTime = currentTime;
+    if (verbose) {
+      std::cout << "Разгон: MSER отсекает до t = " << warmup.getTruncationTime() << ", статистика сброшена при t = " << currentTime << "\n";
+    }
+  }
+  // Проверяем интервал снапшота по количеству событий
+  if (snapshotIntervalCount > 0 && snapshotCounter >= snapshotIntervalCount) {
+    database.snapshotStatistics(currentTime);
+    snapshotCounter = 0; // Сброс счётчика
+  }
+  if (timelineInterval > 0 && processedEvents % timelineInterval == 0) {
+    recordTimelineSnapshot();
+  }
+  if (metricsServer && processedEvents % metricsInterval == 0) {
+    publishMetrics();
+  }
+}
+
+void PushNotificationSystem::scheduleChannelRelease(Channel* channel, double serviceTime) {
+  // Окончание обслуживания (П32) - событие освобождения канала
+  eventCalendar.push(Event(currentTime + serviceTime, EventType::FREE_CHAN, -1, channel->getCurrentNotificationId(), channel->getId()));
+}
+
+void PushNotificationSystem::runHeadless() {
+  // Тот же цикл, что и команда F, но без диалога и без вывода на каждом событии
+  bool savedVerbose = verbose;
+  verbose = false;
+  runEvents(std::numeric_limits<long long>::max());
+  simulationComplete = true;
+  verbose = savedVerbose;
+  if (metricsServer) {
+    publishMetrics(); // Итог прогона
   }
 }
 
-void PushNotificationSystem::runUntilEventType(const std::string& eventType) {
+long long PushNotificationSystem::runEvents(long long maxEvents) {
+  if (targetPrecision > 0 && database.isPrecisionReached(targetPrecision)) {
+    return 0;
+  }
+  if (snapshotIntervalCount > 0) {
+    // Ряды - под все снапшоты прогона сразу, чтобы в цикле событий не было перевыделений.
+    // На заявку приходится около двух событий (GEN и FREE_CHAN). Оценка зависит только от потолка
+    // заявок: повторный вызов (прогон частями) ничего не выделяет
+    const long long maxReserved = 1LL << 22; // Для прогонов "до бесконечности" - рост по ходу
+    long long expected = std::min(2LL * maxNotifications / snapshotIntervalCount + 1, maxReserved);
+    if (expected > static_cast<long long>(database.getSeries().getLength())) {
+      database.reserveSeries(static_cast<std::size_t>(expected));
+    }
+  }
+  long long done = 0;
+  while (done < maxEvents && !eventCalendar.empty() && totalNotifications < maxNotifications) {
+    advance();
+    done++;
+    // Проверка точности проходит по всем пачкам - не на каждом событии
+    if (targetPrecision > 0 && processedEvents % 4096 == 0 && database.isPrecisionReached(targetPrecision)) {
+      break;
+    }
+  }
+  return done;
+}
+
+bool PushNotificationSystem::isFinished() const {
+  return eventCalendar.empty() || totalNotifications >= maxNotifications
+    || (targetPrecision > 0 && database.isPrecisionReached(targetPrecision));
+}
+
+void PushNotificationSystem::setVerbose(bool enabled) { verbose = enabled; }
+int PushNotificationSystem::getBufferOccupancy() const { return buffer.getUsedSlots(); }
+
+void PushNotificationSystem::reseedStreams(unsigned seed) {
+  for (auto& source : sources) {
+    source.reseed(streamSeed(seed, 0, source.getId()));
+  }
+  for (auto& channel : channels) {
+    channel.reseed(streamSeed(seed, 1, channel.getId()));
+  }
+  retryRng.seed(streamSeed(seed, 3, 0));
+  dispatcher.reseed(streamSeed(seed, 4, 0));
+  provisionRng.seed(streamSeed(seed, 5, 0));
+}
+void PushNotificationSystem::setMaxNotifications(long long maxNotifs) { maxNotifications = maxNotifs; }
+void PushNotificationSystem::setSnapshotInterval(int events) { snapshotIntervalCount = events; }
+double PushNotificationSystem::getCurrentTime() const { return currentTime; }
+long long PushNotificationSystem::getProcessedEvents() const { return processedEvents; }
+const Database& PushNotificationSystem::getDatabase() const { return database; }
+const WarmupDetector& PushNotificationSystem::getWarmup() const { return warmup; }
+double PushNotificationSystem::getWarmupResetTime() const { return warmupResetTime; }
+bool PushNotificationSystem::isPrecisionReached() const { return targetPrecision > 0 && database.isPrecisionReached(targetPrecision); }
+const RetryPool& PushNotificationSystem::getRetryPool() const { return retryPool; }
+
+void PushNotificationSystem::runUntilEventType(EventType eventType) {
   bool found = false;
   while (!eventCalendar.empty() && !found && totalNotifications < maxNotifications) {
     Event topEvent = eventCalendar.top();
     if (topEvent.type == eventType) {
       found = true;
     }
-    processNextEvent(); //   
-    //     ,    
+    advance(); // Обрабатываем текущее событие
+    // Если это было искомое событие, цикл завершится после обработки
   }
 }
 
 void PushNotificationSystem::displayState() {
-  std::cout << "\n=====    (2) =====\n";
+  std::cout << "\n===== ФОРМАЛИЗОВАННАЯ СХЕМА МОДЕЛИ (ОД2) =====\n";
 
-  //   ( 5)
-  std::cout << "\n---   ---\n";
+  // Календарь событий (первые 5)
+  std::cout << "\n--- КАЛЕНДАРЬ СОБЫТИЙ ---\n";
   std::cout << "Time | Type     | Details\n";
   std::cout << "-----|----------|--------\n";
 
-  std::vector<Event> tempEvents;
+  // Ближайшие события - извлечением из кучи в буфер на стеке и возвратом обратно
+  Event nearest[5];
   int count = 0;
   while (!eventCalendar.empty() && count < 5) {
     Event e = eventCalendar.top(); eventCalendar.pop();
-    tempEvents.push_back(e);
+    nearest[count] = e;
     std::cout << std::fixed << std::setprecision(3)
       << std::setw(5) << e.time << " | "
-      << std::setw(8) << e.type << " | ";
-    if (e.type == "GEN") {
+      << std::setw(8) << eventTypeName(e.type) << " | ";
+    if (e.type == EventType::GEN) {
       std::cout << "Src: " << e.sourceId << ", Notif: " << e.notificationId;
     }
-    else if (e.type == "FREE_CHAN") {
+    else if (e.type == EventType::FREE_CHAN) {
       std::cout << "Chan: " << e.channelId;
     }
+    else if (e.type == EventType::RETRY) {
+      std::cout << "Src: " << e.sourceId << ", Notif: " << e.notificationId << " (retry)";
+    }
     std::cout << "\n";
     count++;
   }
-  //    
-  for (auto it = tempEvents.rbegin(); it != tempEvents.rend(); ++it) {
-    eventCalendar.push(*it);
+  // Восстановить события в календарь
+  for (int i = count - 1; i >= 0; i--) {
+    eventCalendar.push(nearest[i]);
   }
 
-  //  
-  std::cout << "\n---   (Capacity: " << buffer.getCapacity()
+  // Состояние буфера
+  std::cout << "\n--- СОСТОЯНИЕ БУФЕРА (Capacity: " << buffer.getCapacity()
     << ", Used: " << buffer.getUsedSlots() << ", Pointer: " << dispatcher.getBufferPointer() << ") ---\n";
   std::cout << "Pos | Occupied | Notification ID | Source | Status\n";
   std::cout << "----|----------|-----------------|--------|-------\n";
@@ -264,52 +719,373 @@ void PushNotificationSystem::displayState() {
 
   for (int i = 0; i < notifs.size(); i++) {
     std::cout << std::setw(3) << i << " | "
-      << std::setw(8) << (occupied[i] ? "YES" : "NO") << " | "
-      << std::setw(15) << (occupied[i] ? std::to_string(notifs[i].getId()) : "Empty") << " | "
-      << std::setw(6) << (occupied[i] ? std::to_string(notifs[i].getSourceId()) : "-") << " | "
-      << (occupied[i] ? notifs[i].getStatusString() : "EMPTY") << "\n";
+      << std::setw(8) << (occupied[i] ? "YES" : "NO") << " | ";
+    if (occupied[i]) {
+      std::cout << std::setw(15) << notifs[i].getId() << " | "
+        << std::setw(6) << notifs[i].getSourceId() << " | "
+        << notifs[i].getStatusString() << "\n";
+    }
+    else {
+      std::cout << std::setw(15) << "Empty" << " | " << std::setw(6) << "-" << " | EMPTY\n";
+    }
   }
 
-  //  
-  std::cout << "\n---   ---\n";
+  // Состояние каналов
+  std::cout << "\n--- СОСТОЯНИЕ КАНАЛОВ ---\n";
   std::cout << "Chan | Priority | Busy | Current Notification (Source)\n";
   std::cout << "-----|----------|------|-----------------------------\n";
   for (const auto& channel : channels) {
-    std::string busyStatus = channel.isChannelBusy() ? "YES" : "NO";
-    std::string currentNotif = "None";
-    if (channel.isChannelBusy()) {
-      currentNotif = std::to_string(channel.getCurrentNotificationId()) +
-        " (" + std::to_string(channel.getCurrentNotificationSourceId()) + ")";
-    }
-
     std::cout << std::setw(4) << channel.getId() << " | "
       << std::setw(8) << channel.getPriority() << " | "
-      << std::setw(4) << busyStatus << " | "
-      << currentNotif << "\n";
+      << std::setw(4) << (channel.isChannelBusy() ? "YES" : "NO") << " | ";
+    if (channel.isChannelBusy()) {
+      std::cout << channel.getCurrentNotificationId() << " (" << channel.getCurrentNotificationSourceId() << ")";
+      if (channel.getBatch().size() > 1) {
+        std::cout << " +" << channel.getBatch().size() - 1 << " in batch";
+      }
+    }
+    else {
+      std::cout << "None";
+    }
+    std::cout << "\n";
   }
 
-  //  
-  std::cout << "\n---   ---\n";
+  // Промежуточная статистика
+  std::cout << "\n--- ПРОМЕЖУТОЧНАЯ СТАТИСТИКА ---\n";
   std::cout << "Time: " << std::fixed << std::setprecision(3) << currentTime << "\n";
   std::cout << "Total Notifications Processed: " << totalNotifications << "\n";
   std::cout << "Delivered: " << database.getDeliveredCount() << ", Rejected: " << database.getRejectedCount() << "\n";
   std::cout << "Rejection Rate: " << std::fixed << std::setprecision(3) << database.getRejectionRate() * 100 << "%\n";
+  std::cout << "Event #" << processedEvents << ", timeline: " << timeline.size() << " snapshots ("
+    << getTimelineBytes() / 1024 << " KB)\n";
 }
 
-// ---   finalizeSimulation ---
+// --- Новый метод finalizeSimulation ---
 void PushNotificationSystem::finalizeSimulation() {
   auto endTime = std::chrono::system_clock::now();
-  double totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() / 1000.0;
+  double wallTime = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count() / 1000.0;
+  // Загрузка каналов считается по модельному времени, а не по реальному
+  double totalTime = currentTime;
 
-  std::cout << "\n=====   =====\n";
-  std::cout << "  : " << totalTime << " \n";
+  std::cout << "\n===== ЗАВЕРШЕНИЕ СИМУЛЯЦИИ =====\n";
+  std::cout << "Общее модельное время: " << totalTime << " секунд\n";
+  std::cout << "Реальное время работы: " << wallTime << " секунд\n";
+  if (warmupResetTime >= 0) {
+    std::cout << "Разгон (MSER, пачки по " << warmup.getBatchLength() << " доставок): до t = " << warmup.getTruncationTime()
+      << ", статистика собрана с t = " << warmupResetTime << " (" << totalTime - warmupResetTime << " ед. времени)\n";
+  }
+  else if (warmup.isActive()) {
+    std::cout << "Разгон: MSER не нашел конца переходного режима (" << warmup.getBatchCount()
+      << " пачек) - статистика с t = 0, прогон слишком короткий\n";
+  }
+  if (targetPrecision > 0) {
+    std::cout << "Точность " << targetPrecision << " по всем показателям Таблицы 1: "
+      << (database.isPrecisionReached(targetPrecision) ? "достигнута" : "не достигнута (прогон остановлен потолком заявок)") << "\n";
+  }
 
-  //  1 ( ) -  totalTime
+  // Вывод ОР1 (Сводной таблицы) - передаём totalTime
   database.printStatistics(totalTime);
 
-  //  2 (  ) -   totalTime
+  if (autoscaler.isEnabled()) {
+    double channelHours = database.getChannelHours(totalTime);
+    std::cout << "\n--- Автомасштабирование ---\n";
+    std::cout << "Канало-время: " << channelHours << " (в среднем " << (totalTime > 0 ? channelHours / totalTime : 0.0)
+      << " каналов), стоимость " << channelHours * autoscaler.getConfig().channelCost
+      << "; введено " << provisionedChannels << ", снято " << retiredChannels
+      << ", работает " << dispatcher.getActiveCount()
+      << (heldChannels > 0 ? ", ждут ячейки " + std::to_string(heldChannels) : std::string()) << "\n";
+    if (retiredChannels > 0) {
+      std::cout << "Таблица 2 - по номерам каналов: номер снятого канала получает следующий введенный, "
+        << "и его загрузка суммируется с загрузкой прежних\n";
+    }
+  }
+
+  // Вывод ОР2 (Данных для графиков) - не требует totalTime
   database.printGraphData();
 
-  std::cout << "\n .  .\n";
+  std::cout << "\nСимуляция завершена. Результаты выведены.\n";
+}
+// --------------------------------------
+
+// --- Контрольные точки ---
+namespace {
+
+  const unsigned kCheckpointMagic = 0x4B434D4E; // "NMCK"
+  const unsigned kCheckpointVersion = 21; // 2 - колоночные ряды, 3 - гистограммы времен, 4 - законы обслуживания, 5 - TTL, 6 - объединение, 7 - пачки, 8 - повторы, 9 - классы, 10 - политики диспетчера, 11 - автомасштабирование, 12 - ограничение на входе, 13 - передача между шардами, 14 - антитетические потоки, 15 - отсечение разгона, 16 - метод пачек, 17 - точные квантили классов, 18 - точные T_ож и T_отклика, 19 - 64-битные счетчики, 20 - заказы каналов, ждущие ячейки, 21 - 64-битный счет заявок
+
+  // Доступ к контейнеру календаря: раскладка кучи сохраняется как есть,
+  // иначе события с равным временем могли бы выйти в другом порядке
+  std::vector<Event>& calendarStorage(EventQueue& queue) {
+    struct Access : EventQueue {
+      static std::vector<Event>& get(EventQueue& q) { return q.*&Access::c; }
+    };
+    return Access::get(queue);
+  }
+
+}
+
+void PushNotificationSystem::saveState(BinaryWriter& writer, bool withSeries) const {
+  writer.writePod(kCheckpointMagic);
+  writer.writePod(kCheckpointVersion);
+
+  writer.writePod(currentTime);
+  writer.writePod(simulationComplete);
+  writer.writePod(totalNotifications);
+  writer.writePod(maxNotifications);
+  writer.writePod(snapshotIntervalTime);
+  writer.writePod(snapshotIntervalCount);
+  writer.writePod(processedEvents);
+  writer.writePod(snapshotCounter);
+
+  writer.writePod<unsigned long long>(sources.size());
+  for (const auto& source : sources) {
+    source.saveState(writer);
+  }
+  buffer.saveState(writer);
+  writer.writePod<unsigned long long>(channels.size());
+  for (const auto& channel : channels) {
+    channel.saveState(writer);
+  }
+  dispatcher.saveState(writer);
+  autoscaler.saveState(writer);
+  writer.writePodVector(freeChannelSlots);
+  writer.writePod(pendingChannels);
+  writer.writePod(heldChannels);
+  writer.writePod(provisionedChannels);
+  writer.writePod(retiredChannels);
+  writer.writePod(provisionRng);
+  database.saveState(writer, withSeries);
+  writer.writePod(retryPolicy);
+  retryPool.saveState(writer);
+  writer.writePod(retryRng);
+  rateLimiter.saveState(writer);
+  warmup.saveState(writer);
+  writer.writePod(warmupResetTime);
+  writer.writePod(forwardDelay);
+  writer.writePod<unsigned long long>(outbox.size());
+  for (const auto& message : outbox) {
+    writer.writePod(message.time);
+    message.notification.saveState(writer);
+  }
+  forwardPool.saveState(writer);
+
+  const std::vector<Event>& events = calendarStorage(const_cast<EventQueue&>(eventCalendar));
+  writer.writePod<unsigned long long>(events.size());
+  for (const auto& event : events) {
+    writer.writePod(event.time);
+    writer.writeString(eventTypeName(event.type));
+    writer.writePod(event.sourceId);
+    writer.writePod(event.notificationId);
+    writer.writePod(event.channelId);
+  }
+}
+
+void PushNotificationSystem::loadState(BinaryReader& reader, bool withSeries) {
+  if (reader.readPod<unsigned>() != kCheckpointMagic || reader.readPod<unsigned>() != kCheckpointVersion) {
+    throw std::runtime_error("Файл не является контрольной точкой этой версии");
+  }
+
+  reader.readPod(currentTime);
+  reader.readPod(simulationComplete);
+  reader.readPod(totalNotifications);
+  reader.readPod(maxNotifications);
+  reader.readPod(snapshotIntervalTime);
+  reader.readPod(snapshotIntervalCount);
+  reader.readPod(processedEvents);
+  reader.readPod(snapshotCounter);
+
+  std::size_t sourceCount = static_cast<std::size_t>(reader.readPod<unsigned long long>());
+  sources.resize(sourceCount, Source(0, 1.0, 0));
+  for (auto& source : sources) {
+    source.loadState(reader);
+  }
+  buffer.loadState(reader);
+  // Каналы загружаются в зарезервированные ячейки - указатели не перемещаются
+  std::size_t channelCount = static_cast<std::size_t>(reader.readPod<unsigned long long>());
+  if (channelCount > channels.capacity()) {
+    throw std::runtime_error("Каналов в контрольной точке больше, чем ячеек в системе");
+  }
+  while (channels.size() > channelCount) {
+    channels.pop_back();
+  }
+  while (channels.size() < channelCount) {
+    channels.emplace_back(channelTemplate, 0u);
+  }
+  std::vector<Channel*> channelPtrs;
+  channelPtrs.reserve(channels.size());
+  for (auto& channel : channels) {
+    channel.loadState(reader);
+    channelPtrs.push_back(&channel);
+  }
+  dispatcher.setChannels(channelPtrs);
+  dispatcher.loadState(reader);
+  autoscaler.loadState(reader);
+  reader.readPodVector(freeChannelSlots);
+  reader.readPod(pendingChannels);
+  reader.readPod(heldChannels);
+  reader.readPod(provisionedChannels);
+  reader.readPod(retiredChannels);
+  reader.readPod(provisionRng);
+  database.loadState(reader, withSeries);
+  reader.readPod(retryPolicy);
+  retryPool.loadState(reader);
+  reader.readPod(retryRng);
+  rateLimiter.loadState(reader);
+  warmup.loadState(reader);
+  reader.readPod(warmupResetTime);
+  reader.readPod(forwardDelay);
+  outbox.resize(static_cast<std::size_t>(reader.readPod<unsigned long long>()));
+  for (auto& message : outbox) {
+    reader.readPod(message.time);
+    message.notification.loadState(reader);
+  }
+  forwardPool.loadState(reader);
+
+  std::vector<Event>& events = calendarStorage(eventCalendar);
+  events.clear();
+  std::size_t eventCount = static_cast<std::size_t>(reader.readPod<unsigned long long>());
+  events.reserve(eventCount);
+  for (std::size_t i = 0; i < eventCount; i++) {
+    double time = reader.readPod<double>();
+    EventType type = parseEventType(reader.readString());
+    int sourceId = reader.readPod<int>();
+    int notificationId = reader.readPod<int>();
+    int channelId = reader.readPod<int>();
+    events.emplace_back(time, type, sourceId, notificationId, channelId);
+  }
+}
+
+void PushNotificationSystem::saveCheckpoint(const std::string& path) const {
+  BinaryWriter writer;
+  saveState(writer);
+  writer.saveToFile(path);
+}
+
+void PushNotificationSystem::loadCheckpoint(const std::string& path) {
+  MappedFile file(path);
+  BinaryReader reader(file.data(), file.getSize());
+  loadState(reader);
+}
+
+// --- Шкала времени (перемещение назад) ---
+void PushNotificationSystem::enableTimeline(int interval) {
+  timelineInterval = interval;
+  if (timelineInterval > 0 && timeline.empty()) {
+    recordTimelineSnapshot(); // Исходное состояние - событие 0
+  }
+}
+
+void PushNotificationSystem::recordTimelineSnapshot() {
+  // После перехода назад прогон повторяет уже записанные события - снимки не дублируем
+  if (!timeline.empty() && timeline.back().event >= processedEvents) {
+    return;
+  }
+  BinaryWriter writer;
+  saveState(writer, false);
+  timeline.push_back(TimelineSnapshot{ processedEvents, currentTime, writer.getData() });
 }
-// --------------------------------------
\ No newline at end of file
+
+void PushNotificationSystem::restoreTimelineSnapshot(const TimelineSnapshot& snapshot) {
+  long long savedMaxNotifications = maxNotifications;
+  BinaryReader reader(snapshot.state.data(), snapshot.state.size());
+  loadState(reader, false);
+  maxNotifications = savedMaxNotifications;
+}
+
+void PushNotificationSystem::goToEvent(long long targetEvent) {
+  if (targetEvent < 0) {
+    targetEvent = 0;
+  }
+  bool savedVerbose = verbose;
+  verbose = false;
+
+  if (!timeline.empty()) {
+    // Последний снимок, не превосходящий цели. Прогон детерминирован, поэтому снимки
+    // впереди текущего события остаются верными и сокращают и переходы вперед
+    auto it = std::upper_bound(timeline.begin(), timeline.end(), targetEvent,
+      [](long long event, const TimelineSnapshot& snapshot) { return event < snapshot.event; });
+    const TimelineSnapshot& nearest = *(it - 1);
+    if (targetEvent < processedEvents || nearest.event > processedEvents) {
+      restoreTimelineSnapshot(nearest);
+    }
+  }
+  while (processedEvents < targetEvent && !eventCalendar.empty() && totalNotifications < maxNotifications) {
+    advance();
+  }
+
+  verbose = savedVerbose;
+}
+
+void PushNotificationSystem::goToTime(double targetTime) {
+  bool savedVerbose = verbose;
+  verbose = false;
+
+  if (!timeline.empty()) {
+    auto it = std::upper_bound(timeline.begin(), timeline.end(), targetTime,
+      [](double time, const TimelineSnapshot& snapshot) { return time < snapshot.time; });
+    const TimelineSnapshot& nearest = (it == timeline.begin()) ? timeline.front() : *(it - 1);
+    if (targetTime < currentTime || nearest.event > processedEvents) {
+      restoreTimelineSnapshot(nearest);
+    }
+  }
+  // Обработать все события с временем не позже цели
+  while (!eventCalendar.empty() && eventCalendar.top().time <= targetTime && totalNotifications < maxNotifications) {
+    advance();
+  }
+
+  verbose = savedVerbose;
+}
+
+std::size_t PushNotificationSystem::getTimelineBytes() const {
+  std::size_t bytes = 0;
+  for (const auto& snapshot : timeline) {
+    bytes += snapshot.state.size();
+  }
+  return bytes;
+}
+
+// --- Живые метрики ---
+void PushNotificationSystem::attachMetrics(MetricsServer* server, int publishInterval) {
+  metricsServer = server;
+  metricsInterval = publishInterval > 0 ? publishInterval : 1;
+  if (metricsServer) {
+    publishMetrics();
+  }
+}
+
+void PushNotificationSystem::publishMetrics() {
+  // Слот модели принадлежит только этому потоку; векторы переиспользуются между публикациями
+  MetricsSnapshot& snapshot = metricsServer->writeSlot();
+  snapshot.modelTime = currentTime;
+  snapshot.events = processedEvents;
+  snapshot.bufferUsed = buffer.getUsedSlots();
+  snapshot.bufferCapacity = buffer.getCapacity();
+
+  snapshot.sources.resize(sources.size());
+  for (std::size_t i = 0; i < sources.size(); i++) {
+    int id = sources[i].getId();
+    MetricsSnapshot::SourceMetrics& source = snapshot.sources[i];
+    source.id = id;
+    source.generated = database.getSourceGeneratedCount(id);
+    source.delivered = database.getSourceDeliveredCount(id);
+    source.rejected = database.getSourceRejectedCount(id);
+    source.expired = database.getSourceExpiredCount(id);
+    source.coalesced = database.getSourceCoalescedCount(id);
+    source.throttled = database.getSourceThrottledCount(id);
+    source.rejectionRate = database.getSourceRejectionRate(id);
+    source.waitTime = database.getSourceWaitHistogram(id);
+    source.serviceTime = database.getSourceServiceHistogram(id);
+  }
+
+  snapshot.channels.resize(channels.size());
+  for (std::size_t i = 0; i < channels.size(); i++) {
+    MetricsSnapshot::ChannelMetrics& channel = snapshot.channels[i];
+    channel.id = channels[i].getId();
+    channel.busy = channels[i].isChannelBusy();
+    channel.usage = database.getChannelUsage(channel.id);
+    channel.batchItems = database.getChannelBatchItems(channel.id);
+    channel.utilization = database.getChannelUtilization(channel.id, currentTime);
+  }
+
+  metricsServer->publish();
+}
\ No newline at end of file
@@ -2,50 +2,196 @@
 #ifndef PUSH_NOTIFICATION_SYSTEM_H
 #define PUSH_NOTIFICATION_SYSTEM_H
 
-#include "Source.h" //   
-#include "Buffer.h" //   
-#include "Channel.h" //   
-#include "Database.h" //   
-#include "PlacementDispatcher.h" //   
-#include "CommonTypes.h" //  Event, EventComparator
+#include "Source.h" // Для хранения вектора
+#include "Buffer.h" // Для хранения объекта
+#include "Channel.h" // Для хранения вектора
+#include "Database.h" // Для хранения объекта
+#include "PlacementDispatcher.h" // Для хранения объекта
+#include "CommonTypes.h" // Для Event, EventComparator
+#include "MetricsServer.h" // Для экспорта метрик
+#include "SimulationConfig.h" // Параметры источников, буфера и каналов
+#include "RetryPool.h" // Ожидающие повторы
+#include "RandomEngine.h" // Задержки повторов
+#include "Autoscaler.h" // Переменное число каналов
+#include "RateLimiter.h" // Маркерные корзины на входе
+#include "WarmupDetector.h" // Отсечение разгона
+#include <string>
 #include <vector>
 #include <queue>
 #include <chrono>
 
-//   
+// Вытесненное уведомление, переданное в другой шард: приходит туда в момент time
+struct ForwardedNotification {
+  double time;
+  Notification notification;
+};
+
+// Основной класс Системы
 class PushNotificationSystem {
 private:
   std::vector<Source> sources;
   Buffer buffer;
+  // Номер канала - постоянная ссылка на ячейку (индекс = номер - 1). Память под все ячейки
+  // резервируется при создании: добавление канала не сдвигает указатели диспетчера
   std::vector<Channel> channels;
   Database database;
   PlacementDispatcher dispatcher;
 
-  EventQueue eventCalendar; //   typedef  CommonTypes.h
+  EventQueue eventCalendar; // Теперь используем typedef из CommonTypes.h
 
   double currentTime;
   bool simulationComplete;
-  int totalNotifications;
-  int maxNotifications;
+  long long totalNotifications;
+  long long maxNotifications;
 
-  //    
-  double snapshotIntervalTime; //     
-  int snapshotIntervalCount;   //      
+  // Параметры для автоматического режима
+  double snapshotIntervalTime; // Интервал времени для снятия снапшотов
+  int snapshotIntervalCount;   // Интервал количества событий для снятия снапшотов
 
-  //     
+  // Для отслеживания времени работы системы
   std::chrono::system_clock::time_point startTime;
 
+  bool verbose; // Печатать ли ход обработки каждого события
+  long long processedEvents; // Количество обработанных событий календаря
+  int snapshotCounter; // Событий с последнего снапшота (часть состояния - для контрольных точек)
+
+  // Шкала времени для перемещения назад: компактные снимки каждые timelineInterval событий.
+  // Переход к событию k - загрузка ближайшего снимка не позже k и тихий прогон остатка.
+  // Ряды графиков в снимок не входят (хранится их длина) - они общие для всей шкалы
+  struct TimelineSnapshot {
+    long long event;
+    double time;
+    std::vector<char> state;
+  };
+  std::vector<TimelineSnapshot> timeline;
+  int timelineInterval; // 0 - шкала не ведется
+
+  RateLimiter rateLimiter; // Ограничение интенсивности источников на входе (новые и повторы)
+
+  // Разгон: после каждого события - наблюдение детектору; когда MSER находит конец переходного
+  // режима, накопители Database сбрасываются, состояние модели (буфер, каналы, календарь) остается
+  WarmupDetector warmup;
+  double warmupResetTime; // Момент сброса статистики, -1 - не было
+
+  // Один длинный прогон: интервалы Таблицы 1 методом пачек, runHeadless останавливается,
+  // как только у всех показателей полуширина не больше precision * |среднее| (notifications - потолок)
+  double targetPrecision; // 0 - без остановки по точности
+
+  // Повторы вытесненных: событие RETRY несет ячейку пула в поле channelId
+  RetryConfig retryPolicy;
+  RetryPool retryPool;
+  RandomEngine retryRng;
+
+  // Автомасштабирование: событие SCALE - замер и решение контроллера, CHAN_UP - канал введен.
+  // Снятый канал дорабатывает текущее обслуживание, его ячейка затем переиспользуется
+  Autoscaler autoscaler;
+  ChannelConfig channelTemplate; // Параметры добавляемых каналов - последняя группа [channels]
+  std::vector<int> freeChannelSlots; // Номера снятых каналов
+  int pendingChannels; // Заказанные, еще не введенные
+  int heldChannels; // Срок ввода прошел, но все ячейки заняты дорабатывающими снятыми - ждут первой свободной
+  long long provisionedChannels;
+  long long retiredChannels;
+  RandomEngine provisionRng; // Зерна генераторов новых каналов
+
+  // Шард параллельного прогона (ShardedSimulation): вытесненное уходит в исходящие с задержкой
+  // forwardDelay, принятое из другого шарда - событие FORWARD с ячейкой пула в поле channelId
+  double forwardDelay; // <= 0 - передачи нет
+  std::vector<ForwardedNotification> outbox; // Переданные, еще не забранные координатором
+  RetryPool forwardPool; // Растущий: прием не отказывает из-за момента доставки
+
+  MetricsServer* metricsServer; // Не владеет; nullptr - метрики не публикуются
+  int metricsInterval; // Публиковать снимок метрик каждые metricsInterval событий
+
 public:
-  PushNotificationSystem(int numSources, int bufferCapacity, int numChannels, int maxNotifs = 100);
+  // seed = 0 - случайное зерно, иначе прогон воспроизводим
+  // Вариант 17 (см. SimulationConfig::variant17)
+  PushNotificationSystem(int numSources, int bufferCapacity, int numChannels, long long maxNotifs = 100, unsigned seed = 0);
+  explicit PushNotificationSystem(const SimulationConfig& config);
 
-  //   
+  // Запуск пошаговой симуляции
   void runStepByStep();
 
+  // Прогон без диалога и без вывода (для замеров и автоматических режимов)
+  void runHeadless();
+  // Не больше maxEvents событий с теми же условиями остановки, что у runHeadless (потолок заявок,
+  // пустой календарь, точность); возвращает число обработанных. Для внешнего управления прогоном (NotifyMeApi)
+  long long runEvents(long long maxEvents);
+  bool isFinished() const; // Дальше runEvents ничего не обработает
+
+  void setVerbose(bool enabled);
+  void setMaxNotifications(long long maxNotifs); // Продолжение прогона после восстановления
+  void setSnapshotInterval(int events); // 0 - не снимать снапшоты
+  // Все потоки случайных чисел - заново из seed (как при создании), состояние модели не меняется.
+  // Клон траектории после loadState получает свое будущее, а не повтор исходного
+  void reseedStreams(unsigned seed);
+  double getCurrentTime() const;
+  int getBufferOccupancy() const; // Занятых ячеек буфера (функция важности расщепления)
+  long long getProcessedEvents() const;
+  const Database& getDatabase() const;
+  const WarmupDetector& getWarmup() const;
+  double getWarmupResetTime() const; // -1 - разгон не отсекался
+  bool isPrecisionReached() const; // Остановка по точности задана и достигнута
+
+  const RetryPool& getRetryPool() const;
+
+  // Ячеек под каналы: без автомасштабирования - число каналов, иначе на максимум пула
+  // и столько же снимаемых, еще не закончивших обслуживание
+  static int channelSlots(const SimulationConfig& config);
+
+  const Autoscaler& getAutoscaler() const;
+  int getActiveChannels() const;
+  int getChannelCount() const; // Заведенных номеров 1..N: начальные и введенные, включая снятые
+  long long getProvisionedChannels() const;
+  long long getRetiredChannels() const;
+
+  // Зерно потока случайных чисел: kind 0 - источник, 1 - канал, 2 - группа сценария, 3 - повторы, 4 - выборка диспетчера,
+  // 5 - новые каналы, 6 - шард, 7 - клоны расщепления
+  static unsigned streamSeed(unsigned seed, int kind, int id);
+
+  // Контрольные точки: календарь, буфер, каналы, генераторы и вся статистика.
+  // Прогон после восстановления побитово совпадает с непрерывным прогоном
+  // withSeries = false - компактный снимок без рядов графиков (для шкалы времени)
+  void saveState(BinaryWriter& writer, bool withSeries = true) const;
+  void loadState(BinaryReader& reader, bool withSeries = true);
+  void saveCheckpoint(const std::string& path) const;
+  void loadCheckpoint(const std::string& path); // Файл отображается в память (mmap)
+
+  void finalizeSimulation(); // Вывод результатов
+
+  // Перемещение по прогону (в т.ч. назад): к событию с номером k или к моменту t
+  void enableTimeline(int interval);
+  void goToEvent(long long targetEvent);
+  void goToTime(double targetTime);
+  std::size_t getTimelineBytes() const;
+
+  // Живые метрики: снимок статистики уходит серверу каждые publishInterval событий
+  void attachMetrics(MetricsServer* server, int publishInterval = 1024);
+  void publishMetrics();
+
+  // --- Шард параллельного прогона ---
+  // Вытесненное (Д1ОО4) не теряется, а передается в другой шард: не больше одного перехода на уведомление
+  void enableForwarding(double delay);
+  // Время ближайшего события; +inf - календарь пуст или предел заявок достигнут
+  double getNextEventTime() const;
+  void step(); // Одно событие
+  void runUntil(double bound); // Все события строго раньше bound
+  std::vector<ForwardedNotification>& getOutbox(); // Координатор забирает и очищает
+  void acceptForwarded(const ForwardedNotification& message); // Переданное из другого шарда - в календарь
+
 private:
   void processNextEvent();
-  void runUntilEventType(const std::string& eventType);
+  void scheduleChannelRelease(Channel* channel, double serviceTime);
+  void placeArrival(const Notification& notification); // В свободный канал или в буфер (новое или повтор)
+  void scheduleRetry(); // Вытесненное при последней постановке - в повтор или окончательный отказ
+  void rescaleChannels(); // Событие SCALE: решение контроллера - заказ или снятие каналов
+  void provisionChannel(); // Событие CHAN_UP: новый канал (или снятая ячейка) вводится в работу
+  void bringChannelOnline(); // Ввод в свободную ячейку (она есть)
+  void takeChannelOffline(int channelId);
+  void runUntilEventType(EventType eventType);
   void displayState();
-  void finalizeSimulation(); //    
+  void advance(); // Одно событие + снапшот по интервалу количества событий
+  void recordTimelineSnapshot();
+  void restoreTimelineSnapshot(const TimelineSnapshot& snapshot);
 };
 
 #endif // PUSH_NOTIFICATION_SYSTEM_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+// QuantileHistogram.cpp
+#include "QuantileHistogram.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <bit> // Для std::bit_cast
+#include <cmath> // Для ldexp
+#include <stdexcept>
+
+QuantileHistogram::QuantileHistogram() : counts(), zeroCount(0), count(0), sum(0.0), minPositive(0.0), maxValue(0.0) {}
+
+int QuantileHistogram::bucketOf(double value) {
+  // Порядок (со смещением 1023) и старшие kSubBits разрядов мантиссы - номер октавы и части в ней
+  std::uint64_t bits = std::bit_cast<std::uint64_t>(value);
+  long long index = static_cast<long long>(bits >> (52 - kSubBits)) - (static_cast<long long>(1023 + kMinExponent) << kSubBits);
+  return static_cast<int>(std::clamp<long long>(index, 0, kBucketCount - 1));
+}
+
+double QuantileHistogram::lowerBound(int bucket) {
+  int exponent = kMinExponent + bucket / kSubBuckets;
+  return std::ldexp(1.0 + static_cast<double>(bucket % kSubBuckets) / kSubBuckets, exponent);
+}
+
+void QuantileHistogram::record(double value) {
+  count++;
+  if (!(value > 0)) {
+    zeroCount++;
+    return;
+  }
+  counts[bucketOf(value)]++;
+  sum += value;
+  minPositive = (minPositive > 0) ? std::min(minPositive, value) : value;
+  maxValue = std::max(maxValue, value);
+}
+
+void QuantileHistogram::merge(const QuantileHistogram& other) {
+  for (int i = 0; i < kBucketCount; i++) {
+    counts[i] += other.counts[i];
+  }
+  zeroCount += other.zeroCount;
+  count += other.count;
+  sum += other.sum;
+  if (other.minPositive > 0) {
+    minPositive = (minPositive > 0) ? std::min(minPositive, other.minPositive) : other.minPositive;
+  }
+  maxValue = std::max(maxValue, other.maxValue);
+}
+
+void QuantileHistogram::reset() {
+  *this = QuantileHistogram();
+}
+
+long long QuantileHistogram::getCount() const { return count; }
+double QuantileHistogram::getMean() const { return count > 0 ? sum / count : 0.0; }
+double QuantileHistogram::getMax() const { return maxValue; }
+
+double QuantileHistogram::quantile(double q) const {
+  if (count == 0) {
+    return 0.0;
+  }
+  double rank = std::clamp(q, 0.0, 1.0) * count;
+  if (rank <= zeroCount) {
+    return 0.0;
+  }
+  long long below = zeroCount;
+  for (int i = 0; i < kBucketCount; i++) {
+    if (counts[i] > 0 && below + counts[i] >= rank) {
+      double lower = lowerBound(i);
+      double upper = (i + 1 < kBucketCount) ? lowerBound(i + 1) : lower * 2.0;
+      double value = lower + (upper - lower) * (rank - below) / counts[i];
+      return std::clamp(value, minPositive, maxValue);
+    }
+    below += counts[i];
+  }
+  return maxValue;
+}
+
+void QuantileHistogram::saveState(BinaryWriter& writer) const {
+  writer.writePod(zeroCount);
+  writer.writePod(count);
+  writer.writePod(sum);
+  writer.writePod(minPositive);
+  writer.writePod(maxValue);
+  int first = 0;
+  while (first < kBucketCount && counts[first] == 0) {
+    first++;
+  }
+  int last = kBucketCount;
+  while (last > first && counts[last - 1] == 0) {
+    last--;
+  }
+  writer.writePod(first);
+  writer.writePod(last);
+  writer.writePodArray(counts + first, static_cast<std::size_t>(last - first));
+}
+
+void QuantileHistogram::loadState(BinaryReader& reader) {
+  reset();
+  reader.readPod(zeroCount);
+  reader.readPod(count);
+  reader.readPod(sum);
+  reader.readPod(minPositive);
+  reader.readPod(maxValue);
+  int first = reader.readPod<int>();
+  int last = reader.readPod<int>();
+  if (first < 0 || last < first || last > kBucketCount) {
+    throw std::runtime_error("Поврежденная гистограмма квантилей в контрольной точке");
+  }
+  reader.readPodArray(counts + first, static_cast<std::size_t>(last - first));
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+// QuantileHistogram.h
+#ifndef QUANTILE_HISTOGRAM_H
+#define QUANTILE_HISTOGRAM_H
+
+#include <cstdint>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Гистограмма для квантилей хвоста (p95, p99) с относительной погрешностью не хуже 1/64.
+// Логарифмически-линейные корзины: каждая октава [2^e, 2^(e+1)) делится на 64 равные части,
+// октавы от 2^-16 до 2^24 модельных единиц. Номер корзины - старшие разряды двоичной записи
+// значения, без логарифмов. Нулевые значения (уведомление не ждало) - отдельная корзина, а не
+// размазывание по первой. Значения за пределами октав - в крайних корзинах; квантиль ограничен
+// наблюдавшимися min и max.
+// LatencyHistogram с 16 корзинами остается для экспорта метрик - у Prometheus свои границы
+class QuantileHistogram {
+public:
+  static const int kSubBits = 6;
+  static const int kSubBuckets = 1 << kSubBits;
+  static const int kMinExponent = -16;
+  static const int kMaxExponent = 24;
+  static const int kBucketCount = (kMaxExponent - kMinExponent) * kSubBuckets;
+
+private:
+  long long counts[kBucketCount];
+  long long zeroCount; // Значения <= 0
+  long long count;
+  double sum;
+  double minPositive; // Наименьшее положительное значение
+  double maxValue;
+
+  static int bucketOf(double value);
+  static double lowerBound(int bucket);
+
+public:
+  QuantileHistogram();
+
+  void record(double value);
+  void merge(const QuantileHistogram& other);
+  void reset();
+
+  long long getCount() const;
+  double getMean() const;
+  double getMax() const;
+
+  // Квантиль q (0..1): ранг q * count, линейная интерполяция внутри корзины
+  double quantile(double q) const;
+
+  // Контрольная точка: только занятый диапазон корзин (массив целиком - 20 КБ)
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+#endif // QUANTILE_HISTOGRAM_H
\ No newline at end of file
@@ -0,0 +1,23 @@
+// RandomEngine.cpp
+#include "RandomEngine.h"
+
+RandomEngine::RandomEngine(std::uint64_t seed) : state(), mask(0) {
+  this->seed(seed);
+}
+
+void RandomEngine::seed(std::uint64_t value) {
+  // splitmix64: из любого зерна (в т.ч. 0) - ненулевое, хорошо перемешанное состояние
+  for (auto& word : state) {
+    value += 0x9E3779B97F4A7C15ull;
+    std::uint64_t z = value;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    word = z ^ (z >> 31);
+  }
+}
+
+void RandomEngine::setAntithetic(bool enabled) {
+  mask = enabled ? ~std::uint64_t(0) : 0;
+}
+
+bool RandomEngine::isAntithetic() const { return mask != 0; }
\ No newline at end of file
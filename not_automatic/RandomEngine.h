@@ -0,0 +1,48 @@
+// RandomEngine.h
+#ifndef RANDOM_ENGINE_H
+#define RANDOM_ENGINE_H
+
+#include <cstdint>
+#include <limits>
+
+// Генератор xoshiro256** для источников и каналов: 32 байта состояния против 2.5 КБ у mt19937,
+// поэтому сотни тысяч потоков создаются быстро и помещаются в кэш.
+// Удовлетворяет требованиям UniformRandomBitGenerator - работает со всеми std::*_distribution.
+// Тривиально копируем - пишется в контрольную точку как есть.
+// Антитетический поток выдает дополнение каждого числа (~x): U -> 1 - U во всех распределениях,
+// экспоненциальный интервал -log(1 - U) переходит в -log(U) - пара прогонов с отрицательной корреляцией
+class RandomEngine {
+private:
+  std::uint64_t state[4];
+  std::uint64_t mask; // 0 - обычный поток, все единицы - антитетический
+
+  static std::uint64_t rotl(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+public:
+  using result_type = std::uint64_t;
+
+  explicit RandomEngine(std::uint64_t seed = 0);
+
+  void seed(std::uint64_t value); // Состояние разворачивается из зерна через splitmix64 (режим потока не меняется)
+  void setAntithetic(bool enabled);
+  bool isAntithetic() const;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()() {
+    const std::uint64_t result = rotl(state[1] * 5, 7) * 9;
+    const std::uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+    return result ^ mask;
+  }
+};
+
+#endif // RANDOM_ENGINE_H
\ No newline at end of file
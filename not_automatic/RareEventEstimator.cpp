@@ -0,0 +1,184 @@
+// RareEventEstimator.cpp
+#include "RareEventEstimator.h"
+#include "PushNotificationSystem.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+  // Одна основная траектория с повторами. Повторы - рекурсия в глубину: клон состояния
+  // на каждом уровне хранится только пока идут его повторы
+  class SplittingRun {
+  private:
+    PushNotificationSystem& system;
+    const std::vector<int>& thresholds;
+    const std::vector<int>& factors;
+    std::vector<double> weights; // Вес отказа в области k: 1 / (R1 * ... * Rk)
+    RandomEngine cloneSeeds; // Зерна потоков повторов: без них клон повторил бы будущее исходной
+
+  public:
+    double weightedRejections;
+    long long events;
+    long long clones;
+
+    SplittingRun(PushNotificationSystem& system, const std::vector<int>& thresholds, const std::vector<int>& factors, unsigned seed)
+      : system(system), thresholds(thresholds), factors(factors), weights(thresholds.size() + 1, 1.0),
+      cloneSeeds(PushNotificationSystem::streamSeed(seed, 7, 0)), weightedRejections(0.0), events(0), clones(0) {
+      for (std::size_t k = 1; k < weights.size(); k++) {
+        weights[k] = weights[k - 1] / factors[k - 1];
+      }
+    }
+
+    int regionOf(int occupancy) const {
+      return static_cast<int>(std::upper_bound(thresholds.begin(), thresholds.end(), occupancy) - thresholds.begin());
+    }
+
+    // Траектория уровня level: 0 - основная (до предела заявок), i > 0 - повтор, гибнет при спуске ниже Li.
+    // Подъем через несколько порогов сразу - расщепление на каждом по очереди
+    void trial(int level) {
+      int region = level;
+      for (;;) {
+        int current = regionOf(system.getBufferOccupancy());
+        if (current < level) {
+          return;
+        }
+        while (region < current) {
+          region++;
+          split(region);
+        }
+        region = current;
+        if (system.getNextEventTime() == std::numeric_limits<double>::infinity()) {
+          return;
+        }
+        long long rejectedBefore = system.getDatabase().getRejectedCount();
+        system.step();
+        events++;
+        weightedRejections += (system.getDatabase().getRejectedCount() - rejectedBefore) * weights[region];
+      }
+    }
+
+    // Ri - 1 повторов от текущего состояния, затем состояние восстанавливается
+    void split(int level) {
+      BinaryWriter snapshot;
+      system.saveState(snapshot, false);
+      for (int r = 1; r < factors[level - 1]; r++) {
+        BinaryReader reader(snapshot.getData().data(), snapshot.getData().size());
+        system.loadState(reader, false);
+        system.reseedStreams(static_cast<unsigned>(cloneSeeds()));
+        clones++;
+        trial(level);
+      }
+      BinaryReader reader(snapshot.getData().data(), snapshot.getData().size());
+      system.loadState(reader, false);
+    }
+  };
+
+}
+
+SplittingResult estimateRejectionBySplitting(const SimulationConfig& config, const SplittingSpec& spec) {
+  SplittingResult result{};
+  result.thresholds = spec.thresholds;
+  if (result.thresholds.empty()) {
+    int levels = std::min(config.bufferCapacity, 4);
+    for (int i = 1; i <= levels; i++) {
+      result.thresholds.push_back((config.bufferCapacity * i + levels - 1) / levels);
+    }
+  }
+  for (std::size_t i = 0; i < result.thresholds.size(); i++) {
+    if (result.thresholds[i] < 1 || result.thresholds[i] > config.bufferCapacity ||
+      (i > 0 && result.thresholds[i] <= result.thresholds[i - 1])) {
+      throw std::invalid_argument("Пороги расщепления: возрастают, от 1 до емкости буфера");
+    }
+  }
+  result.factors = spec.factors;
+  if (result.factors.empty()) {
+    result.factors.push_back(4);
+  }
+  if (result.factors.size() == 1) {
+    result.factors.resize(result.thresholds.size(), result.factors[0]);
+  }
+  if (result.factors.size() != result.thresholds.size() ||
+    std::any_of(result.factors.begin(), result.factors.end(), [](int r) { return r < 1; })) {
+    throw std::invalid_argument("Кратности расщепления: по одной (>= 1) на каждый порог");
+  }
+  result.replications = std::max(1, spec.replications);
+
+  std::vector<double> estimates;
+  for (int replication = 0; replication < result.replications; replication++) {
+    SimulationConfig run = config;
+    run.seed = config.seed + static_cast<unsigned>(replication);
+    run.snapshotInterval = 0; // Клоны без рядов графиков
+    PushNotificationSystem system(run);
+    system.setVerbose(false);
+
+    SplittingRun splitting(system, result.thresholds, result.factors, run.seed);
+    splitting.trial(0);
+
+    const Database& database = system.getDatabase();
+    long long arrivals = database.getGeneratedCount();
+    estimates.push_back(arrivals > 0 ? splitting.weightedRejections / arrivals : 0.0);
+    result.events += splitting.events;
+    result.clones += splitting.clones;
+    result.arrivals += arrivals;
+    result.bruteRejections += database.getRejectedCount();
+    result.bruteEvents += system.getProcessedEvents();
+  }
+
+  for (double value : estimates) {
+    result.estimate += value / estimates.size();
+  }
+  double variance = 0.0;
+  for (double value : estimates) {
+    variance += (value - result.estimate) * (value - result.estimate);
+  }
+  variance = estimates.size() > 1 ? variance / (estimates.size() - 1) : 0.0;
+  result.relativeError = result.estimate > 0 ? std::sqrt(variance / estimates.size()) / result.estimate : 0.0;
+  return result;
+}
+
+void runSplittingReport(const SimulationConfig& config, const SplittingSpec& spec) {
+  auto start = std::chrono::steady_clock::now();
+  SplittingResult result = estimateRejectionBySplitting(config, spec);
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "===== Расщепление (RESTART) по заполнению буфера =====\n";
+  std::cout << "Буфер: " << config.bufferCapacity << ", заявок на траекторию: " << config.maxNotifications
+    << ", реплик: " << result.replications << "\nПороги / кратности:";
+  for (std::size_t i = 0; i < result.thresholds.size(); i++) {
+    std::cout << " " << result.thresholds[i] << "/" << result.factors[i];
+  }
+  std::cout << "\n";
+
+  std::cout << std::scientific << std::setprecision(4);
+  std::cout << "p_отк (расщепление): " << result.estimate << ", относительная погрешность " << std::fixed
+    << std::setprecision(4) << result.relativeError << "\n";
+  double brute = result.arrivals > 0 ? static_cast<double>(result.bruteRejections) / result.arrivals : 0.0;
+  std::cout << std::scientific << std::setprecision(4) << "p_отк (прямо, те же основные траектории): " << brute
+    << " (" << result.bruteRejections << " отказов на " << result.arrivals << " поступлений)\n";
+  std::cout << std::fixed << std::setprecision(3) << "Событий: " << result.events << " (основные " << result.bruteEvents
+    << ", повторов " << result.clones << "), " << seconds << " с\n";
+
+  // Прямому методу для той же погрешности нужно (1 - p) / (p * RE^2) поступлений
+  if (result.estimate > 0 && result.relativeError > 0 && result.arrivals > 0) {
+    double eventsPerArrival = static_cast<double>(result.bruteEvents) / result.arrivals;
+    double bruteArrivals = (1.0 - result.estimate) / (result.estimate * result.relativeError * result.relativeError);
+    double bruteEvents = bruteArrivals * eventsPerArrival;
+    // Скорость прямого прогона - по одной траектории без расщепления (клоны стоят дороже событий)
+    SimulationConfig plain = config;
+    plain.snapshotInterval = 0;
+    PushNotificationSystem system(plain);
+    auto plainStart = std::chrono::steady_clock::now();
+    system.runHeadless();
+    double eventsPerSecond = system.getProcessedEvents() / std::chrono::duration<double>(std::chrono::steady_clock::now() - plainStart).count();
+    std::cout << std::scientific << std::setprecision(3) << "Прямому моделированию для той же погрешности нужно около "
+      << bruteEvents << " событий - в " << std::fixed << std::setprecision(1) << bruteEvents / result.events
+      << " раз больше, по времени около " << bruteEvents / eventsPerSecond << " с - в "
+      << bruteEvents / eventsPerSecond / seconds << " раз дольше\n";
+  }
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+// RareEventEstimator.h
+#ifndef RARE_EVENT_ESTIMATOR_H
+#define RARE_EVENT_ESTIMATOR_H
+
+#include "SimulationConfig.h"
+#include <vector>
+
+// Многоуровневое расщепление (RESTART) для малых p_отк. Функция важности - заполнение буфера.
+// Пороги L1 < L2 < ... < Lm делят ее на области 0..m. При подъеме через Li состояние модели
+// клонируется: запускается Ri - 1 повторов, каждый живет до спуска ниже Li, исходная траектория
+// идет дальше. Отказ в области k учитывается с весом 1 / (R1 * ... * Rk), знаменатель - поступления
+// основной траектории. Оценка несмещенная; основная траектория после повторов восстанавливается
+// из клона и совпадает с обычным прогоном - по ней же считается прямая оценка для сравнения
+struct SplittingSpec {
+  std::vector<int> thresholds; // Пустой - равномерно до полного буфера (не больше 4 порогов)
+  std::vector<int> factors; // Ri по порогам; одно значение - для всех, пусто - 4
+  int replications = 10; // Независимые основные траектории (зерна seed, seed+1, ...) - для погрешности
+};
+
+struct SplittingResult {
+  std::vector<int> thresholds;
+  std::vector<int> factors;
+  int replications;
+  double estimate; // Среднее оценок расщепления по репликам
+  double relativeError; // Стандартная ошибка среднего / среднее
+  long long events; // Событий всего, вместе с повторами
+  long long clones; // Запущенных повторов
+  long long arrivals; // Поступлений основных траекторий
+  long long bruteRejections; // Отказов основных траекторий (прямой метод на том же прогоне)
+  long long bruteEvents; // Событий основных траекторий
+};
+
+SplittingResult estimateRejectionBySplitting(const SimulationConfig& config, const SplittingSpec& spec);
+
+// Оценка, ее погрешность и сравнение трудоемкости с прямым моделированием
+// для одинаковой относительной погрешности
+void runSplittingReport(const SimulationConfig& config, const SplittingSpec& spec);
+
+#endif // RARE_EVENT_ESTIMATOR_H
\ No newline at end of file
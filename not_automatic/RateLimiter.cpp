@@ -0,0 +1,26 @@
+// RateLimiter.cpp
+#include "RateLimiter.h"
+#include "Checkpoint.h"
+
+RateLimiter::RateLimiter(const std::vector<double>& rateBySource, const std::vector<double>& burstBySource)
+  : buckets(rateBySource.size(), Bucket{ 0.0, 1.0, 1.0, 0.0 }), enabled(false) {
+  for (std::size_t i = 0; i < rateBySource.size(); i++) {
+    if (rateBySource[i] > 0) {
+      double burst = (i < burstBySource.size() && burstBySource[i] >= 1.0) ? burstBySource[i] : 1.0;
+      buckets[i] = Bucket{ rateBySource[i], burst, burst, 0.0 }; // Прогон начинается с полной корзиной
+      enabled = true;
+    }
+  }
+}
+
+bool RateLimiter::isEnabled() const { return enabled; }
+
+void RateLimiter::saveState(BinaryWriter& writer) const {
+  writer.writePodVector(buckets);
+  writer.writePod(enabled);
+}
+
+void RateLimiter::loadState(BinaryReader& reader) {
+  reader.readPodVector(buckets);
+  reader.readPod(enabled);
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+// RateLimiter.h
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <algorithm> // Для std::min
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Ограничение интенсивности на входе: маркерная корзина на источник.
+// Корзины - плоский массив по номеру источника (одна строка кэша на проверку).
+// Пополнение ленивое - при поступлении: tokens += rate * (now - last), не больше burst.
+// Таймеров и событий в календаре нет
+class RateLimiter {
+private:
+  struct Bucket {
+    double rate; // Маркеров в единицу времени, 0 - источник не ограничен
+    double burst; // Емкость корзины
+    double tokens;
+    double lastRefill;
+  };
+  std::vector<Bucket> buckets; // Индекс = номер источника
+  bool enabled;
+
+public:
+  // rateBySource, burstBySource - индекс = номер источника; пустые - ограничения нет
+  RateLimiter(const std::vector<double>& rateBySource = {}, const std::vector<double>& burstBySource = {});
+
+  bool isEnabled() const;
+
+  // Пропустить ли поступление источника в момент now; пропущенное расходует маркер
+  bool admit(int sourceId, double now) {
+    Bucket& bucket = buckets[sourceId];
+    if (bucket.rate <= 0) {
+      return true;
+    }
+    bucket.tokens = std::min(bucket.burst, bucket.tokens + (now - bucket.lastRefill) * bucket.rate);
+    bucket.lastRefill = now;
+    if (bucket.tokens < 1.0) {
+      return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+  }
+
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+#endif // RATE_LIMITER_H
\ No newline at end of file
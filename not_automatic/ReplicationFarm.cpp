@@ -0,0 +1,417 @@
+// ReplicationFarm.cpp
+#include "ReplicationFarm.h"
+#include "PushNotificationSystem.h"
+#include "Checkpoint.h"
+#include "SocketAddress.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+  // Кадр: тип (unsigned), длина (unsigned long long), затем тело из BinaryWriter
+  enum FrameType : unsigned {
+    WORK = 1, // Координатор -> рабочий: реплика, зерно, текст сценария
+    RESULT = 2, // Рабочий -> координатор: реплика, модельное время, событий, секунд, накопители Database
+    STOP = 3 // Координатор -> рабочий: работы больше нет
+  };
+
+  // Длина тела берется у другой стороны: больше этого - поврежденный или чужой поток, а не кадр.
+  // Накопители Database для сотен тысяч источников - десятки мегабайт
+  const unsigned long long kMaxFrameBytes = 1ULL << 30;
+
+  struct WorkUnit {
+    int replication;
+    unsigned seed;
+  };
+
+#ifndef _WIN32
+  bool sendAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+      ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+      if (written <= 0) {
+        return false;
+      }
+      data += written;
+      size -= static_cast<std::size_t>(written);
+    }
+    return true;
+  }
+
+  bool receiveAll(int fd, char* data, std::size_t size) {
+    while (size > 0) {
+      ssize_t received = ::recv(fd, data, size, 0);
+      if (received <= 0) {
+        return false;
+      }
+      data += received;
+      size -= static_cast<std::size_t>(received);
+    }
+    return true;
+  }
+
+  bool sendFrame(int fd, FrameType type, const std::vector<char>& body) {
+    BinaryWriter header;
+    header.writePod(static_cast<unsigned>(type));
+    header.writePod<unsigned long long>(body.size());
+    return sendAll(fd, header.getData().data(), header.getData().size()) && sendAll(fd, body.data(), body.size());
+  }
+
+  // false - соединение закрыто, оборвано или кадр длиннее kMaxFrameBytes
+  bool receiveFrame(int fd, unsigned& type, std::vector<char>& body) {
+    char header[sizeof(unsigned) + sizeof(unsigned long long)];
+    if (!receiveAll(fd, header, sizeof(header))) {
+      return false;
+    }
+    BinaryReader reader(header, sizeof(header));
+    type = reader.readPod<unsigned>();
+    unsigned long long length = reader.readPod<unsigned long long>();
+    if (length > kMaxFrameBytes) {
+      return false;
+    }
+    body.resize(static_cast<std::size_t>(length));
+    return receiveAll(fd, body.data(), body.size());
+  }
+#endif
+
+  std::string readText(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("Не удалось открыть сценарий: " + path);
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return text.str();
+  }
+
+}
+
+int runFarmWorker(const std::string& address) {
+#ifdef _WIN32
+  throw std::runtime_error("Ферма реплик доступна только на POSIX-системах");
+#else
+  // Координатор мог еще не открыть сокет - несколько попыток подключения
+  int fd = -1;
+  for (int attempt = 0; attempt < 50 && fd < 0; attempt++) {
+    fd = openStreamSocket(address, false);
+    if (fd < 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+  if (fd < 0) {
+    throw std::runtime_error("Не удалось подключиться к координатору: " + address);
+  }
+
+  int completed = 0;
+  unsigned type = 0;
+  std::vector<char> body;
+  while (receiveFrame(fd, type, body) && type == WORK) {
+    BinaryReader reader(body.data(), body.size());
+    int replication = reader.readPod<int>();
+    unsigned seed = reader.readPod<unsigned>();
+    std::istringstream text(reader.readString());
+
+    auto start = std::chrono::steady_clock::now();
+    SimulationConfig config = SimulationConfig::fromStream(text, "<сценарий координатора>");
+    config.seed = seed;
+    config.snapshotInterval = 0; // Ряды графиков не сливаются - не снимаем
+    PushNotificationSystem system(config);
+    system.runHeadless();
+
+    BinaryWriter result;
+    result.writePod(replication);
+    result.writePod(system.getCurrentTime());
+    result.writePod(system.getProcessedEvents());
+    result.writePod(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    system.getDatabase().saveState(result, false);
+    if (!sendFrame(fd, RESULT, result.getData())) {
+      break; // Координатор пропал - реплика будет выполнена заново другим рабочим
+    }
+    completed++;
+  }
+  ::close(fd);
+  return completed;
+#endif
+}
+
+int runFarmCoordinator(const FarmSpec& spec) {
+#ifdef _WIN32
+  throw std::runtime_error("Ферма реплик доступна только на POSIX-системах");
+#else
+  std::string scenario = readText(spec.scenarioPath);
+  std::istringstream check(scenario);
+  SimulationConfig config = SimulationConfig::fromStream(check, spec.scenarioPath); // Ошибки сценария - до запуска рабочих
+
+  int listenFd = openStreamSocket(spec.address, true);
+  if (listenFd < 0) {
+    throw std::runtime_error("Не удалось открыть адрес координатора: " + spec.address);
+  }
+
+  std::vector<pid_t> localPids;
+  for (int i = 0; i < spec.localWorkers; i++) {
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(listenFd);
+      ::execl(spec.workerProgram.c_str(), spec.workerProgram.c_str(), "--farm-worker", spec.address.c_str(), static_cast<char*>(nullptr));
+      ::_exit(127);
+    }
+    if (pid > 0) {
+      localPids.push_back(pid);
+    }
+  }
+
+  std::cout << "===== Ферма реплик =====\n";
+  std::cout << "Сценарий: " << spec.scenarioPath << ", реплик: " << spec.replications << ", зерна " << spec.seed
+    << ".." << spec.seed + spec.replications - 1 << ", адрес: " << spec.address
+    << ", локальных рабочих: " << spec.localWorkers << std::endl;
+
+  std::deque<WorkUnit> pending;
+  for (int r = 0; r < spec.replications; r++) {
+    pending.push_back({ r, spec.seed + static_cast<unsigned>(r) });
+  }
+  std::vector<char> done(spec.replications, 0);
+
+  // Подключенные рабочие: у каждого не больше одной выданной реплики (-1 - ждет работы)
+  struct Worker {
+    int fd;
+    WorkUnit unit;
+    std::chrono::steady_clock::time_point issued; // Когда выдана реплика - для workerTimeout
+  };
+  std::vector<Worker> workers;
+
+  Database merged;
+  bool anyMerged = false;
+  double totalModelTime = 0.0;
+  long long totalEvents = 0;
+  double busySeconds = 0.0;
+  std::vector<double> rejectionRates; // p_отк каждой реплики - для доверительного интервала
+  int completed = 0;
+  int reissued = 0;
+  int peakWorkers = 0;
+
+  auto assign = [&](Worker& worker) {
+    worker.unit = { -1, 0 };
+    if (pending.empty()) {
+      return true; // Ждет: работа упавших рабочих может вернуться в очередь
+    }
+    BinaryWriter work;
+    work.writePod(pending.front().replication);
+    work.writePod(pending.front().seed);
+    work.writeString(scenario);
+    if (!sendFrame(worker.fd, WORK, work.getData())) {
+      return false;
+    }
+    worker.unit = pending.front();
+    worker.issued = std::chrono::steady_clock::now();
+    pending.pop_front();
+    return true;
+  };
+
+  // Завершившиеся локальные рабочие - без зомби и без учета в живых
+  auto reapLocal = [&]() {
+    for (std::size_t i = 0; i < localPids.size();) {
+      if (::waitpid(localPids[i], nullptr, WNOHANG) != 0) {
+        localPids[i] = localPids.back();
+        localPids.pop_back();
+      }
+      else {
+        i++;
+      }
+    }
+  };
+
+  // Остановить рабочих и закрыть адрес. Локальные после STOP выходят сами; отключенные по
+  // таймауту (зависшие) команду не получат - их через несколько секунд снимаем сигналом
+  auto stopFarm = [&]() {
+    for (const auto& worker : workers) {
+      sendFrame(worker.fd, STOP, {});
+      ::close(worker.fd);
+    }
+    workers.clear();
+    ::close(listenFd);
+    if (!unixSocketPath(spec.address).empty()) {
+      ::unlink(unixSocketPath(spec.address).c_str());
+    }
+    for (int attempt = 0; attempt < 50 && !localPids.empty(); attempt++) {
+      reapLocal();
+      if (!localPids.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+    }
+    for (pid_t pid : localPids) {
+      ::kill(pid, SIGKILL);
+      ::waitpid(pid, nullptr, 0);
+    }
+    localPids.clear();
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  auto lastConnected = start; // Последний момент, когда был подключен хоть один рабочий
+  while (completed < spec.replications) {
+    reapLocal();
+    auto now = std::chrono::steady_clock::now();
+    // Зависший рабочий держит соединение, но не отвечает: отключаем, реплику - снова в очередь
+    std::vector<Worker> responsive;
+    for (const auto& worker : workers) {
+      if (worker.unit.replication >= 0 && std::chrono::duration<double>(now - worker.issued).count() > spec.workerTimeout) {
+        ::close(worker.fd);
+        pending.push_front(worker.unit);
+        reissued++;
+        std::cout << "Рабочий не вернул реплику " << worker.unit.replication << " за " << spec.workerTimeout
+          << " с и отключен, реплика выдана заново" << std::endl;
+        continue;
+      }
+      responsive.push_back(worker);
+    }
+    workers.swap(responsive);
+    // Вернувшаяся в очередь работа - ожидающим рабочим (не отправилось - отключение заметит poll)
+    for (auto& worker : workers) {
+      if (worker.unit.replication < 0 && !pending.empty()) {
+        assign(worker);
+      }
+    }
+
+    // Работа есть, а выполнять некому - ждать бесполезно
+    if (!workers.empty()) {
+      lastConnected = now;
+    }
+    else if (spec.localWorkers > 0 && localPids.empty()) {
+      stopFarm();
+      throw std::runtime_error("Все локальные рабочие завершились, подключенных нет; выполнено реплик "
+        + std::to_string(completed) + " из " + std::to_string(spec.replications) + " (программа рабочих: " + spec.workerProgram + ")");
+    }
+    else if (std::chrono::duration<double>(now - lastConnected).count() > spec.idleTimeout) {
+      stopFarm();
+      throw std::runtime_error("Ни одного подключенного рабочего " + std::to_string(static_cast<int>(spec.idleTimeout))
+        + " с; выполнено реплик " + std::to_string(completed) + " из " + std::to_string(spec.replications));
+    }
+
+    std::vector<pollfd> waitFor;
+    waitFor.push_back({ listenFd, POLLIN, 0 });
+    for (const auto& worker : workers) {
+      waitFor.push_back({ worker.fd, POLLIN, 0 });
+    }
+    if (::poll(waitFor.data(), waitFor.size(), 1000) <= 0) {
+      continue;
+    }
+
+    std::vector<Worker> alive;
+    for (std::size_t i = 0; i < workers.size(); i++) {
+      Worker worker = workers[i];
+      if (waitFor[i + 1].revents == 0) {
+        alive.push_back(worker);
+        continue;
+      }
+      unsigned type = 0;
+      std::vector<char> body;
+      bool ok = receiveFrame(worker.fd, type, body) && type == RESULT;
+      if (ok) {
+        // Обрезанный, испорченный или чужой (другой сценарий) результат - как отключение рабочего.
+        // merge проверяет совместимость до изменений, поэтому сводная статистика не страдает
+        try {
+          BinaryReader reader(body.data(), body.size());
+          int replication = reader.readPod<int>();
+          double modelTime = reader.readPod<double>();
+          long long events = reader.readPod<long long>();
+          double seconds = reader.readPod<double>();
+          Database result;
+          result.loadState(reader, false);
+          if (replication >= 0 && replication < spec.replications && !done[replication]) {
+            if (anyMerged) {
+              merged.merge(result);
+            }
+            else {
+              merged = result;
+              anyMerged = true;
+            }
+            done[replication] = 1;
+            completed++;
+            totalModelTime += modelTime;
+            totalEvents += events;
+            busySeconds += seconds;
+            rejectionRates.push_back(result.getRejectionRate());
+          }
+        }
+        catch (const std::exception& error) {
+          std::cout << "Результат рабочего не принят: " << error.what() << std::endl;
+          ok = false;
+        }
+        ok = ok && assign(worker);
+      }
+      if (ok) {
+        alive.push_back(worker);
+        continue;
+      }
+      // Рабочий отключился: его реплика - снова в очередь, первой
+      ::close(worker.fd);
+      if (worker.unit.replication >= 0 && !done[worker.unit.replication]) {
+        pending.push_front(worker.unit);
+        reissued++;
+        std::cout << "Рабочий отключился, реплика " << worker.unit.replication << " выдана заново" << std::endl;
+      }
+    }
+    workers.swap(alive);
+
+    if (waitFor[0].revents & POLLIN) {
+      int client = ::accept(listenFd, nullptr, nullptr);
+      if (client >= 0) {
+        workers.push_back({ client, { -1, 0 }, std::chrono::steady_clock::now() });
+        if (!assign(workers.back())) {
+          ::close(client);
+          workers.pop_back();
+        }
+      }
+    }
+    peakWorkers = std::max(peakWorkers, static_cast<int>(workers.size()));
+  }
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  stopFarm();
+
+  // Итог: объединенная статистика и разброс p_отк между репликами
+  double mean = 0.0;
+  for (double rate : rejectionRates) {
+    mean += rate / rejectionRates.size();
+  }
+  double variance = 0.0;
+  for (double rate : rejectionRates) {
+    variance += (rate - mean) * (rate - mean);
+  }
+  variance = rejectionRates.size() > 1 ? variance / (rejectionRates.size() - 1) : 0.0;
+  double halfWidth = rejectionRates.size() > 1 ? 1.96 * std::sqrt(variance / rejectionRates.size()) : 0.0;
+
+  double loadMean = 0.0;
+  for (const auto& channel : config.channels) {
+    loadMean += merged.getChannelUtilization(channel.id, totalModelTime) / config.channels.size();
+  }
+
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "Выполнено реплик: " << completed << " за " << wallSeconds << " с (" << completed / wallSeconds
+    << " в секунду, событий " << totalEvents / wallSeconds << " в секунду), рабочих одновременно до " << peakWorkers
+    << ", выдано заново " << reissued << "\n";
+  std::cout << "Занятость рабочих: " << busySeconds / wallSeconds << " (сумма времени прогонов / время фермы)\n";
+  std::cout << std::setprecision(5);
+  std::cout << "p_отк по репликам: " << mean << " +- " << halfWidth << " (95%), объединенная " << merged.getRejectionRate() << "\n";
+  std::cout << "Доставлено: " << merged.getDeliveredCount() << ", вытеснено: " << merged.getRejectedCount()
+    << ", T_ож = " << merged.getAvgWaitTime() << ", T_преб = " << merged.getAvgSystemTime()
+    << ", T_ож p99 = " << merged.getWaitHistogram().quantile(0.99)
+    << ", T_отклика p99 = " << merged.getResponseHistogram().quantile(0.99) << ", загрузка каналов " << loadMean << "\n";
+  return completed;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+// ReplicationFarm.h
+#ifndef REPLICATION_FARM_H
+#define REPLICATION_FARM_H
+
+#include <string>
+
+// Ферма реплик из нескольких процессов (и машин). Координатор раздает единицы работы
+// (сценарий, зерно, номер реплики) рабочим по сокету, рабочий прогоняет модель без вывода
+// и возвращает накопители Database; координатор сливает их по мере поступления.
+// Работа отключившегося (упавшего) рабочего возвращается в очередь и отдается другому,
+// как и работа рабочего, не ответившего за workerTimeout (он отключается).
+// Адрес - как у сервера метрик: "порт", "хост:порт" или "unix:/путь/к/сокету"
+struct FarmSpec {
+  std::string address = "unix:/tmp/notifyme-farm.sock";
+  std::string scenarioPath; // Текст сценария уходит рабочим целиком - общий диск не нужен
+  int replications = 100;
+  unsigned seed = 17; // Реплика r прогоняется с зерном seed + r
+  int localWorkers = 0; // Запустить столько рабочих процессов на этой машине
+  std::string workerProgram; // Программа для локальных рабочих (argv[0])
+  double workerTimeout = 600.0; // Секунд на одну реплику у подключенного рабочего
+  double idleTimeout = 300.0; // Секунд без подключенных рабочих при невыполненной работе - ошибка
+};
+
+// Координатор: возвращает число выполненных реплик (все - spec.replications).
+// Исключение, если работа осталась, а рабочих нет: все локальные завершились и никто не подключен
+// или ни одного подключенного дольше idleTimeout
+int runFarmCoordinator(const FarmSpec& spec);
+
+// Рабочий: подключается к координатору и выполняет реплики до команды завершения.
+// Возвращает число выполненных реплик
+int runFarmWorker(const std::string& address);
+
+#endif // REPLICATION_FARM_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+// RetryPool.cpp
+#include "RetryPool.h"
+#include "Checkpoint.h"
+
+RetryPool::RetryPool(int capacity, bool growable) : slots(capacity), growable(growable), peakInUse(0), overflows(0) {
+  freeSlots.reserve(capacity);
+  for (int i = capacity - 1; i >= 0; i--) {
+    freeSlots.push_back(i); // Первой выдается ячейка 0
+  }
+}
+
+int RetryPool::acquire(const Notification& notification) {
+  if (freeSlots.empty() && growable) {
+    freeSlots.push_back(static_cast<int>(slots.size()));
+    slots.emplace_back();
+  }
+  if (freeSlots.empty()) {
+    overflows++;
+    return -1;
+  }
+  int slot = freeSlots.back();
+  freeSlots.pop_back();
+  slots[slot] = notification;
+  if (getInUse() > peakInUse) {
+    peakInUse = getInUse();
+  }
+  return slot;
+}
+
+Notification RetryPool::release(int slot) {
+  freeSlots.push_back(slot); // Емкость стека зарезервирована - без выделения
+  return slots[slot];
+}
+
+int RetryPool::getCapacity() const { return static_cast<int>(slots.size()); }
+int RetryPool::getInUse() const { return static_cast<int>(slots.size() - freeSlots.size()); }
+int RetryPool::getPeakInUse() const { return peakInUse; }
+long long RetryPool::getOverflows() const { return overflows; }
+
+void RetryPool::saveState(BinaryWriter& writer) const {
+  writer.writePod<unsigned long long>(slots.size());
+  for (const auto& notification : slots) {
+    notification.saveState(writer);
+  }
+  writer.writePodVector(freeSlots);
+  writer.writePod(peakInUse);
+  writer.writePod(overflows);
+}
+
+void RetryPool::loadState(BinaryReader& reader) {
+  slots.resize(static_cast<std::size_t>(reader.readPod<unsigned long long>()));
+  for (auto& notification : slots) {
+    notification.loadState(reader);
+  }
+  reader.readPodVector(freeSlots);
+  freeSlots.reserve(slots.size());
+  reader.readPod(peakInUse);
+  reader.readPod(overflows);
+}
\ No newline at end of file
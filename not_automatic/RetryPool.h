@@ -0,0 +1,39 @@
+// RetryPool.h
+#ifndef RETRY_POOL_H
+#define RETRY_POOL_H
+
+#include "Notification.h"
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Пул ожидающих повторов: уведомления лежат в заранее выделенных ячейках,
+// событие RETRY в календаре несет номер ячейки. Свободные ячейки - стек номеров:
+// взять и вернуть - O(1) без выделения памяти, как бы ни разрастался шторм повторов.
+// Растущий пул (growable) при нехватке добавляет ячейку - для приема из других шардов,
+// где отказ по переполнению пула зависел бы от момента доставки, а не от модели
+class RetryPool {
+private:
+  std::vector<Notification> slots;
+  std::vector<int> freeSlots; // Стек свободных ячеек
+  bool growable;
+  int peakInUse; // Наибольшее число одновременно ожидающих повторов
+  long long overflows; // Повторов, не поместившихся в пул
+
+public:
+  explicit RetryPool(int capacity = 0, bool growable = false);
+
+  int acquire(const Notification& notification); // Номер ячейки, -1 - пул заполнен
+  Notification release(int slot); // Забрать уведомление и освободить ячейку
+
+  int getCapacity() const;
+  int getInUse() const;
+  int getPeakInUse() const;
+  long long getOverflows() const;
+
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+#endif // RETRY_POOL_H
\ No newline at end of file
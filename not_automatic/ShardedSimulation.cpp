@@ -0,0 +1,218 @@
+// ShardedSimulation.cpp
+#include "ShardedSimulation.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace {
+
+  // Доля value на count частей с округлением вверх, не меньше 1
+  int shareOf(int value, int count) {
+    return std::max(1, (value + count - 1) / count);
+  }
+
+}
+
+ShardedSimulation::ShardedSimulation(const SimulationConfig& config, int shardCount, double forwardDelay)
+  : shards(), forwardDelay(forwardDelay), windows(0) {
+  int limit = static_cast<int>(std::min(config.sources.size(), config.channels.size()));
+  shardCount = std::clamp(shardCount, 1, std::max(1, limit));
+  shards.reserve(shardCount);
+  for (int shard = 0; shard < shardCount; shard++) {
+    shards.push_back(std::make_unique<PushNotificationSystem>(shardConfig(config, shard, shardCount)));
+    shards.back()->setVerbose(false);
+    if (shardCount > 1) {
+      shards.back()->enableForwarding(forwardDelay);
+    }
+  }
+}
+
+SimulationConfig ShardedSimulation::shardConfig(const SimulationConfig& config, int shard, int shardCount) {
+  if (shardCount <= 1) {
+    return config; // Один шард - исходный сценарий без изменений
+  }
+  SimulationConfig part = config;
+
+  part.sources.clear();
+  std::size_t first = config.sources.size() * shard / shardCount;
+  std::size_t last = config.sources.size() * (shard + 1) / shardCount;
+  double totalLambda = 0.0;
+  double partLambda = 0.0;
+  for (std::size_t i = 0; i < config.sources.size(); i++) {
+    totalLambda += config.sources[i].lambda;
+    if (i >= first && i < last) {
+      part.sources.push_back(config.sources[i]);
+      part.sources.back().id = static_cast<int>(part.sources.size());
+      partLambda += config.sources[i].lambda;
+    }
+  }
+
+  part.channels.clear();
+  first = config.channels.size() * shard / shardCount;
+  last = config.channels.size() * (shard + 1) / shardCount;
+  for (std::size_t i = first; i < last; i++) {
+    part.channels.push_back(config.channels[i]);
+    part.channels.back().id = static_cast<int>(part.channels.size());
+  }
+
+  part.bufferCapacity = shareOf(config.bufferCapacity, shardCount);
+  double share = totalLambda > 0 ? partLambda / totalLambda : 1.0 / shardCount;
+  part.maxNotifications = std::max(1LL, std::llround(config.maxNotifications * share));
+  part.seed = PushNotificationSystem::streamSeed(config.seed, 6, shard);
+  if (config.retry.poolSize > 0) {
+    part.retry.poolSize = shareOf(config.retry.poolSize, shardCount);
+  }
+  part.autoscale.minChannels = shareOf(config.autoscale.minChannels, shardCount);
+  if (config.autoscale.maxChannels > 0) {
+    part.autoscale.maxChannels = std::max(part.autoscale.minChannels, shareOf(config.autoscale.maxChannels, shardCount));
+  }
+  return part;
+}
+
+void ShardedSimulation::deliver(int shard) {
+  std::vector<ForwardedNotification>& outbox = shards[shard]->getOutbox();
+  PushNotificationSystem& target = *shards[(shard + 1) % shards.size()];
+  for (const auto& message : outbox) {
+    target.acceptForwarded(message);
+  }
+  outbox.clear();
+}
+
+double ShardedSimulation::getNextEventTime() const {
+  double next = std::numeric_limits<double>::infinity();
+  for (const auto& shard : shards) {
+    next = std::min(next, shard->getNextEventTime());
+  }
+  return next;
+}
+
+void ShardedSimulation::runSequential() {
+  for (;;) {
+    int next = -1;
+    double nextTime = std::numeric_limits<double>::infinity();
+    for (int shard = 0; shard < getShardCount(); shard++) {
+      double time = shards[shard]->getNextEventTime();
+      if (time < nextTime) {
+        nextTime = time;
+        next = shard;
+      }
+    }
+    if (next < 0) {
+      return;
+    }
+    shards[next]->step();
+    deliver(next);
+  }
+}
+
+void ShardedSimulation::runParallel() {
+  windows = 0;
+  // Один шард ни с кем не обменивается - окно на весь прогон
+  double lookahead = getShardCount() > 1 ? forwardDelay : std::numeric_limits<double>::infinity();
+  double next = getNextEventTime();
+  double bound = next + lookahead;
+  bool done = std::isinf(next);
+
+  // Завершение фазы выполняет последний пришедший к барьеру поток, пока остальные ждут:
+  // доставка переданных и граница следующего окна без гонок
+  auto completion = [this, lookahead, &bound, &done]() noexcept {
+    for (int shard = 0; shard < getShardCount(); shard++) {
+      deliver(shard);
+    }
+    windows++;
+    double next = getNextEventTime();
+    bound = next + lookahead;
+    done = std::isinf(next);
+  };
+  std::barrier sync(getShardCount(), completion);
+
+  std::vector<std::thread> workers;
+  workers.reserve(shards.size());
+  for (int shard = 0; shard < getShardCount(); shard++) {
+    workers.emplace_back([this, shard, &sync, &bound, &done]() {
+      while (!done) {
+        shards[shard]->runUntil(bound);
+        sync.arrive_and_wait();
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+int ShardedSimulation::getShardCount() const { return static_cast<int>(shards.size()); }
+const PushNotificationSystem& ShardedSimulation::getShard(int shard) const { return *shards[shard]; }
+double ShardedSimulation::getForwardDelay() const { return forwardDelay; }
+long long ShardedSimulation::getWindows() const { return windows; }
+
+long long ShardedSimulation::getForwardedCount() const {
+  long long total = 0;
+  for (const auto& shard : shards) {
+    total += shard->getDatabase().getForwardedCount();
+  }
+  return total;
+}
+
+void ShardedSimulation::saveResults(BinaryWriter& writer) const {
+  for (const auto& shard : shards) {
+    shard->getDatabase().saveState(writer);
+  }
+}
+
+bool runShardBenchmark(const SimulationConfig& config, int maxShards, double forwardDelay) {
+  std::cout << "===== Параллельный прогон по шардам =====\n";
+  std::cout << "Источников: " << config.sources.size() << ", каналов: " << config.channels.size()
+    << ", заявок: " << config.maxNotifications << ", задержка передачи (запас окна): " << forwardDelay
+    << ", ядер: " << std::thread::hardware_concurrency() << "\n";
+  std::cout << "Шардов | Окон     | Передано | p_отк  | Последовательно, с | Параллельно, с | Ускорение | К 1 шарду | Совпадает\n";
+  std::cout << "-------|----------|----------|--------|--------------------|----------------|-----------|-----------|----------\n";
+
+  bool allSame = true;
+  double baseSeconds = 0.0;
+  for (int count = 1; count <= maxShards; count = (count * 2 > maxShards && count < maxShards) ? maxShards : count * 2) {
+    ShardedSimulation sequential(config, count, forwardDelay);
+    auto start = std::chrono::steady_clock::now();
+    sequential.runSequential();
+    double sequentialSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ShardedSimulation parallel(config, count, forwardDelay);
+    start = std::chrono::steady_clock::now();
+    parallel.runParallel();
+    double parallelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (count == 1) {
+      baseSeconds = sequentialSeconds;
+    }
+
+    BinaryWriter expected;
+    BinaryWriter actual;
+    sequential.saveResults(expected);
+    parallel.saveResults(actual);
+    bool same = expected.getData() == actual.getData();
+    allSame = allSame && same;
+
+    long long delivered = 0;
+    long long rejected = 0;
+    for (int shard = 0; shard < parallel.getShardCount(); shard++) {
+      delivered += parallel.getShard(shard).getDatabase().getDeliveredCount();
+      rejected += parallel.getShard(shard).getDatabase().getRejectedCount();
+    }
+    std::cout << std::setw(6) << parallel.getShardCount() << " | " << std::setw(8) << parallel.getWindows() << " | "
+      << std::setw(8) << parallel.getForwardedCount() << " | " << std::fixed << std::setprecision(4)
+      << std::setw(6) << (delivered + rejected > 0 ? static_cast<double>(rejected) / (delivered + rejected) : 0.0) << " | "
+      << std::setprecision(3) << std::setw(18) << sequentialSeconds << " | " << std::setw(14) << parallelSeconds << " | "
+      << std::setprecision(2) << std::setw(9) << sequentialSeconds / parallelSeconds << " | "
+      << std::setw(9) << baseSeconds / parallelSeconds << " | " << (same ? "да" : "НЕТ") << "\n";
+    if (parallel.getShardCount() < count) {
+      break; // Источников или каналов меньше, чем шардов
+    }
+  }
+  std::cout << "Параллельные прогоны совпадают с последовательными: " << (allSame ? "да" : "НЕТ") << "\n";
+  return allSame;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+// ShardedSimulation.h
+#ifndef SHARDED_SIMULATION_H
+#define SHARDED_SIMULATION_H
+
+#include "PushNotificationSystem.h"
+#include "SimulationConfig.h"
+#include <memory>
+#include <vector>
+
+class BinaryWriter;
+
+// Консервативный параллельный прогон по регионам (шардам). Источники и каналы сценария делятся
+// на непрерывные диапазоны, у каждого шарда - свой календарь, буфер, каналы и статистика.
+// Переполнение буфера шарда (вытесненное по Д1ОО4) передается следующему по кольцу и приходит
+// туда через forwardDelay. Это и есть запас (lookahead): событие шарда в момент t затрагивает
+// соседа не раньше t + forwardDelay. Поэтому параллельный прогон идет окнами [T, T + forwardDelay),
+// T - ближайшее событие по всем шардам: внутри окна шарды независимы, на границе окна -
+// барьер и доставка переданных. Результат совпадает с последовательным прогоном тех же шардов
+class ShardedSimulation {
+private:
+  std::vector<std::unique_ptr<PushNotificationSystem>> shards;
+  double forwardDelay;
+  long long windows; // Окон синхронизации в последнем параллельном прогоне
+
+  void deliver(int shard); // Исходящие шарда - следующему по кольцу
+  double getNextEventTime() const; // Ближайшее событие по всем шардам
+
+public:
+  // Шардов не больше, чем источников и каналов (у каждого шарда хотя бы по одному)
+  ShardedSimulation(const SimulationConfig& config, int shardCount, double forwardDelay);
+
+  // Часть сценария для шарда: источники и каналы - диапазон (номера с 1 заново),
+  // буфер, пул повторов и пределы автомасштабирования - доля, предел заявок - по доле интенсивности
+  static SimulationConfig shardConfig(const SimulationConfig& config, int shard, int shardCount);
+
+  void runSequential(); // Один поток: события всех шардов в общем порядке времени, передача сразу
+  void runParallel(); // Поток на шард, окна по forwardDelay
+
+  int getShardCount() const;
+  const PushNotificationSystem& getShard(int shard) const;
+  double getForwardDelay() const;
+  long long getWindows() const;
+  long long getForwardedCount() const; // По всем шардам
+  // Статистика всех шардов подряд - для сравнения прогонов
+  void saveResults(BinaryWriter& writer) const;
+};
+
+// Ускорение от числа шардов: для 1, 2, 4, ... maxShards - последовательный и параллельный прогон
+// одного разбиения, их совпадение и время. Возвращает false, если прогоны разошлись
+bool runShardBenchmark(const SimulationConfig& config, int maxShards, double forwardDelay);
+
+#endif // SHARDED_SIMULATION_H
\ No newline at end of file
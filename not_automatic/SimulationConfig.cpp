@@ -0,0 +1,399 @@
+// SimulationConfig.cpp
+#include "SimulationConfig.h"
+#include "PushNotificationSystem.h" // Для streamSeed
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+SimulationConfig SimulationConfig::variant17(int numSources, int bufferCapacity, int numChannels, long long maxNotifs, unsigned seed) {
+  SimulationConfig config;
+  for (int i = 1; i <= numSources; i++) {
+    config.sources.push_back(SourceConfig{ i, 0.5 }); // Lambda = 0.5 (средний интервал 2.0)
+  }
+  for (int i = 1; i <= numChannels; i++) {
+    config.channels.push_back(ChannelConfig{ i, i, 2.0, 5.0 }); // Канал 1 - высший приоритет
+  }
+  config.bufferCapacity = bufferCapacity;
+  config.maxNotifications = maxNotifs;
+  config.seed = seed;
+  return config;
+}
+
+double RetryConfig::delay(int attempt, double u) const {
+  double value = std::min(maxDelay, baseDelay * std::pow(factor, attempt - 1));
+  return value * (1.0 - jitter * u);
+}
+
+void SimulationConfig::setPriorityScheme(const std::string& scheme) {
+  int count = static_cast<int>(channels.size());
+  for (int i = 0; i < count; i++) {
+    if (scheme == "asc") {
+      channels[i].priority = i + 1;
+    }
+    else if (scheme == "desc") {
+      channels[i].priority = count - i;
+    }
+    else if (scheme == "equal") {
+      channels[i].priority = 1; // При равенстве выбирается канал с меньшим номером
+    }
+    else {
+      throw std::invalid_argument("Неизвестная схема приоритетов: " + scheme);
+    }
+  }
+}
+
+void SimulationConfig::setDispatchPolicy(const std::string& name) {
+  if (name == "priority") {
+    dispatchPolicy = DispatchPolicy::PRIORITY;
+  }
+  else if (name == "jsq") {
+    dispatchPolicy = DispatchPolicy::SHORTEST_QUEUE;
+  }
+  else if (name == "pod") {
+    dispatchPolicy = DispatchPolicy::POWER_OF_D;
+  }
+  else if (name == "fastest") {
+    dispatchPolicy = DispatchPolicy::FASTEST;
+  }
+  else {
+    throw std::invalid_argument("Неизвестная политика выбора канала: " + name);
+  }
+}
+
+// --- Загрузка сценария ---
+namespace {
+
+  std::string trim(const std::string& text) {
+    std::size_t from = text.find_first_not_of(" \t\r");
+    if (from == std::string::npos) {
+      return "";
+    }
+    std::size_t to = text.find_last_not_of(" \t\r");
+    return text.substr(from, to - from + 1);
+  }
+
+  // Описание группы до развертывания в источники / каналы
+  struct Group {
+    int line;
+    std::map<std::string, std::string> values;
+  };
+
+  std::runtime_error scenarioError(const std::string& path, int line, const std::string& message) {
+    return std::runtime_error(path + ":" + std::to_string(line) + ": " + message);
+  }
+
+  // "закон p1 [p2]" -> имя и параметры
+  std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) {
+      words.push_back(word);
+    }
+    return words;
+  }
+
+  double toNumber(const std::string& text, const std::string& path, int line) {
+    try {
+      std::size_t used = 0;
+      double value = std::stod(text, &used);
+      if (used != text.size()) {
+        throw std::invalid_argument(text);
+      }
+      return value;
+    }
+    catch (const std::exception&) {
+      throw scenarioError(path, line, "ожидалось число: " + text);
+    }
+  }
+
+}
+
+SimulationConfig SimulationConfig::fromFile(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Не удалось открыть сценарий: " + path);
+  }
+  return fromStream(in, path);
+}
+
+SimulationConfig SimulationConfig::fromStream(std::istream& in, const std::string& path) {
+  SimulationConfig config;
+  std::vector<Group> sourceGroups;
+  std::vector<Group> channelGroups;
+  Group systemGroup{ 0, {} };
+  Group retryGroup{ 0, {} };
+  Group autoscaleGroup{ 0, {} };
+  Group* current = nullptr;
+
+  std::string text;
+  int line = 0;
+  while (std::getline(in, text)) {
+    line++;
+    std::size_t comment = text.find_first_of("#;");
+    text = trim(comment == std::string::npos ? text : text.substr(0, comment));
+    if (text.empty()) {
+      continue;
+    }
+    if (text.front() == '[') {
+      std::string section = trim(text.substr(1, text.find(']') - 1));
+      if (section == "system") {
+        systemGroup.line = line;
+        current = &systemGroup;
+      }
+      else if (section == "retry") {
+        retryGroup.line = line;
+        current = &retryGroup;
+      }
+      else if (section == "autoscale") {
+        autoscaleGroup.line = line;
+        current = &autoscaleGroup;
+      }
+      else if (section == "sources") {
+        sourceGroups.push_back(Group{ line, {} });
+        current = &sourceGroups.back();
+      }
+      else if (section == "channels") {
+        channelGroups.push_back(Group{ line, {} });
+        current = &channelGroups.back();
+      }
+      else {
+        throw scenarioError(path, line, "неизвестная секция [" + section + "]");
+      }
+      continue;
+    }
+    std::size_t equals = text.find('=');
+    if (equals == std::string::npos || !current) {
+      throw scenarioError(path, line, "ожидалось 'ключ = значение' внутри секции");
+    }
+    current->values[trim(text.substr(0, equals))] = trim(text.substr(equals + 1));
+  }
+
+  auto number = [&](const Group& group, const std::string& key, double fallback) {
+    auto it = group.values.find(key);
+    return it == group.values.end() ? fallback : toNumber(it->second, path, group.line);
+  };
+
+  // Буфер без мест модель не выдерживает, дробный молча обрезался бы приведением
+  double buffer = number(systemGroup, "buffer", config.bufferCapacity);
+  if (buffer < 1 || buffer > std::numeric_limits<int>::max() || buffer != std::floor(buffer)) {
+    throw scenarioError(path, systemGroup.line, "buffer - целое число мест >= 1");
+  }
+  config.bufferCapacity = static_cast<int>(buffer);
+  config.maxNotifications = static_cast<long long>(number(systemGroup, "notifications", static_cast<double>(config.maxNotifications)));
+  config.seed = static_cast<unsigned>(number(systemGroup, "seed", config.seed));
+  config.snapshotInterval = static_cast<int>(number(systemGroup, "snapshots", config.snapshotInterval));
+  config.ttlTick = number(systemGroup, "ttl_tick", config.ttlTick);
+  config.coalescing = number(systemGroup, "coalescing", 0.0) != 0.0;
+  config.antithetic = number(systemGroup, "antithetic", 0.0) != 0.0;
+  config.warmupBatch = static_cast<int>(number(systemGroup, "warmup", config.warmupBatch));
+  config.precision = number(systemGroup, "precision", config.precision);
+  auto classesIt = systemGroup.values.find("classes");
+  if (classesIt != systemGroup.values.end()) {
+    if (classesIt->second == "strict") {
+      config.classSelection = ClassSelection::STRICT;
+    }
+    else if (classesIt->second == "weighted") {
+      config.classSelection = ClassSelection::WEIGHTED;
+    }
+    else {
+      throw scenarioError(path, systemGroup.line, "classes: strict | weighted");
+    }
+  }
+  auto dispatchIt = systemGroup.values.find("dispatch");
+  if (dispatchIt != systemGroup.values.end()) {
+    try {
+      config.setDispatchPolicy(dispatchIt->second);
+    }
+    catch (const std::invalid_argument&) {
+      throw scenarioError(path, systemGroup.line, "dispatch: priority | jsq | pod | fastest");
+    }
+  }
+  config.dispatchChoices = static_cast<int>(number(systemGroup, "dispatch_d", config.dispatchChoices));
+  if (config.dispatchChoices < 1) {
+    throw scenarioError(path, systemGroup.line, "dispatch_d должно быть >= 1");
+  }
+  auto weightsIt = systemGroup.values.find("class_weights");
+  if (weightsIt != systemGroup.values.end()) {
+    for (const auto& word : splitWords(weightsIt->second)) {
+      double weight = toNumber(word, path, systemGroup.line);
+      if (weight <= 0) {
+        throw scenarioError(path, systemGroup.line, "веса классов должны быть > 0");
+      }
+      config.classWeights.push_back(weight);
+    }
+  }
+
+  config.retry.maxAttempts = static_cast<int>(number(retryGroup, "attempts", config.retry.maxAttempts));
+  config.retry.baseDelay = number(retryGroup, "base", config.retry.baseDelay);
+  config.retry.factor = number(retryGroup, "factor", config.retry.factor);
+  config.retry.maxDelay = number(retryGroup, "max_delay", config.retry.maxDelay);
+  config.retry.jitter = number(retryGroup, "jitter", config.retry.jitter);
+  config.retry.poolSize = static_cast<int>(number(retryGroup, "pool", config.retry.poolSize));
+  if (config.retry.maxAttempts < 0 || config.retry.baseDelay < 0 || config.retry.factor < 1
+    || config.retry.jitter < 0 || config.retry.jitter > 1 || config.retry.poolSize < 0) {
+    throw scenarioError(path, retryGroup.line, "retry: attempts >= 0, base >= 0, factor >= 1, 0 <= jitter <= 1, pool >= 0");
+  }
+
+  AutoscaleConfig& scale = config.autoscale;
+  auto policyIt = autoscaleGroup.values.find("policy");
+  if (policyIt != autoscaleGroup.values.end()) {
+    if (policyIt->second == "threshold") {
+      scale.policy = ScalingPolicy::THRESHOLD;
+    }
+    else if (policyIt->second == "pid") {
+      scale.policy = ScalingPolicy::PID;
+    }
+    else if (policyIt->second == "target") {
+      scale.policy = ScalingPolicy::TARGET_TRACKING;
+    }
+    else if (policyIt->second != "none") {
+      throw scenarioError(path, autoscaleGroup.line, "policy: none | threshold | pid | target");
+    }
+  }
+  scale.interval = number(autoscaleGroup, "interval", scale.interval);
+  scale.provisionDelay = number(autoscaleGroup, "delay", scale.provisionDelay);
+  scale.channelCost = number(autoscaleGroup, "cost", scale.channelCost);
+  scale.minChannels = static_cast<int>(number(autoscaleGroup, "min", scale.minChannels));
+  scale.maxChannels = static_cast<int>(number(autoscaleGroup, "max", scale.maxChannels));
+  scale.scaleInCooldown = number(autoscaleGroup, "cooldown", scale.scaleInCooldown);
+  scale.upOccupancy = number(autoscaleGroup, "up_occupancy", scale.upOccupancy);
+  scale.downOccupancy = number(autoscaleGroup, "down_occupancy", scale.downOccupancy);
+  scale.upRejection = number(autoscaleGroup, "up_rejection", scale.upRejection);
+  scale.step = static_cast<int>(number(autoscaleGroup, "step", scale.step));
+  scale.target = number(autoscaleGroup, "target", scale.target);
+  scale.kp = number(autoscaleGroup, "kp", scale.kp);
+  scale.ki = number(autoscaleGroup, "ki", scale.ki);
+  scale.kd = number(autoscaleGroup, "kd", scale.kd);
+  scale.targetUtilization = number(autoscaleGroup, "target_utilization", scale.targetUtilization);
+  if (scale.interval <= 0 || scale.provisionDelay < 0 || scale.minChannels < 1 || scale.maxChannels < 0
+    || scale.step < 1 || scale.targetUtilization <= 0) {
+    throw scenarioError(path, autoscaleGroup.line, "autoscale: interval > 0, delay >= 0, min >= 1, max >= 0, step >= 1, target_utilization > 0");
+  }
+
+  // Развертывание групп - O(общего числа источников и каналов), память резервируется сразу
+  std::size_t sourceCount = 0;
+  for (const auto& group : sourceGroups) {
+    sourceCount += static_cast<std::size_t>(number(group, "count", 1));
+  }
+  std::size_t channelCount = 0;
+  for (const auto& group : channelGroups) {
+    channelCount += static_cast<std::size_t>(number(group, "count", 1));
+  }
+  if (sourceCount == 0 || channelCount == 0) {
+    throw std::runtime_error(path + ": нужны хотя бы одна секция [sources] и одна [channels]");
+  }
+  config.sources.reserve(sourceCount);
+  config.channels.reserve(channelCount);
+
+  for (std::size_t g = 0; g < sourceGroups.size(); g++) {
+    const Group& group = sourceGroups[g];
+    int count = static_cast<int>(number(group, "count", 1));
+    auto rateIt = group.values.find("rate");
+    std::vector<std::string> rate = splitWords(rateIt == group.values.end() ? "0.5" : rateIt->second);
+
+    // Интенсивности группы из распределения - свой поток на группу, воспроизводимо по seed
+    std::mt19937 rng(PushNotificationSystem::streamSeed(config.seed, 2, static_cast<int>(g)));
+    std::function<double()> nextRate;
+    if (rate.size() == 1) {
+      double value = toNumber(rate[0], path, group.line);
+      nextRate = [value]() { return value; };
+    }
+    else if (rate.size() == 3 && rate[0] == "uniform") {
+      std::uniform_real_distribution<double> dist(toNumber(rate[1], path, group.line), toNumber(rate[2], path, group.line));
+      nextRate = [dist, &rng]() mutable { return dist(rng); };
+    }
+    else if (rate.size() == 3 && rate[0] == "lognormal") {
+      std::lognormal_distribution<double> dist(toNumber(rate[1], path, group.line), toNumber(rate[2], path, group.line));
+      nextRate = [dist, &rng]() mutable { return dist(rng); };
+    }
+    else {
+      throw scenarioError(path, group.line, "rate: число | uniform a b | lognormal mu sigma");
+    }
+    double ttl = number(group, "ttl", 0.0);
+    if (ttl < 0) {
+      throw scenarioError(path, group.line, "ttl должен быть >= 0");
+    }
+    int devices = static_cast<int>(number(group, "devices", 0.0));
+    int collapseKeys = static_cast<int>(number(group, "collapse_keys", 0.0));
+    if (devices < 0 || collapseKeys < 0) {
+      throw scenarioError(path, group.line, "devices и collapse_keys должны быть >= 0");
+    }
+    int priorityClass = static_cast<int>(number(group, "class", 0.0));
+    if (priorityClass < 0 || priorityClass > 63) {
+      throw scenarioError(path, group.line, "class: от 0 (высший) до 63");
+    }
+    double rateLimit = 0.0;
+    double rateBurst = 1.0;
+    auto limitIt = group.values.find("limit");
+    if (limitIt != group.values.end()) {
+      std::vector<std::string> limit = splitWords(limitIt->second);
+      if (limit.empty() || limit.size() > 2) {
+        throw scenarioError(path, group.line, "limit: rate [burst]");
+      }
+      rateLimit = toNumber(limit[0], path, group.line);
+      rateBurst = limit.size() == 2 ? toNumber(limit[1], path, group.line) : 1.0;
+      if (rateLimit <= 0 || rateBurst < 1) {
+        throw scenarioError(path, group.line, "limit: rate > 0, burst >= 1");
+      }
+    }
+
+    for (int i = 0; i < count; i++) {
+      double lambda = nextRate();
+      if (lambda <= 0) {
+        throw scenarioError(path, group.line, "интенсивность источника должна быть > 0");
+      }
+      config.sources.push_back(SourceConfig{ static_cast<int>(config.sources.size()) + 1, lambda, ttl, devices, collapseKeys, priorityClass, rateLimit, rateBurst });
+    }
+  }
+
+  for (std::size_t g = 0; g < channelGroups.size(); g++) {
+    const Group& group = channelGroups[g];
+    int count = static_cast<int>(number(group, "count", 1));
+    ChannelConfig channel{ 0, static_cast<int>(number(group, "priority", static_cast<double>(g + 1))), 2.0, 5.0 };
+
+    auto serviceIt = group.values.find("service");
+    std::vector<std::string> service = splitWords(serviceIt == group.values.end() ? "uniform 2.0 5.0" : serviceIt->second);
+    if (service.size() == 3 && service[0] == "uniform") {
+      channel.minServiceTime = toNumber(service[1], path, group.line);
+      channel.maxServiceTime = toNumber(service[2], path, group.line);
+    }
+    else if (service.size() == 2 && service[0] == "exponential") {
+      channel.serviceLaw = ServiceLaw::EXPONENTIAL;
+      channel.meanServiceTime = toNumber(service[1], path, group.line);
+    }
+    else if (service.size() == 2 && service[0] == "constant") {
+      channel.serviceLaw = ServiceLaw::CONSTANT;
+      channel.meanServiceTime = toNumber(service[1], path, group.line);
+    }
+    else {
+      throw scenarioError(path, group.line, "service: uniform a b | exponential mean | constant t");
+    }
+
+    auto batchIt = group.values.find("batch");
+    if (batchIt != group.values.end()) {
+      std::vector<std::string> batch = splitWords(batchIt->second);
+      if (batch.size() != 3) {
+        throw scenarioError(path, group.line, "batch: k setup per_item");
+      }
+      channel.batchSize = static_cast<int>(toNumber(batch[0], path, group.line));
+      channel.batchSetup = toNumber(batch[1], path, group.line);
+      channel.batchPerItem = toNumber(batch[2], path, group.line);
+      if (channel.batchSize < 1 || channel.batchSetup < 0 || channel.batchPerItem < 0) {
+        throw scenarioError(path, group.line, "batch: k >= 1, setup и per_item >= 0");
+      }
+    }
+
+    for (int i = 0; i < count; i++) {
+      channel.id = static_cast<int>(config.channels.size()) + 1;
+      config.channels.push_back(channel);
+    }
+  }
+  return config;
+}
\ No newline at end of file
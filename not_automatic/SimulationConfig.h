@@ -0,0 +1,119 @@
+// SimulationConfig.h
+#ifndef SIMULATION_CONFIG_H
+#define SIMULATION_CONFIG_H
+
+#include "CommonTypes.h" // Для ServiceLaw
+#include <istream>
+#include <string>
+#include <vector>
+
+// Параметры источника (ИБ, ИЗ1): пуассоновский поток с интенсивностью lambda
+struct SourceConfig {
+  int id;
+  double lambda;
+  double ttl = 0.0; // Срок жизни уведомления в буфере, 0 - не устаревает
+  int devices = 0; // Устройства-адресаты (равномерно), 0 - адресат не задается
+  int collapseKeys = 0; // Ключи схлопывания (равномерно), 0 - уведомления источника не объединяются
+  int priorityClass = 0; // Класс уведомлений источника, 0 - высший
+  double rateLimit = 0.0; // Маркерная корзина на входе: маркеров в единицу времени, 0 - без ограничения
+  double rateBurst = 1.0; // Емкость корзины
+};
+
+// Параметры канала (Д2П1): приоритет и закон времени обслуживания
+struct ChannelConfig {
+  int id;
+  int priority; // Меньшее число - выше приоритет
+  double minServiceTime; // Для UNIFORM
+  double maxServiceTime;
+  ServiceLaw serviceLaw = ServiceLaw::UNIFORM;
+  double meanServiceTime = 0.0; // Для EXPONENTIAL и CONSTANT
+  // Пакетное обслуживание: за один захват канал забирает до batchSize уведомлений,
+  // время пачки из n = batchSetup + n * batchPerItem (закон обслуживания не используется)
+  int batchSize = 1; // 1 - обычный канал, одно уведомление за раз
+  double batchSetup = 0.0;
+  double batchPerItem = 0.0;
+};
+
+// Повторы вытесненных уведомлений: клиент переотправляет с экспоненциальной задержкой
+struct RetryConfig {
+  int maxAttempts = 0; // Повторов на уведомление, 0 - без повторов (вытеснение - окончательный отказ)
+  double baseDelay = 1.0; // Задержка перед первым повтором
+  double factor = 2.0; // Рост задержки с каждой попыткой
+  double maxDelay = 60.0; // Потолок задержки
+  double jitter = 1.0; // Разброс: задержка * (1 - jitter * u), u ~ U[0, 1); 1 - "full jitter", 0 - без разброса
+  int poolSize = 0; // Одновременно ожидающих повторов, 0 - 4 * емкость буфера + число источников
+
+  // Задержка перед попыткой attempt (1 - первый повтор) при равномерном u из [0, 1)
+  double delay(int attempt, double u) const;
+};
+
+// Автомасштабирование: контроллер раз в interval модельного времени смотрит на буфер,
+// отказы и загрузку и меняет число каналов. Новый канал начинает работу через
+// provisionDelay и повторяет параметры последней группы [channels]
+struct AutoscaleConfig {
+  ScalingPolicy policy = ScalingPolicy::NONE;
+  double interval = 10.0; // Период контроллера
+  double provisionDelay = 30.0; // От решения до готовности канала
+  double channelCost = 1.0; // Стоимость канала за единицу модельного времени
+  int minChannels = 1;
+  int maxChannels = 0; // 0 - вдвое больше начального числа
+  double scaleInCooldown = 60.0; // Сокращение не раньше, чем через столько после последнего изменения
+  // THRESHOLD
+  double upOccupancy = 0.8; // Заполнение буфера, выше которого канал добавляется
+  double downOccupancy = 0.1; // Ниже (и без отказов за период) - снимается
+  double upRejection = 0.01; // Доля отказов за период, выше которой канал добавляется
+  int step = 1;
+  // PID: ошибка - заполнение буфера минус target
+  double target = 0.3;
+  double kp = 4.0;
+  double ki = 0.2;
+  double kd = 0.0;
+  // TARGET_TRACKING
+  double targetUtilization = 0.7;
+};
+
+// Полное описание прогона системы
+struct SimulationConfig {
+  std::vector<SourceConfig> sources;
+  std::vector<ChannelConfig> channels;
+  int bufferCapacity = 5;
+  long long maxNotifications = 100;
+  unsigned seed = 0; // 0 - случайное зерно
+  int snapshotInterval = 100; // Снапшот рядов графиков каждые N событий, 0 - без рядов
+  double ttlTick = 0.0; // Тик колеса TTL в буфере, 0 - по самому короткому TTL
+  bool coalescing = false; // Объединять в буфере уведомления с одинаковыми (источник, устройство, ключ)
+  bool antithetic = false; // Антитетический прогон: все потоки модели выдают 1 - U (пара к обычному с тем же зерном)
+  int warmupBatch = 0; // Отсечение разгона по MSER: доставок в пачке наблюдений (5 - MSER-5), 0 - статистика с t = 0
+  double precision = 0.0; // Остановка по точности: относительная полуширина интервалов Таблицы 1 (метод пачек), 0 - до notifications
+  ClassSelection classSelection = ClassSelection::NONE; // Выбор из буфера по классам уведомлений
+  std::vector<double> classWeights; // Веса классов для WEIGHTED, недостающие - 1
+  DispatchPolicy dispatchPolicy = DispatchPolicy::PRIORITY; // Выбор свободного канала
+  int dispatchChoices = 2; // d для POWER_OF_D
+  RetryConfig retry;
+  AutoscaleConfig autoscale;
+
+  // Вариант 17: источники с lambda = 0.5, каналы 2.0-5.0 с приоритетами 1..numChannels
+  static SimulationConfig variant17(int numSources, int bufferCapacity, int numChannels, long long maxNotifs, unsigned seed);
+
+  // Сценарий из INI-файла. Секции [system] (buffer, notifications, seed, snapshots, ttl_tick, coalescing = 0|1, antithetic = 0|1, warmup = N, precision = delta,
+  // classes = strict | weighted, class_weights = w0 w1 ..., dispatch = priority | jsq | pod | fastest, dispatch_d),
+  // повторяемые [sources] (count, rate = число | uniform a b | lognormal mu sigma, ttl, devices, collapse_keys, class,
+  // limit = rate [burst])
+  // и [channels] (count, priority, service = uniform a b | exponential mean | constant t, batch = k setup per_item).
+  // Секция [retry] (attempts, base, factor, max_delay, jitter, pool) - повторы вытесненных.
+  // Секция [autoscale] (policy = threshold | pid | target, interval, delay, cost, min, max, cooldown,
+  // up_occupancy, down_occupancy, up_rejection, step, target, kp, ki, kd, target_utilization).
+  // Каждая секция [sources]/[channels] - группа; номера присваиваются подряд с 1.
+  // Пример - scenarios/variant17.ini
+  static SimulationConfig fromFile(const std::string& path);
+  // То же из потока (текст сценария, присланный по сети); path - имя для сообщений об ошибках
+  static SimulationConfig fromStream(std::istream& in, const std::string& path);
+
+  // Порядок приоритетов каналов: "asc" (канал i - приоритет i), "desc" или "equal"
+  void setPriorityScheme(const std::string& scheme);
+
+  // Политика выбора канала по имени: "priority", "jsq", "pod" или "fastest"
+  void setDispatchPolicy(const std::string& name);
+};
+
+#endif // SIMULATION_CONFIG_H
\ No newline at end of file
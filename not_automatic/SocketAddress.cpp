@@ -0,0 +1,80 @@
+// SocketAddress.cpp
+#include "SocketAddress.h"
+#include <charconv> // Для from_chars
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+std::string unixSocketPath(const std::string& address) {
+  return address.rfind("unix:", 0) == 0 ? address.substr(5) : std::string();
+}
+
+int openStreamSocket(const std::string& address, bool listening, int backlog) {
+#ifdef _WIN32
+  throw std::runtime_error("Сокеты доступны только на POSIX-системах: " + address);
+#else
+  int fd = -1;
+  int status = -1;
+  if (address.rfind("unix:", 0) == 0) {
+    std::string path = unixSocketPath(address);
+    sockaddr_un local{};
+    if (path.empty() || path.size() >= sizeof(local.sun_path)) {
+      throw std::runtime_error("Некорректный путь сокета: " + address);
+    }
+    local.sun_family = AF_UNIX;
+    std::strcpy(local.sun_path, path.c_str());
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && listening) {
+      ::unlink(path.c_str());
+      status = ::bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+    }
+    else if (fd >= 0) {
+      status = ::connect(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local));
+    }
+  }
+  else {
+    std::string host = "127.0.0.1";
+    std::string port = address;
+    std::size_t colon = address.rfind(':');
+    if (colon != std::string::npos) {
+      host = address.substr(0, colon);
+      port = address.substr(colon + 1);
+    }
+    unsigned number = 0;
+    auto parsed = std::from_chars(port.data(), port.data() + port.size(), number);
+    sockaddr_in remote{};
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(static_cast<unsigned short>(number));
+    if (port.empty() || parsed.ec != std::errc() || parsed.ptr != port.data() + port.size() || number > 65535
+      || ::inet_pton(AF_INET, host.c_str(), &remote.sin_addr) != 1) {
+      throw std::runtime_error("Некорректный адрес сокета: " + address);
+    }
+    fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0 && listening) {
+      int reuse = 1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+      status = ::bind(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote));
+    }
+    else if (fd >= 0) {
+      status = ::connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote));
+    }
+  }
+  if (status == 0 && listening) {
+    status = ::listen(fd, backlog);
+  }
+  if (status != 0) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    return -1;
+  }
+  return fd;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+// SocketAddress.h
+#ifndef SOCKET_ADDRESS_H
+#define SOCKET_ADDRESS_H
+
+#include <string>
+
+// Адреса сервера метрик и фермы реплик: "unix:/путь", "порт" или "хост:порт" (по умолчанию 127.0.0.1).
+// Открыть потоковый сокет: listening - bind и listen(backlog) (TCP - с SO_REUSEADDR, прежний файл
+// unix-сокета удаляется), иначе connect. Некорректный адрес - исключение, неудача сокета - -1.
+// Только POSIX
+int openStreamSocket(const std::string& address, bool listening, int backlog = 64);
+
+// Путь файла для "unix:/путь", для TCP - пустая строка
+std::string unixSocketPath(const std::string& address);
+
+#endif // SOCKET_ADDRESS_H
\ No newline at end of file
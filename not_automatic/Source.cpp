@@ -1,19 +1,66 @@
 // Source.cpp
 #include "Source.h"
+#include "Checkpoint.h"
 
-Source::Source(int id, double lambda)
-  : id(id), lambda(lambda), notificationCount(0), rng(std::random_device()()),
-  expDist(lambda) {
+Source::Source(int id, double lambda, unsigned seed)
+  : id(id), lambda(lambda), notificationCount(0), rng(seed),
+  expDist(lambda), devices(0), collapseKeys(0), priorityClass(0) {
 }
 
 double Source::getNextGenerationTime(double currentTime) {
-  return currentTime + expDist(rng);
+  return currentTime + getNextInterval();
 }
 
-Notification Source::generateNotification() {
+double Source::getNextInterval() {
+  return expDist(rng);
+}
+
+Notification Source::generateNotification(double currentTime) {
   notificationCount++;
-  return Notification(notificationCount, id);
+  return Notification(notificationCount, id, currentTime);
+}
+
+void Source::setAudience(int deviceCount, int keyCount) {
+  devices = deviceCount;
+  collapseKeys = keyCount;
+}
+
+void Source::assignAudience(Notification& notification) {
+  notification.setPriorityClass(priorityClass);
+  if (devices <= 0 && collapseKeys <= 0) {
+    return;
+  }
+  int device = (devices > 0) ? std::uniform_int_distribution<int>(1, devices)(rng) : 0;
+  int key = (collapseKeys > 0) ? std::uniform_int_distribution<int>(1, collapseKeys)(rng) : 0;
+  notification.setAudience(device, key);
 }
 
+void Source::setPriorityClass(int value) { priorityClass = value; }
+int Source::getPriorityClass() const { return priorityClass; }
+
 int Source::getId() const { return id; }
-int Source::getGeneratedCount() const { return notificationCount; }
\ No newline at end of file
+void Source::reseed(unsigned seed) { rng.seed(seed); }
+void Source::setAntithetic(bool enabled) { rng.setAntithetic(enabled); }
+int Source::getGeneratedCount() const { return notificationCount; }
+
+void Source::saveState(BinaryWriter& writer) const {
+  writer.writePod(id);
+  writer.writePod(lambda);
+  writer.writePod(notificationCount);
+  writer.writePod(rng);
+  writer.writePod(expDist);
+  writer.writePod(devices);
+  writer.writePod(collapseKeys);
+  writer.writePod(priorityClass);
+}
+
+void Source::loadState(BinaryReader& reader) {
+  reader.readPod(id);
+  reader.readPod(lambda);
+  reader.readPod(notificationCount);
+  reader.readPod(rng);
+  reader.readPod(expDist);
+  reader.readPod(devices);
+  reader.readPod(collapseKeys);
+  reader.readPod(priorityClass);
+}
\ No newline at end of file
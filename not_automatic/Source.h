@@ -3,27 +3,52 @@
 #define SOURCE_H
 
 #include "Notification.h"
+#include "RandomEngine.h"
 #include <random>
 
+class BinaryWriter;
+class BinaryReader;
+
 class Source {
 private:
   int id;
-  double lambda; //     (1/   )
+  double lambda; // Параметр для генерации интервалов (1/среднее время между заявками)
   int notificationCount;
-  std::mt19937 rng;
-  std::exponential_distribution<double> expDist; //     (1 - )
+  RandomEngine rng;
+  std::exponential_distribution<double> expDist; // Для интервалов между заявками (ИЗ1 - Пуассон)
+  int devices; // Число устройств-адресатов, 0 - адресат не разыгрывается
+  int collapseKeys; // Число ключей схлопывания, 0 - уведомления не объединяются
+  int priorityClass; // Класс всех уведомлений источника
 
 public:
-  Source(int id, double lambda);
+  Source(int id, double lambda, unsigned seed = std::random_device()());
 
-  //        (   )
+  // Метод для получения времени до следующей генерации (используется в календаре событий)
   double getNextGenerationTime(double currentTime);
 
-  //  
-  Notification generateNotification();
+  // Интервал до следующей генерации (для процессной модели - delay(t))
+  double getNextInterval();
+
+  // Генерация уведомления
+  Notification generateNotification(double currentTime = 0.0);
+
+  // Аудитория источника: адресат и ключ разыгрываются равномерно из 1..devices и 1..collapseKeys
+  // (0 - не разыгрывается: без устройств ключ относится ко всему источнику)
+  void setAudience(int devices, int collapseKeys);
+  // Разыграть адресата уведомления (без аудитории - ничего не тратит из потока) и проставить класс
+  void assignAudience(Notification& notification);
+
+  void setPriorityClass(int value);
+  int getPriorityClass() const;
 
   int getId() const;
-  int getGeneratedCount() const; //   n_gen
+  void reseed(unsigned seed); // Новый поток случайных чисел с текущего состояния (клон траектории)
+  void setAntithetic(bool enabled); // Поток выдает 1 - U (см. RandomEngine)
+  int getGeneratedCount() const; // Для статистики n_gen
+
+  // Контрольная точка: счетчик заявок и состояние генератора
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
 };
 
 #endif // SOURCE_H
\ No newline at end of file
@@ -0,0 +1,370 @@
+// Sweep.cpp
+#include "Sweep.h"
+#include "PushNotificationSystem.h"
+#include "AnalyticalModel.h"
+#include <algorithm> // Для sort, max
+#include <atomic>
+#include <chrono>
+#include <cmath> // Для floor
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+  std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+      parts.push_back(part);
+    }
+    return parts;
+  }
+
+  // "a,b,c" или "от:до[:шаг]"
+  std::vector<double> parseValues(const std::string& text) {
+    std::vector<double> values;
+    if (text.find(':') != std::string::npos) {
+      std::vector<std::string> bounds = split(text, ':');
+      if (bounds.size() < 2 || bounds.size() > 3) {
+        throw std::invalid_argument("Диапазон задается как от:до[:шаг]: " + text);
+      }
+      double from = std::stod(bounds[0]);
+      double to = std::stod(bounds[1]);
+      double step = (bounds.size() == 3) ? std::stod(bounds[2]) : 1.0;
+      if (step <= 0 || to < from) {
+        throw std::invalid_argument("Некорректный диапазон: " + text);
+      }
+      // Число точек считаем заранее - без накопления ошибки округления шага
+      long long count = static_cast<long long>(std::floor((to - from) / step + 1e-9)) + 1;
+      for (long long i = 0; i < count; i++) {
+        values.push_back(from + i * step);
+      }
+    }
+    else {
+      for (const auto& part : split(text, ',')) {
+        values.push_back(std::stod(part));
+      }
+    }
+    if (values.empty()) {
+      throw std::invalid_argument("Пустой список значений");
+    }
+    return values;
+  }
+
+  std::vector<int> parseIntValues(const std::string& text) {
+    std::vector<int> values;
+    for (double value : parseValues(text)) {
+      values.push_back(static_cast<int>(std::lround(value)));
+    }
+    return values;
+  }
+
+  struct ScenarioResult {
+    double modelTime;
+    long long events;
+    long long generated;
+    long long delivered;
+    long long rejected;
+    double rejectionRate;
+    double avgWait;
+    double avgService;
+    double avgSystem;
+    double loadMean;
+    double loadMax;
+    double wallSeconds;
+  };
+
+  ScenarioResult runScenario(const SweepScenario& scenario) {
+    auto start = std::chrono::steady_clock::now();
+    PushNotificationSystem system(scenario.config);
+    system.setSnapshotInterval(0); // Ряды графиков в серии не нужны
+    system.runHeadless();
+
+    const Database& database = system.getDatabase();
+    ScenarioResult result{};
+    result.modelTime = system.getCurrentTime();
+    result.events = system.getProcessedEvents();
+    for (const auto& source : scenario.config.sources) {
+      result.generated += database.getSourceGeneratedCount(source.id);
+    }
+    result.delivered = database.getDeliveredCount();
+    result.rejected = database.getRejectedCount();
+    result.rejectionRate = result.generated > 0 ? static_cast<double>(result.rejected) / result.generated : 0.0;
+    result.avgWait = database.getAvgWaitTime();
+    result.avgService = database.getAvgServiceTime();
+    result.avgSystem = database.getAvgSystemTime();
+    for (const auto& channel : scenario.config.channels) {
+      double load = database.getChannelUtilization(channel.id, result.modelTime);
+      result.loadMean += load / scenario.config.channels.size();
+      result.loadMax = std::max(result.loadMax, load);
+    }
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+  }
+
+  // Строка результата по аналитической оценке вместо прогона
+  ScenarioResult analyticScenario(const SweepScenario& scenario, const AnalyticalEstimate& estimate) {
+    ScenarioResult result{};
+    long long notifs = scenario.config.maxNotifications;
+    result.modelTime = notifs / estimate.arrivalRate;
+    result.generated = notifs;
+    result.rejected = std::llround(notifs * estimate.rejection);
+    result.delivered = notifs - result.rejected;
+    result.rejectionRate = estimate.rejection;
+    result.avgWait = estimate.wait;
+    result.avgService = 1.0 / estimate.serviceRate;
+    result.avgSystem = estimate.wait; // Как в Таблице 1: T_преб - до входа в канал
+    result.loadMean = estimate.utilization;
+    result.loadMax = estimate.utilization;
+    return result;
+  }
+
+}
+
+void SweepSpec::setParameter(const std::string& assignment) {
+  std::size_t equals = assignment.find('=');
+  if (equals == std::string::npos) {
+    throw std::invalid_argument("Параметр серии задается как имя=значения: " + assignment);
+  }
+  std::string name = assignment.substr(0, equals);
+  std::string value = assignment.substr(equals + 1);
+
+  if (name == "lambda") {
+    lambdas = parseValues(value);
+  }
+  else if (name == "buffer") {
+    bufferCapacities = parseIntValues(value);
+  }
+  else if (name == "channels") {
+    channelCounts = parseIntValues(value);
+  }
+  else if (name == "priorities") {
+    prioritySchemes = split(value, ',');
+  }
+  else if (name == "notifs") {
+    notifications = parseIntValues(value);
+  }
+  else if (name == "sources") {
+    numSources = std::stoi(value);
+  }
+  else if (name == "seed") {
+    seed = static_cast<unsigned>(std::stoul(value));
+  }
+  else if (name == "replications") {
+    replications = std::stoi(value);
+  }
+  else if (name == "threads") {
+    threads = static_cast<unsigned>(std::stoul(value));
+  }
+  else if (name == "prescreen") {
+    prescreen = std::stoi(value) != 0;
+  }
+  else {
+    throw std::invalid_argument("Неизвестный параметр серии: " + name);
+  }
+}
+
+std::vector<SweepScenario> expandSweep(const SweepSpec& spec) {
+  std::vector<SweepScenario> scenarios;
+  for (double lambda : spec.lambdas) {
+    for (int capacity : spec.bufferCapacities) {
+      for (int channelCount : spec.channelCounts) {
+        for (const auto& scheme : spec.prioritySchemes) {
+          for (int notifs : spec.notifications) {
+            for (int replication = 0; replication < spec.replications; replication++) {
+              SimulationConfig config = SimulationConfig::variant17(spec.numSources, capacity, channelCount,
+                notifs, spec.seed + static_cast<unsigned>(replication));
+              for (auto& source : config.sources) {
+                source.lambda = lambda;
+              }
+              config.setPriorityScheme(scheme);
+              scenarios.push_back(SweepScenario{ scenarios.size(), lambda, capacity, channelCount, scheme, replication, config });
+            }
+          }
+        }
+      }
+    }
+  }
+  return scenarios;
+}
+
+std::size_t runSweep(const SweepSpec& spec, const std::string& path) {
+  std::vector<SweepScenario> scenarios = expandSweep(spec);
+
+  // Длинные сценарии - в начало очереди, чтобы к концу серии не остался один долгий прогон
+  std::vector<std::size_t> order(scenarios.size());
+  for (std::size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return scenarios[a].config.maxNotifications > scenarios[b].config.maxNotifications;
+  });
+
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Не удалось открыть файл результатов серии: " + path);
+  }
+  out << "scenario,lambda,buffer,channels,priorities,replication,seed,notifications,"
+    "model_time,events,generated,delivered,rejected,p_otk,t_wait,t_service,t_system,load_mean,load_max,wall_s,method\n";
+  out.flush();
+  out << std::setprecision(10);
+
+  unsigned threadCount = spec.threads > 0 ? spec.threads : std::max(1u, std::thread::hardware_concurrency());
+  threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, std::max<std::size_t>(scenarios.size(), 1)));
+  std::cout << "Серия: " << scenarios.size() << " сценариев, потоков: " << threadCount << ", результаты: " << path << std::endl;
+
+  std::atomic<std::size_t> next(0);
+  std::mutex outputMutex;
+  std::size_t completed = 0;
+  std::size_t screened = 0;
+  double runSeconds = 0.0;
+  std::exception_ptr failure;
+  auto start = std::chrono::steady_clock::now();
+
+  auto worker = [&]() {
+    for (;;) {
+      std::size_t position = next.fetch_add(1);
+      if (position >= order.size()) {
+        return;
+      }
+      const SweepScenario& scenario = scenarios[order[position]];
+      try {
+        bool analytic = false;
+        ScenarioResult result;
+        if (spec.prescreen) {
+          auto screenStart = std::chrono::steady_clock::now();
+          AnalyticalEstimate estimate = estimateAnalytically(scenario.config);
+          if (estimate.settled) {
+            result = analyticScenario(scenario, estimate);
+            result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - screenStart).count();
+            analytic = true;
+          }
+        }
+        if (!analytic) {
+          result = runScenario(scenario);
+        }
+
+        std::lock_guard<std::mutex> lock(outputMutex);
+        out << scenario.index << ',' << scenario.lambda << ',' << scenario.bufferCapacity << ','
+          << scenario.channelCount << ',' << scenario.priorityScheme << ',' << scenario.replication << ','
+          << scenario.config.seed << ',' << scenario.config.maxNotifications << ','
+          << result.modelTime << ',' << result.events << ',' << result.generated << ','
+          << result.delivered << ',' << result.rejected << ',' << result.rejectionRate << ','
+          << result.avgWait << ',' << result.avgService << ',' << result.avgSystem << ','
+          << result.loadMean << ',' << result.loadMax << ',' << result.wallSeconds << ','
+          << (analytic ? "analytic" : "sim") << '\n';
+        out.flush(); // Строка доступна сразу - серию можно смотреть по ходу
+        completed++;
+        screened += analytic ? 1 : 0;
+        runSeconds += result.wallSeconds;
+        std::cout << "[" << completed << "/" << scenarios.size() << "] сценарий " << scenario.index
+          << ": p_отк = " << std::fixed << std::setprecision(4) << result.rejectionRate
+          << ", " << std::setprecision(2) << result.wallSeconds << " с" << std::defaultfloat << std::endl;
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (!failure) {
+          failure = std::current_exception();
+        }
+        next = order.size(); // Остальные потоки заканчивают текущий сценарий и выходят
+        return;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threadCount; i++) {
+    workers.emplace_back(worker);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << std::fixed << std::setprecision(2) << "Серия завершена за " << wallSeconds
+    << " с (сумма времен прогонов " << runSeconds << " с)";
+  if (spec.prescreen) {
+    std::cout << ", без прогона по аналитической оценке: " << screened;
+  }
+  std::cout << "\n";
+  return scenarios.size();
+}
+
+void runAnalyticValidation(const SweepSpec& spec) {
+  std::vector<SweepScenario> scenarios = expandSweep(spec);
+  std::vector<ScenarioResult> results(scenarios.size());
+  std::vector<AnalyticalEstimate> estimates(scenarios.size());
+  double estimateSeconds = 0.0;
+  for (std::size_t i = 0; i < scenarios.size(); i++) {
+    auto start = std::chrono::steady_clock::now();
+    estimates[i] = estimateAnalytically(scenarios[i].config);
+    estimateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  unsigned threadCount = spec.threads > 0 ? spec.threads : std::max(1u, std::thread::hardware_concurrency());
+  threadCount = static_cast<unsigned>(std::min<std::size_t>(threadCount, std::max<std::size_t>(scenarios.size(), 1)));
+  std::atomic<std::size_t> next(0);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threadCount; t++) {
+    workers.emplace_back([&]() {
+      for (std::size_t i = next.fetch_add(1); i < scenarios.size(); i = next.fetch_add(1)) {
+        results[i] = runScenario(scenarios[i]);
+      }
+    });
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  std::cout << "===== Аналитическая оценка против прогона =====\n";
+  std::cout << "lambda | Буфер | Каналов | rho   | p_отк прогон | модель  | T_ож прогон | модель  | Загрузка прогон | модель | Ясно\n";
+  std::cout << "-------|-------|---------|-------|--------------|---------|-------------|---------|-----------------|--------|-----\n";
+  double maxRejectionError = 0.0;
+  double maxSettledError = 0.0;
+  double waitErrorSum = 0.0;
+  int waitErrorCount = 0;
+  double simulationSeconds = 0.0;
+  std::size_t settled = 0;
+  for (std::size_t i = 0; i < scenarios.size(); i++) {
+    const AnalyticalEstimate& estimate = estimates[i];
+    const ScenarioResult& result = results[i];
+    simulationSeconds += result.wallSeconds;
+    std::cout << std::fixed << std::setprecision(3) << std::setw(6) << scenarios[i].lambda << " | "
+      << std::setw(5) << scenarios[i].bufferCapacity << " | " << std::setw(7) << scenarios[i].channelCount << " | ";
+    if (!estimate.applicable) {
+      std::cout << "модель неприменима: " << estimate.reason << "\n";
+      continue;
+    }
+    double rejectionError = std::abs(estimate.rejection - result.rejectionRate);
+    maxRejectionError = std::max(maxRejectionError, rejectionError);
+    if (estimate.settled) {
+      settled++;
+      maxSettledError = std::max(maxSettledError, rejectionError);
+    }
+    if (result.avgWait > 0.05) {
+      waitErrorSum += std::abs(estimate.wait - result.avgWait) / result.avgWait;
+      waitErrorCount++;
+    }
+    std::cout << std::setw(5) << estimate.offeredLoad << " | "
+      << std::setprecision(5) << std::setw(12) << result.rejectionRate << " | " << std::setw(7) << estimate.rejection << " | "
+      << std::setprecision(3) << std::setw(11) << result.avgWait << " | " << std::setw(7) << estimate.wait << " | "
+      << std::setw(15) << result.loadMean << " | " << std::setw(6) << estimate.utilization << " | "
+      << (estimate.settled ? "да" : "") << "\n";
+  }
+  std::cout << std::setprecision(5) << "Наибольшая ошибка p_отк: " << maxRejectionError << ", в ясных точках: " << maxSettledError
+    << " (ясных " << settled << " из " << scenarios.size() << ")\n";
+  std::cout << std::setprecision(3) << "Средняя относительная ошибка T_ож (где T_ож > 0.05): "
+    << (waitErrorCount > 0 ? 100.0 * waitErrorSum / waitErrorCount : 0.0) << "%\n";
+  std::cout << "Время: модель " << estimateSeconds * 1e6 / std::max<std::size_t>(scenarios.size(), 1)
+    << " мкс на сценарий, прогон " << simulationSeconds / std::max<std::size_t>(scenarios.size(), 1) << " с на сценарий\n";
+}
\ No newline at end of file
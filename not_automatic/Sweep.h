@@ -0,0 +1,50 @@
+// Sweep.h
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "SimulationConfig.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Сетка параметров для серии прогонов. Значения задаются списком "a,b,c"
+// или диапазоном "от:до[:шаг]" (включительно, шаг по умолчанию 1)
+struct SweepSpec {
+  std::vector<double> lambdas = { 0.5 };
+  std::vector<int> bufferCapacities = { 5 };
+  std::vector<int> channelCounts = { 3 };
+  std::vector<std::string> prioritySchemes = { "asc" };
+  std::vector<int> notifications = { 100000 };
+  int numSources = 3;
+  unsigned seed = 17; // Все сценарии на одних зернах - различия только от параметров
+  int replications = 1; // Повторы с зернами seed, seed+1, ...
+  unsigned threads = 0; // 0 - по числу ядер
+  bool prescreen = false; // Ясные по аналитической оценке сценарии (AnalyticalModel) не прогоняются
+
+  // "имя=значения": lambda, buffer, channels, priorities, notifs, sources, seed, replications, threads, prescreen
+  void setParameter(const std::string& assignment);
+};
+
+// Один сценарий сетки
+struct SweepScenario {
+  std::size_t index;
+  double lambda;
+  int bufferCapacity;
+  int channelCount;
+  std::string priorityScheme;
+  int replication;
+  SimulationConfig config;
+};
+
+std::vector<SweepScenario> expandSweep(const SweepSpec& spec);
+
+// Прогон сетки на всех ядрах. Потоки берут следующий сценарий из общей очереди,
+// как только освободятся (самые длинные - первыми), строка результата пишется
+// в CSV сразу по завершении сценария. Возвращает число сценариев
+std::size_t runSweep(const SweepSpec& spec, const std::string& path);
+
+// Проверка аналитической оценки: каждый сценарий сетки прогоняется (на всех ядрах) и сравнивается
+// с предсказанием p_отк, T_ож и загрузки. Печатает таблицу и сводку ошибок
+void runAnalyticValidation(const SweepSpec& spec);
+
+#endif // SWEEP_H
\ No newline at end of file
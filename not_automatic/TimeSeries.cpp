@@ -0,0 +1,351 @@
+// TimeSeries.cpp
+#include "TimeSeries.h"
+#include "Checkpoint.h"
+#include <algorithm> // Для max, min
+#include <charconv> // Для to_chars
+#include <cmath> // Для abs
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+  const int kMetricCount = static_cast<int>(SeriesMetric::COUNT);
+  const char* const kMetricNames[kMetricCount] = { "p_otk", "t_wait", "t_service", "t_system", "load" };
+
+  // Двоичный колоночный файл:
+  //   uint32 magic "NMTS", uint32 версия, uint32 число колонок (с time), uint32 0,
+  //   uint64 число строк, uint64 смещение данных от начала файла (кратно 8),
+  //   имена колонок (uint32 длина + байты), нули до смещения данных,
+  //   затем колонки подряд: time[строк], колонка1[строк], ... (double, порядок байт машины)
+  const std::uint32_t kSeriesMagic = 0x53544D4E; // "NMTS"
+  const std::uint32_t kSeriesVersion = 1;
+
+  // Буферизованная запись в файл крупными блоками
+  class BufferedFile {
+  private:
+    std::ofstream out;
+    std::vector<char> buffer;
+    std::size_t used;
+    std::string path;
+
+  public:
+    explicit BufferedFile(const std::string& path)
+      : out(path, std::ios::binary | std::ios::trunc), buffer(1 << 20), used(0), path(path) {
+      if (!out) {
+        throw std::runtime_error("Не удалось открыть файл для выгрузки рядов: " + path);
+      }
+    }
+
+    ~BufferedFile() {
+      if (out.is_open()) {
+        flush();
+      }
+    }
+
+    void write(const char* data, std::size_t size) {
+      if (used + size > buffer.size()) {
+        flush();
+        if (size > buffer.size()) {
+          out.write(data, static_cast<std::streamsize>(size)); // Крупный блок (колонка) - напрямую
+          return;
+        }
+      }
+      std::copy(data, data + size, buffer.data() + used);
+      used += size;
+    }
+
+    template <typename T>
+    void writePod(const T& value) {
+      write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void writeChar(char c) {
+      write(&c, 1);
+    }
+
+    // Кратчайшая запись числа, которая читается обратно без потерь
+    void writeNumber(double value) {
+      char text[32];
+      auto result = std::to_chars(text, text + sizeof(text), value);
+      write(text, static_cast<std::size_t>(result.ptr - text));
+    }
+
+    void flush() {
+      out.write(buffer.data(), static_cast<std::streamsize>(used));
+      used = 0;
+    }
+
+    void close() {
+      flush();
+      out.close();
+      if (!out) {
+        throw std::runtime_error("Ошибка записи рядов: " + path);
+      }
+    }
+  };
+
+  // LTTB: первая и последняя точки, по одной точке из каждой корзины между ними -
+  // та, что образует наибольший треугольник с уже выбранной и средним следующей корзины
+  void selectLttb(const double* x, const double* y, std::size_t count, std::size_t threshold, std::vector<char>& keep) {
+    keep[0] = 1;
+    keep[count - 1] = 1;
+    double bucketSize = static_cast<double>(count - 2) / (threshold - 2);
+    std::size_t selected = 0;
+    for (std::size_t bucket = 0; bucket < threshold - 2; bucket++) {
+      std::size_t from = static_cast<std::size_t>(bucket * bucketSize) + 1;
+      std::size_t to = static_cast<std::size_t>((bucket + 1) * bucketSize) + 1;
+      std::size_t nextFrom = to;
+      std::size_t nextTo = std::min(static_cast<std::size_t>((bucket + 2) * bucketSize) + 1, count);
+
+      double avgX = 0.0;
+      double avgY = 0.0;
+      for (std::size_t i = nextFrom; i < nextTo; i++) {
+        avgX += x[i];
+        avgY += y[i];
+      }
+      std::size_t nextCount = nextTo - nextFrom;
+      avgX /= nextCount;
+      avgY /= nextCount;
+
+      double maxArea = -1.0;
+      std::size_t best = from;
+      for (std::size_t i = from; i < to; i++) {
+        double area = std::abs((x[selected] - avgX) * (y[i] - y[selected]) - (x[selected] - x[i]) * (avgY - y[selected]));
+        if (area > maxArea) {
+          maxArea = area;
+          best = i;
+        }
+      }
+      keep[best] = 1;
+      selected = best;
+    }
+  }
+
+  // Минимум и максимум ряда в каждой из buckets корзин
+  void selectMinMax(const double* y, std::size_t count, std::size_t buckets, std::vector<char>& keep) {
+    keep[0] = 1;
+    keep[count - 1] = 1;
+    for (std::size_t bucket = 0; bucket < buckets; bucket++) {
+      std::size_t from = bucket * count / buckets;
+      std::size_t to = (bucket + 1) * count / buckets;
+      if (from >= to) {
+        continue;
+      }
+      std::size_t minRow = from;
+      std::size_t maxRow = from;
+      for (std::size_t i = from + 1; i < to; i++) {
+        if (y[i] < y[minRow]) {
+          minRow = i;
+        }
+        if (y[i] > y[maxRow]) {
+          maxRow = i;
+        }
+      }
+      keep[minRow] = 1;
+      keep[maxRow] = 1;
+    }
+  }
+
+}
+
+TimeSeriesStore::TimeSeriesStore(int numSources, int numChannels)
+  : numSources(numSources), numChannels(numChannels), times(),
+  columns(static_cast<std::size_t>(4 * numSources + numChannels)), length(0) {}
+
+int TimeSeriesStore::getNumSources() const { return numSources; }
+int TimeSeriesStore::getNumChannels() const { return numChannels; }
+std::size_t TimeSeriesStore::getColumnCount() const { return columns.size(); }
+std::size_t TimeSeriesStore::getLength() const { return length; }
+std::size_t TimeSeriesStore::getCapacity() const { return times.capacity(); }
+
+std::size_t TimeSeriesStore::columnIndex(SeriesMetric metric, int entity) const {
+  // Четыре показателя по источникам, затем загрузка каналов
+  return static_cast<std::size_t>(static_cast<int>(metric) * numSources + entity - 1);
+}
+
+std::string TimeSeriesStore::columnName(std::size_t column) const {
+  int metric = std::min(static_cast<int>(column) / numSources, static_cast<int>(SeriesMetric::CHANNEL_LOAD));
+  int entity = static_cast<int>(column) - metric * numSources + 1;
+  return std::string(kMetricNames[metric]) + "_" + std::to_string(entity);
+}
+
+void TimeSeriesStore::reserve(std::size_t rows) {
+  times.reserve(rows);
+  for (auto& column : columns) {
+    column.reserve(rows);
+  }
+}
+
+void TimeSeriesStore::clear() {
+  times.clear();
+  for (auto& column : columns) {
+    column.clear();
+  }
+  length = 0;
+}
+
+void TimeSeriesStore::appendRow(double time, const double* values) {
+  if (length < times.size()) {
+    times[length] = time;
+    for (std::size_t c = 0; c < columns.size(); c++) {
+      columns[c][length] = values[c];
+    }
+  }
+  else {
+    times.push_back(time);
+    for (std::size_t c = 0; c < columns.size(); c++) {
+      columns[c].push_back(values[c]);
+    }
+  }
+  length++;
+}
+
+void TimeSeriesStore::setLength(std::size_t rows) {
+  if (rows > times.size()) {
+    throw std::runtime_error("Компактный снимок новее рядов снапшотов");
+  }
+  length = rows;
+}
+
+double TimeSeriesStore::timeAt(std::size_t row) const { return times[row]; }
+double TimeSeriesStore::valueAt(std::size_t column, std::size_t row) const { return columns[column][row]; }
+const double* TimeSeriesStore::columnData(std::size_t column) const { return columns[column].data(); }
+const double* TimeSeriesStore::timeData() const { return times.data(); }
+
+std::vector<std::size_t> TimeSeriesStore::selectRows(DownsampleMode mode, std::size_t maxPoints) const {
+  std::vector<std::size_t> rows;
+  if (mode == DownsampleMode::NONE || maxPoints < 3 || length <= maxPoints) {
+    rows.resize(length);
+    for (std::size_t i = 0; i < length; i++) {
+      rows[i] = i;
+    }
+    return rows;
+  }
+
+  std::vector<char> keep(length, 0);
+  for (const auto& column : columns) {
+    if (mode == DownsampleMode::LTTB) {
+      selectLttb(times.data(), column.data(), length, maxPoints, keep);
+    }
+    else {
+      selectMinMax(column.data(), length, std::max<std::size_t>(maxPoints / 2, 1), keep);
+    }
+  }
+  for (std::size_t i = 0; i < length; i++) {
+    if (keep[i]) {
+      rows.push_back(i);
+    }
+  }
+  return rows;
+}
+
+void TimeSeriesStore::exportCsv(const std::string& path, DownsampleMode mode, std::size_t maxPoints) const {
+  std::vector<std::size_t> rows = selectRows(mode, maxPoints);
+  BufferedFile file(path);
+
+  std::string header = "time";
+  for (std::size_t c = 0; c < columns.size(); c++) {
+    header += "," + columnName(c);
+  }
+  header += "\n";
+  file.write(header.data(), header.size());
+
+  for (std::size_t row : rows) {
+    file.writeNumber(times[row]);
+    for (const auto& column : columns) {
+      file.writeChar(',');
+      file.writeNumber(column[row]);
+    }
+    file.writeChar('\n');
+  }
+  file.close();
+}
+
+void TimeSeriesStore::exportBinary(const std::string& path, DownsampleMode mode, std::size_t maxPoints) const {
+  std::vector<std::size_t> rows = selectRows(mode, maxPoints);
+  bool allRows = rows.size() == length;
+
+  std::vector<std::string> names;
+  names.push_back("time");
+  for (std::size_t c = 0; c < columns.size(); c++) {
+    names.push_back(columnName(c));
+  }
+  std::uint64_t headerSize = 4 * sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t);
+  for (const auto& name : names) {
+    headerSize += sizeof(std::uint32_t) + name.size();
+  }
+  std::uint64_t dataOffset = (headerSize + 7) / 8 * 8;
+
+  BufferedFile file(path);
+  file.writePod(kSeriesMagic);
+  file.writePod(kSeriesVersion);
+  file.writePod(static_cast<std::uint32_t>(names.size()));
+  file.writePod(std::uint32_t(0));
+  file.writePod(static_cast<std::uint64_t>(rows.size()));
+  file.writePod(dataOffset);
+  for (const auto& name : names) {
+    file.writePod(static_cast<std::uint32_t>(name.size()));
+    file.write(name.data(), name.size());
+  }
+  for (std::uint64_t i = headerSize; i < dataOffset; i++) {
+    file.writeChar(0);
+  }
+
+  // Колонка целиком уходит одним блоком; при прореживании - выбранные строки
+  auto writeColumn = [&](const std::vector<double>& column) {
+    if (allRows) {
+      file.write(reinterpret_cast<const char*>(column.data()), length * sizeof(double));
+      return;
+    }
+    for (std::size_t row : rows) {
+      file.writePod(column[row]);
+    }
+  };
+  writeColumn(times);
+  for (const auto& column : columns) {
+    writeColumn(column);
+  }
+  file.close();
+}
+
+void TimeSeriesStore::printMetric(SeriesMetric metric) const {
+  int entities = (metric == SeriesMetric::CHANNEL_LOAD) ? numChannels : numSources;
+  for (std::size_t i = 0; i < length; ++i) {
+    for (int j = 1; j <= entities; j++) {
+      std::cout << times[i] << "\t" << j << "\t" << columns[columnIndex(metric, j)][i] << "\n";
+    }
+  }
+}
+
+void TimeSeriesStore::saveState(BinaryWriter& writer, bool withRows) const {
+  writer.writePod<unsigned long long>(length);
+  if (!withRows) {
+    return;
+  }
+  writer.writePod<unsigned long long>(columns.size());
+  writer.writePodArray(times.data(), length);
+  for (const auto& column : columns) {
+    writer.writePodArray(column.data(), length);
+  }
+}
+
+void TimeSeriesStore::loadState(BinaryReader& reader, bool withRows) {
+  std::size_t rows = static_cast<std::size_t>(reader.readPod<unsigned long long>());
+  if (!withRows) {
+    // Строки до этой длины уже посчитаны этим же прогоном
+    setLength(rows);
+    return;
+  }
+  if (reader.readPod<unsigned long long>() != columns.size()) {
+    throw std::runtime_error("Число рядов в контрольной точке не совпадает с конфигурацией");
+  }
+  times.resize(rows);
+  reader.readPodArray(times.data(), rows);
+  for (auto& column : columns) {
+    column.resize(rows);
+    reader.readPodArray(column.data(), rows);
+  }
+  length = rows;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+// TimeSeries.h
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Показатели рядов снапшотов (ОР2)
+enum class SeriesMetric {
+  REJECTION_RATE = 0, // p_отк по источникам
+  AVG_WAIT_TIME,      // avg T_ож по источникам
+  AVG_SERVICE_TIME,   // avg T_об по источникам
+  AVG_SYSTEM_TIME,    // avg T_преб по источникам
+  CHANNEL_LOAD,       // Загрузка по каналам
+  COUNT
+};
+
+// Прореживание рядов при выгрузке
+enum class DownsampleMode {
+  NONE,    // Все точки
+  MIN_MAX, // Минимум и максимум каждого ряда в каждой корзине
+  LTTB     // Largest-Triangle-Three-Buckets по каждому ряду
+};
+
+// Колоночное хранилище рядов снапшотов: по непрерывному массиву double на каждую пару
+// (показатель, источник/канал) и отдельный массив моментов времени.
+// Строка i - снапшот i. Число действительных строк - length: после перехода назад по шкале
+// времени строки не удаляются, повторные снапшоты перезаписывают их на месте
+class TimeSeriesStore {
+private:
+  int numSources;
+  int numChannels;
+  std::vector<double> times;
+  std::vector<std::vector<double>> columns; // [columnIndex][строка]
+  std::size_t length;
+
+public:
+  TimeSeriesStore(int numSources, int numChannels);
+
+  int getNumSources() const;
+  int getNumChannels() const;
+  std::size_t getColumnCount() const;
+  std::size_t getLength() const;
+  std::size_t getCapacity() const;
+
+  // Номер колонки: entity - номер источника или канала (с 1)
+  std::size_t columnIndex(SeriesMetric metric, int entity) const;
+  std::string columnName(std::size_t column) const;
+
+  void reserve(std::size_t rows); // Предварительное выделение под ожидаемое число снапшотов
+  void clear();
+
+  // Новая строка со значениями всех колонок в порядке columnIndex
+  void appendRow(double time, const double* values);
+  void setLength(std::size_t rows); // Только уменьшение или возврат к уже записанным строкам
+
+  double timeAt(std::size_t row) const;
+  double valueAt(std::size_t column, std::size_t row) const;
+  const double* columnData(std::size_t column) const;
+  const double* timeData() const;
+
+  // Номера строк, оставляемых прореживанием до ~maxPoints точек.
+  // Строки, выбранные для отдельных колонок, объединяются - пики каждого ряда сохраняются
+  std::vector<std::size_t> selectRows(DownsampleMode mode, std::size_t maxPoints) const;
+
+  // Выгрузка через буферизованную запись. CSV: time и все колонки в одной строке на снапшот.
+  // Двоичный колоночный файл (формат - в TimeSeries.cpp) читается numpy.memmap и т.п. без разбора
+  void exportCsv(const std::string& path, DownsampleMode mode = DownsampleMode::NONE, std::size_t maxPoints = 0) const;
+  void exportBinary(const std::string& path, DownsampleMode mode = DownsampleMode::NONE, std::size_t maxPoints = 0) const;
+
+  // Вывод в формате printGraphData: "Time\tномер\tзначение" по одному показателю
+  void printMetric(SeriesMetric metric) const;
+
+  // Контрольная точка. withRows = false - только длина (компактный снимок шкалы времени)
+  void saveState(BinaryWriter& writer, bool withRows) const;
+  void loadState(BinaryReader& reader, bool withRows);
+};
+
+#endif // TIME_SERIES_H
\ No newline at end of file
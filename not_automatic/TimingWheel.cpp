@@ -0,0 +1,165 @@
+// TimingWheel.cpp
+#include "TimingWheel.h"
+#include "Checkpoint.h"
+#include <bit> // Для std::countr_zero
+
+TimingWheel::TimingWheel(int capacity, double tickSize)
+  : tickSize(tickSize > 0 ? tickSize : 1.0), currentTick(0), armedCount(0),
+  heads(kLevels * kSlots, -1), slotMasks(),
+  next(capacity, -1), prev(capacity, -1), slotOf(capacity, -1), deadlines(capacity, 0.0) {}
+
+std::uint64_t TimingWheel::tickOf(double time) const {
+  double ticks = time / tickSize;
+  if (!(ticks > 0)) {
+    return 0;
+  }
+  return ticks >= 9.0e18 ? std::uint64_t(9.0e18) : static_cast<std::uint64_t>(ticks);
+}
+
+void TimingWheel::link(int id, std::uint64_t tick) {
+  if (tick < currentTick) {
+    tick = currentTick; // Просроченный - в слот текущего тика, выдается при ближайшем продвижении
+  }
+  // Уровень - по старшим разрядам, которые у срока и текущего тика еще совпадают
+  int level = 0;
+  while (level < kLevels - 1 && (tick >> (kSlotBits * (level + 1))) != (currentTick >> (kSlotBits * (level + 1)))) {
+    level++;
+  }
+  int slot = static_cast<int>((tick >> (kSlotBits * level)) & (kSlots - 1));
+  int bucket = level * kSlots + slot;
+
+  prev[id] = -1;
+  next[id] = heads[bucket];
+  if (heads[bucket] >= 0) {
+    prev[heads[bucket]] = id;
+  }
+  heads[bucket] = id;
+  slotOf[id] = bucket;
+  slotMasks[level] |= std::uint64_t(1) << slot;
+}
+
+void TimingWheel::unlink(int id) {
+  int bucket = slotOf[id];
+  if (prev[id] >= 0) {
+    next[prev[id]] = next[id];
+  }
+  else {
+    heads[bucket] = next[id];
+  }
+  if (next[id] >= 0) {
+    prev[next[id]] = prev[id];
+  }
+  if (heads[bucket] < 0) {
+    slotMasks[bucket / kSlots] &= ~(std::uint64_t(1) << (bucket % kSlots));
+  }
+  slotOf[id] = -1;
+}
+
+void TimingWheel::cascade(int level) {
+  int slot = static_cast<int>((currentTick >> (kSlotBits * level)) & (kSlots - 1));
+  int bucket = level * kSlots + slot;
+  int id = heads[bucket];
+  heads[bucket] = -1;
+  slotMasks[level] &= ~(std::uint64_t(1) << slot);
+  while (id >= 0) {
+    int following = next[id];
+    link(id, tickOf(deadlines[id])); // Старшие разряды теперь совпадают - попадет на уровень ниже
+    id = following;
+  }
+}
+
+void TimingWheel::arm(int id, double deadline) {
+  if (slotOf[id] >= 0) {
+    unlink(id);
+    armedCount--;
+  }
+  deadlines[id] = deadline;
+  link(id, tickOf(deadline));
+  armedCount++;
+}
+
+void TimingWheel::cancel(int id) {
+  if (slotOf[id] >= 0) {
+    unlink(id);
+    armedCount--;
+  }
+}
+
+bool TimingWheel::isArmed(int id) const { return slotOf[id] >= 0; }
+int TimingWheel::getArmedCount() const { return armedCount; }
+double TimingWheel::getTickSize() const { return tickSize; }
+
+void TimingWheel::advance(double now, std::vector<int>& expired) {
+  std::uint64_t target = tickOf(now);
+  for (;;) {
+    // Слот текущего тика: истекают сроки <= now, остальные ждут следующего вызова
+    int id = heads[currentTick & (kSlots - 1)];
+    while (id >= 0) {
+      int following = next[id];
+      if (deadlines[id] <= now) {
+        unlink(id);
+        armedCount--;
+        expired.push_back(id);
+      }
+      id = following;
+    }
+    if (currentTick >= target) {
+      return;
+    }
+    if (armedCount == 0) {
+      currentTick = target;
+      return;
+    }
+
+    // Ближайший тик, на котором есть что выдать или спустить: первый занятый слот
+    // после текущего на самом нижнем уровне, где такой есть
+    std::uint64_t nextTick = ~std::uint64_t(0);
+    for (int level = 0; level < kLevels; level++) {
+      int shift = kSlotBits * level;
+      int index = static_cast<int>((currentTick >> shift) & (kSlots - 1));
+      std::uint64_t later = index == kSlots - 1 ? 0 : slotMasks[level] & (~std::uint64_t(0) << (index + 1));
+      if (later) {
+        std::uint64_t slot = static_cast<std::uint64_t>(std::countr_zero(later));
+        std::uint64_t start = (((currentTick >> shift) & ~std::uint64_t(kSlots - 1)) | slot) << shift;
+        nextTick = start;
+        break;
+      }
+    }
+    if (nextTick > target) {
+      currentTick = target; // До target ни одной границы занятого слота - прыжок сразу
+      continue;
+    }
+
+    currentTick = nextTick;
+    for (int level = kLevels - 1; level >= 1; level--) {
+      std::uint64_t lowBits = (std::uint64_t(1) << (kSlotBits * level)) - 1;
+      if ((currentTick & lowBits) == 0) {
+        cascade(level);
+      }
+    }
+  }
+}
+
+void TimingWheel::saveState(BinaryWriter& writer) const {
+  writer.writePod(tickSize);
+  writer.writePod(currentTick);
+  writer.writePod(armedCount);
+  writer.writePodVector(heads);
+  writer.writePodArray(slotMasks, kLevels);
+  writer.writePodVector(next);
+  writer.writePodVector(prev);
+  writer.writePodVector(slotOf);
+  writer.writePodVector(deadlines);
+}
+
+void TimingWheel::loadState(BinaryReader& reader) {
+  reader.readPod(tickSize);
+  reader.readPod(currentTick);
+  reader.readPod(armedCount);
+  reader.readPodVector(heads);
+  reader.readPodArray(slotMasks, kLevels);
+  reader.readPodVector(next);
+  reader.readPodVector(prev);
+  reader.readPodVector(slotOf);
+  reader.readPodVector(deadlines);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+// TimingWheel.h
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstdint>
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Иерархическое колесо таймеров для сроков жизни (TTL) уведомлений в буфере.
+// Таймер - номер ячейки 0..capacity-1, у каждой ячейки не больше одного таймера.
+// Время делится на тики; уровень k - 64 слота по 64^k тиков, 11 уровней покрывают все 64 бита.
+// Слоты - двусвязные списки на массивах по номеру ячейки: взвод и отмена O(1) без выделения памяти.
+// При продвижении времени пустые участки пропускаются по битовым маскам занятых слотов,
+// слоты верхних уровней спускаются вниз (каскад), слот текущего тика выдается пачкой
+class TimingWheel {
+public:
+  static const int kSlotBits = 6;
+  static const int kSlots = 1 << kSlotBits;
+  static const int kLevels = 11;
+
+private:
+  double tickSize; // Длина тика в модельном времени
+  std::uint64_t currentTick; // Тик, до которого колесо продвинуто
+  int armedCount;
+  std::vector<int> heads; // Начало списка слота: [уровень * kSlots + слот], -1 - пусто
+  std::uint64_t slotMasks[kLevels]; // Занятые слоты каждого уровня
+  std::vector<int> next; // Связи списков по номеру таймера
+  std::vector<int> prev;
+  std::vector<int> slotOf; // Слот, в котором стоит таймер; -1 - не взведен
+  std::vector<double> deadlines; // Точный срок - тик только выбирает слот
+
+  std::uint64_t tickOf(double time) const;
+  void link(int id, std::uint64_t tick);
+  void unlink(int id);
+  void cascade(int level); // Раздать слот текущего тика уровня level по нижним уровням
+
+public:
+  TimingWheel(int capacity = 0, double tickSize = 1.0);
+
+  void arm(int id, double deadline); // Взвести (перевзвести) таймер
+  void cancel(int id); // Снять таймер; не взведенный - без действий
+  bool isArmed(int id) const;
+  int getArmedCount() const;
+  double getTickSize() const;
+
+  // Продвинуть время до now: в expired дописываются таймеры со сроком <= now (они снимаются)
+  void advance(double now, std::vector<int>& expired);
+
+  // Контрольная точка: слоты и сроки целиком - выдача после загрузки совпадает с исходной
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+#endif // TIMING_WHEEL_H
\ No newline at end of file
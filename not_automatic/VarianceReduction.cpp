@@ -0,0 +1,148 @@
+// VarianceReduction.cpp
+#include "VarianceReduction.h"
+#include "PushNotificationSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+  struct Response {
+    double rejection; // p_отк
+    double wait; // T_ож
+  };
+
+  Response runOnce(const SimulationConfig& config, unsigned seed, bool antithetic) {
+    SimulationConfig run = config;
+    run.seed = seed;
+    run.antithetic = antithetic;
+    run.snapshotInterval = 0;
+    PushNotificationSystem system(run);
+    system.runHeadless();
+    return { system.getDatabase().getRejectionRate(), system.getDatabase().getAvgWaitTime() };
+  }
+
+  // Парные разности одной схемы; cost - прогонов каждой конфигурации на одно наблюдение
+  struct Differences {
+    const char* name;
+    int cost;
+    std::vector<double> rejection;
+    std::vector<double> wait;
+  };
+
+  struct Summary {
+    double mean;
+    double variance;
+  };
+
+  Summary summarize(const std::vector<double>& values) {
+    Summary summary{ 0.0, 0.0 };
+    for (double value : values) {
+      summary.mean += value / values.size();
+    }
+    for (double value : values) {
+      summary.variance += (value - summary.mean) * (value - summary.mean);
+    }
+    summary.variance = values.size() > 1 ? summary.variance / (values.size() - 1) : 0.0;
+    return summary;
+  }
+
+  // Прогонов каждой конфигурации, чтобы полуширина интервала стала delta * |среднее|
+  long long requiredRuns(const Summary& summary, int cost, const ComparisonSpec& spec) {
+    if (summary.mean == 0.0) {
+      return 0;
+    }
+    double observations = std::ceil(spec.tAlpha * spec.tAlpha * summary.variance / (spec.delta * spec.delta * summary.mean * summary.mean));
+    return std::max(1LL, static_cast<long long>(observations)) * cost;
+  }
+
+}
+
+SimulationConfig comparisonVariant(const SimulationConfig& base, const std::string& change) {
+  std::size_t equals = change.find('=');
+  if (equals == std::string::npos) {
+    throw std::invalid_argument("Вариант задается как buffer=N или channels=N: " + change);
+  }
+  std::string name = change.substr(0, equals);
+  int value = std::stoi(change.substr(equals + 1));
+  SimulationConfig variant = base;
+  if (name == "buffer" && value > 0) {
+    variant.bufferCapacity = value;
+  }
+  else if (name == "channels" && value > 0 && !base.channels.empty()) {
+    variant.channels.resize(value, base.channels.back());
+    for (int i = 0; i < value; i++) {
+      variant.channels[i].id = i + 1;
+    }
+    // Добавленные копии - следующие приоритеты, как в схеме "asc" варианта 17
+    for (std::size_t i = base.channels.size(); i < variant.channels.size(); i++) {
+      variant.channels[i].priority = variant.channels[i - 1].priority + 1;
+    }
+  }
+  else {
+    throw std::invalid_argument("Вариант: buffer=N или channels=N (N > 0): " + change);
+  }
+  return variant;
+}
+
+void runComparison(const SimulationConfig& a, const SimulationConfig& b, const ComparisonSpec& spec) {
+  int n = std::max(2, spec.replications);
+  int pairs = std::max(2, n / 2);
+
+  Differences independent{ "независимые", 1, {}, {} };
+  Differences common{ "CRN", 1, {}, {} };
+  Differences antithetic{ "CRN + антитет.", 2, {}, {} };
+  for (int r = 0; r < n; r++) {
+    // Независимые: у B свои зерна, не пересекающиеся с зернами A
+    Response ra = runOnce(a, spec.seed + r, false);
+    Response rb = runOnce(b, spec.seed + n + r, false);
+    independent.rejection.push_back(rb.rejection - ra.rejection);
+    independent.wait.push_back(rb.wait - ra.wait);
+    // CRN: то же зерно - те же потоки источников и каналов
+    Response rc = runOnce(b, spec.seed + r, false);
+    common.rejection.push_back(rc.rejection - ra.rejection);
+    common.wait.push_back(rc.wait - ra.wait);
+  }
+  for (int r = 0; r < pairs; r++) {
+    // Наблюдение - среднее по паре (U и 1 - U), для каждой конфигурации на общих числах
+    Response a1 = runOnce(a, spec.seed + r, false);
+    Response a2 = runOnce(a, spec.seed + r, true);
+    Response b1 = runOnce(b, spec.seed + r, false);
+    Response b2 = runOnce(b, spec.seed + r, true);
+    antithetic.rejection.push_back((b1.rejection + b2.rejection - a1.rejection - a2.rejection) / 2.0);
+    antithetic.wait.push_back((b1.wait + b2.wait - a1.wait - a2.wait) / 2.0);
+  }
+
+  std::cout << "===== Сравнение конфигураций: B - A =====\n";
+  std::cout << "A: буфер " << a.bufferCapacity << ", каналов " << a.channels.size() << "; B: буфер " << b.bufferCapacity
+    << ", каналов " << b.channels.size() << "; заявок на прогон " << a.maxNotifications << ", t_alpha " << spec.tAlpha
+    << ", delta " << spec.delta << "\n";
+  std::cout << "Схема          | Прогонов | p_отк: B - A        | Нужно прогонов | Сокращение | T_ож: B - A         | Нужно прогонов | Сокращение\n";
+  std::cout << "---------------|----------|---------------------|----------------|------------|---------------------|----------------|-----------\n";
+
+  Summary baseRejection = summarize(independent.rejection);
+  Summary baseWait = summarize(independent.wait);
+  for (const Differences* scheme : { &independent, &common, &antithetic }) {
+    Summary rejection = summarize(scheme->rejection);
+    Summary wait = summarize(scheme->wait);
+    double rejectionHalf = spec.tAlpha * std::sqrt(rejection.variance / scheme->rejection.size());
+    double waitHalf = spec.tAlpha * std::sqrt(wait.variance / scheme->wait.size());
+    // Сокращение - отношение затрат на одинаковую точность: дисперсия * стоимость наблюдения
+    auto reduction = [&](const Summary& base, const Summary& own) {
+      return own.variance > 0 ? base.variance / (own.variance * scheme->cost) : 0.0;
+    };
+    std::cout << std::left << std::setw(14) << scheme->name << std::right << " | "
+      << std::setw(8) << scheme->rejection.size() * scheme->cost << " | "
+      << std::fixed << std::setprecision(5) << std::setw(8) << rejection.mean << " +- " << std::setw(7) << rejectionHalf << " | "
+      << std::setw(14) << requiredRuns(rejection, scheme->cost, spec) << " | "
+      << std::setprecision(1) << std::setw(10) << reduction(baseRejection, rejection) << " | "
+      << std::setprecision(4) << std::setw(8) << wait.mean << " +- " << std::setw(7) << waitHalf << " | "
+      << std::setw(14) << requiredRuns(wait, scheme->cost, spec) << " | "
+      << std::setprecision(1) << std::setw(9) << reduction(baseWait, wait) << "\n";
+  }
+  std::cout << "Прогонов - каждой конфигурации; нужно - для полуширины delta * |B - A| по своей оценке разности,\n"
+    << "сокращение - во сколько раз меньше прогонов при той же точности, чем у независимых\n";
+}
\ No newline at end of file
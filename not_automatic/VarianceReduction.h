@@ -0,0 +1,28 @@
+// VarianceReduction.h
+#ifndef VARIANCE_REDUCTION_H
+#define VARIANCE_REDUCTION_H
+
+#include "SimulationConfig.h"
+#include <string>
+
+// Сравнение двух конфигураций (3 против 4 каналов, буфер 5 против 8) с понижением дисперсии.
+// Общие случайные числа (CRN): у каждого источника и канала свой поток по (зерно, вид, номер) -
+// см. PushNotificationSystem::streamSeed, поэтому при одном зерне источник i и канал j получают
+// одни и те же числа в обеих конфигурациях. Антитетическая пара - прогон с тем же зерном,
+// где все потоки выдают 1 - U (SimulationConfig::antithetic)
+struct ComparisonSpec {
+  int replications = 20; // Прогонов каждой конфигурации на схему (антитетических пар - вдвое меньше)
+  unsigned seed = 17;
+  double tAlpha = 1.643; // T_ALPHA из automatic/CMO.py - доверительная вероятность 0.9
+  double delta = 0.1; // DELTA из automatic/CMO.py - относительная точность
+};
+
+// Разность откликов B - A (p_отк и T_ож) по трем схемам: независимые прогоны, CRN, CRN с антитетическими
+// парами. Для каждой - среднее и полуширина интервала по парным разностям, число прогонов каждой
+// конфигурации для точности delta и сокращение этого числа против независимых прогонов
+void runComparison(const SimulationConfig& a, const SimulationConfig& b, const ComparisonSpec& spec);
+
+// Вторая конфигурация из первой: "buffer=N" или "channels=N" (недостающие каналы - копии последнего)
+SimulationConfig comparisonVariant(const SimulationConfig& base, const std::string& change);
+
+#endif // VARIANCE_REDUCTION_H
\ No newline at end of file
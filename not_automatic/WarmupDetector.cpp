@@ -0,0 +1,118 @@
+// WarmupDetector.cpp
+#include "WarmupDetector.h"
+#include "Checkpoint.h"
+#include <algorithm>
+
+WarmupDetector::WarmupDetector(int batchSize, int capacity, int minBatches)
+  : batchSize(std::max(0, batchSize)), capacity(std::max(8, capacity / 2 * 2)), minBatches(std::min(std::max(4, minBatches), this->capacity)),
+  current{ 0.0, 0.0, 0.0, 0.0, 0.0 }, lastTime(0.0), lastOccupancy(0.0), lastWaitSum(0.0), lastWaited(0),
+  detected(false), truncationTime(0.0) {
+  batches.reserve(this->capacity);
+}
+
+bool WarmupDetector::isActive() const { return batchSize > 0 && !detected; }
+
+bool WarmupDetector::observe(double now, int bufferOccupancy, double totalWaitTime, long long waitedCount) {
+  // Заполнение до этого события держалось с прошлого наблюдения
+  current.occupancyIntegral += lastOccupancy * (now - lastTime);
+  current.duration += now - lastTime;
+  current.waitSum += totalWaitTime - lastWaitSum;
+  current.waited += static_cast<double>(waitedCount - lastWaited);
+  lastTime = now;
+  lastOccupancy = bufferOccupancy;
+  lastWaitSum = totalWaitTime;
+  lastWaited = waitedCount;
+  if (current.waited < getBatchLength()) {
+    return false;
+  }
+
+  current.endTime = now;
+  batches.push_back(current);
+  current = Batch{ 0.0, 0.0, 0.0, 0.0, 0.0 };
+  int count = static_cast<int>(batches.size());
+  bool decided = false;
+  if (count >= minBatches) {
+    int d = std::max(mserPoint(false), mserPoint(true));
+    if (d <= count / 2) {
+      detected = true;
+      truncationTime = d > 0 ? batches[d - 1].endTime : 0.0;
+      decided = true;
+    }
+  }
+  if (!decided && count == capacity) {
+    mergePairs();
+  }
+  return decided;
+}
+
+int WarmupDetector::mserPoint(bool occupancy) const {
+  // Суммы хвоста j > d накапливаются с конца: все d за один проход
+  int count = static_cast<int>(batches.size());
+  double sum = 0.0;
+  double sumSquared = 0.0;
+  double bestValue = 0.0;
+  int best = count - 1;
+  for (int d = count - 1; d >= 0; d--) {
+    const Batch& batch = batches[d];
+    double value = occupancy ? (batch.duration > 0 ? batch.occupancyIntegral / batch.duration : 0.0)
+      : (batch.waited > 0 ? batch.waitSum / batch.waited : 0.0);
+    sum += value;
+    sumSquared += value * value;
+    double n = count - d;
+    // Хвосты короче двух пачек не сравниваются: у них статистика вырождается в 0
+    if (n < 2) {
+      continue;
+    }
+    double statistic = (sumSquared - sum * sum / n) / (n * n);
+    if (n == 2 || statistic <= bestValue) {
+      bestValue = statistic;
+      best = d;
+    }
+  }
+  return best;
+}
+
+void WarmupDetector::mergePairs() {
+  int half = static_cast<int>(batches.size()) / 2;
+  for (int i = 0; i < half; i++) {
+    const Batch& a = batches[2 * i];
+    const Batch& b = batches[2 * i + 1];
+    batches[i] = Batch{ a.waitSum + b.waitSum, a.waited + b.waited, a.occupancyIntegral + b.occupancyIntegral,
+      a.duration + b.duration, b.endTime };
+  }
+  batches.resize(half);
+  batchSize *= 2;
+}
+
+bool WarmupDetector::isDetected() const { return detected; }
+double WarmupDetector::getTruncationTime() const { return truncationTime; }
+int WarmupDetector::getBatchCount() const { return static_cast<int>(batches.size()); }
+int WarmupDetector::getBatchLength() const { return batchSize; }
+
+void WarmupDetector::saveState(BinaryWriter& writer) const {
+  writer.writePod(batchSize);
+  writer.writePod(capacity);
+  writer.writePod(minBatches);
+  writer.writePodVector(batches);
+  writer.writePod(current);
+  writer.writePod(lastTime);
+  writer.writePod(lastOccupancy);
+  writer.writePod(lastWaitSum);
+  writer.writePod(lastWaited);
+  writer.writePod(detected);
+  writer.writePod(truncationTime);
+}
+
+void WarmupDetector::loadState(BinaryReader& reader) {
+  reader.readPod(batchSize);
+  reader.readPod(capacity);
+  reader.readPod(minBatches);
+  reader.readPodVector(batches);
+  reader.readPod(current);
+  reader.readPod(lastTime);
+  reader.readPod(lastOccupancy);
+  reader.readPod(lastWaitSum);
+  reader.readPod(lastWaited);
+  reader.readPod(detected);
+  reader.readPod(truncationTime);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+// WarmupDetector.h
+#ifndef WARMUP_DETECTOR_H
+#define WARMUP_DETECTOR_H
+
+#include <vector>
+
+class BinaryWriter;
+class BinaryReader;
+
+// Определение конца переходного режима по правилу MSER (при пачке из 5 доставок - MSER-5).
+// Наблюдения - средние по пачкам: T_ож по доставкам и заполнение буфера, усредненное по времени.
+// Для каждого ряда Z_1..Z_m точка отсечения d минимизирует sum_{j>d} (Z_j - среднее_d)^2 / (m - d)^2;
+// конец разгона найден, когда для обоих рядов d лежит в первой половине ряда (d <= m / 2).
+// Память постоянна: при заполнении соседние пачки сливаются попарно (пачка вдвое длиннее)
+class WarmupDetector {
+private:
+  // Пачка хранит суммы, а не средние - слияние точное
+  struct Batch {
+    double waitSum;
+    double waited;
+    double occupancyIntegral;
+    double duration;
+    double endTime;
+  };
+
+  int batchSize; // Доставок в пачке; 0 - определение выключено
+  int capacity; // Пачек в памяти (четное)
+  int minBatches; // Раньше стольких пачек решение не принимается
+  std::vector<Batch> batches;
+  Batch current; // Незаконченная пачка
+  double lastTime; // Момент прошлого наблюдения - для интеграла заполнения
+  double lastOccupancy;
+  double lastWaitSum; // Накопленные итоги Database на прошлом наблюдении
+  long long lastWaited;
+  bool detected;
+  double truncationTime; // Конец разгона по MSER
+
+  int mserPoint(bool occupancy) const; // Точка отсечения по одному ряду
+  void mergePairs();
+
+public:
+  WarmupDetector(int batchSize = 0, int capacity = 256, int minBatches = 40);
+
+  bool isActive() const; // Включено и еще не сработало
+  // После каждого события: момент, заполнение буфера и накопленные в Database сумма и число T_ож.
+  // true - разгон только что найден (один раз); накопленные итоги после этого можно сбросить
+  bool observe(double now, int bufferOccupancy, double totalWaitTime, long long waitedCount);
+
+  bool isDetected() const;
+  double getTruncationTime() const;
+  int getBatchCount() const;
+  int getBatchLength() const; // Доставок в пачке сейчас (batchSize, удвоенный при слияниях)
+
+  void saveState(BinaryWriter& writer) const;
+  void loadState(BinaryReader& reader);
+};
+
+#endif // WARMUP_DETECTOR_H
\ No newline at end of file
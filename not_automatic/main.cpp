@@ -1,14 +1,332 @@
 // main.cpp
 #include "PushNotificationSystem.h"
+#include "Benchmark.h"
+#include "Sweep.h"
+#include "ShardedSimulation.h"
+#include "ReplicationFarm.h"
+#include "RareEventEstimator.h"
+#include "VarianceReduction.h"
+#include "AnalyticalModel.h"
+#include "CapacityPlanner.h"
 #include <iostream>
+#include <iomanip>
+#include <algorithm>
 #include <exception>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
 
-int main() {
+int main(int argc, char* argv[]) {
   try {
-    //    3 ,   5, 3 
-    PushNotificationSystem system(3, 5, 3, 20); //   
+    std::string mode = (argc > 1) ? argv[1] : "";
 
-    //   
+    if (mode == "--bench") {
+      // Замер процессной модели: --bench [заявок] [seed]
+      int maxNotifs = (argc > 2) ? std::atoi(argv[2]) : 1000000;
+      unsigned seed = (argc > 3) ? static_cast<unsigned>(std::atoi(argv[3])) : 17;
+      return runEngineBenchmark(3, 5, maxNotifs, seed) ? 0 : 1;
+    }
+
+    if (mode == "--alloc-bench") {
+      // Выделения в установившемся режиме: --alloc-bench [файл.ini | -] [разгон событий] [событий замера]
+      // Только в сборке с -DNOTIFYME_COUNT_ALLOCATIONS; код возврата 1 - были выделения.
+      // По умолчанию - Вариант 17 с рядами снапшотов и MSER-5: сброс статистики попадает в замер
+      std::string path = (argc > 2) ? argv[2] : "-";
+      SimulationConfig config = SimulationConfig::variant17(3, 5, 3, 0, 17);
+      if (path == "-") {
+        config.snapshotInterval = 1;
+        config.warmupBatch = 5;
+      }
+      else {
+        config = SimulationConfig::fromFile(path);
+      }
+      long long warmup = (argc > 3) ? std::atoll(argv[3]) : (path == "-" ? 100 : 100000);
+      long long measured = (argc > 4) ? std::atoll(argv[4]) : 1000000;
+      return runAllocationBenchmark(config, warmup, measured) ? 0 : 1;
+    }
+
+    if (mode == "--checkpoint-save" && argc > 3) {
+      // Разогрев и сохранение: --checkpoint-save <файл> <заявок> [seed]
+      unsigned seed = (argc > 4) ? static_cast<unsigned>(std::atoi(argv[4])) : 0;
+      PushNotificationSystem system(3, 5, 3, std::atoi(argv[3]), seed);
+      system.runHeadless();
+      system.saveCheckpoint(argv[2]);
+      std::cout << "Контрольная точка сохранена: " << argv[2] << ", модельное время " << system.getCurrentTime() << "\n";
+      return 0;
+    }
+
+    if (mode == "--checkpoint-resume" && argc > 3) {
+      // Продолжение от контрольной точки: --checkpoint-resume <файл> <заявок всего>
+      PushNotificationSystem system(3, 5, 3);
+      system.loadCheckpoint(argv[2]);
+      system.setMaxNotifications(std::atoll(argv[3]));
+      system.runHeadless();
+      system.finalizeSimulation();
+      return 0;
+    }
+
+    if (mode == "--checkpoint-verify") {
+      // Проверка побитовой идентичности: --checkpoint-verify [разогрев] [всего] [seed]
+      int warmup = (argc > 2) ? std::atoi(argv[2]) : 200000;
+      int total = (argc > 3) ? std::atoi(argv[3]) : 400000;
+      unsigned seed = (argc > 4) ? static_cast<unsigned>(std::atoi(argv[4])) : 17;
+      return runCheckpointBenchmark(warmup, total, seed, "notifyme.ckpt") ? 0 : 1;
+    }
+
+    if (mode == "--timetravel-bench") {
+      // Переходы по шкале времени: --timetravel-bench [событий] [интервал снимков] [seed]
+      long long events = (argc > 2) ? std::atoll(argv[2]) : 10000000;
+      int interval = (argc > 3) ? std::atoi(argv[3]) : 4096;
+      unsigned seed = (argc > 4) ? static_cast<unsigned>(std::atoi(argv[4])) : 17;
+      return runTimeTravelBenchmark(events, interval, seed) ? 0 : 1;
+    }
+
+    if (mode == "--export-series" && argc > 2) {
+      // Выгрузка рядов: --export-series <префикс> [заявок] [интервал снапшотов] [точек] [lttb|minmax] [seed]
+      int maxNotifs = (argc > 3) ? std::atoi(argv[3]) : 1000000;
+      int interval = (argc > 4) ? std::atoi(argv[4]) : 100;
+      std::size_t maxPoints = (argc > 5) ? static_cast<std::size_t>(std::atoll(argv[5])) : 0;
+      std::string method = (argc > 6) ? argv[6] : "lttb";
+      unsigned seed = (argc > 7) ? static_cast<unsigned>(std::atoi(argv[7])) : 17;
+      DownsampleMode downsample = (maxPoints == 0) ? DownsampleMode::NONE
+        : (method == "minmax") ? DownsampleMode::MIN_MAX : DownsampleMode::LTTB;
+      runSeriesExport(maxNotifs, interval, argv[2], downsample, maxPoints, seed);
+      return 0;
+    }
+
+    if (mode == "--serve-metrics" && argc > 2) {
+      // Прогон с живыми метриками: --serve-metrics <адрес> [заявок] [seed] [ждать после прогона, с]
+      int maxNotifs = (argc > 3) ? std::atoi(argv[3]) : 100000000;
+      unsigned seed = (argc > 4) ? static_cast<unsigned>(std::atoi(argv[4])) : 17;
+      int lingerSeconds = (argc > 5) ? std::atoi(argv[5]) : 0;
+      MetricsServer server(argv[2]);
+      std::cout << "Метрики: " << argv[2] << " (GET /metrics)" << std::endl;
+      PushNotificationSystem system(3, 5, 3, maxNotifs, seed);
+      system.setSnapshotInterval(0); // Ряды графиков не нужны - все видно в метриках
+      system.attachMetrics(&server);
+      system.runHeadless();
+      system.finalizeSimulation();
+      std::this_thread::sleep_for(std::chrono::seconds(lingerSeconds));
+      std::cout << "Запросов метрик: " << server.getScrapes() << "\n";
+      return 0;
+    }
+
+    if (mode == "--sweep" && argc > 2) {
+      // Серия прогонов: --sweep <результаты.csv> [lambda=0.3:0.9:0.1] [buffer=3,5,10] [channels=1:5]
+      //   [priorities=asc,desc,equal] [notifs=100000] [sources=3] [seed=17] [replications=1] [threads=0] [prescreen=0|1]
+      SweepSpec spec;
+      for (int i = 3; i < argc; i++) {
+        spec.setParameter(argv[i]);
+      }
+      runSweep(spec, argv[2]);
+      return 0;
+    }
+
+    if (mode == "--analytic" && argc > 2) {
+      // Аналитическая оценка сценария: --analytic <файл.ini>
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      auto start = std::chrono::steady_clock::now();
+      AnalyticalEstimate estimate = estimateAnalytically(config);
+      double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+      if (!estimate.applicable) {
+        std::cout << "Модель неприменима: " << estimate.reason << "\n";
+        return 1;
+      }
+      std::cout << (estimate.exact ? "M/M/c/K (точно)" : "M/G/c/K (приближение)") << ": lambda " << estimate.arrivalRate
+        << ", mu " << estimate.serviceRate << ", cs^2 " << estimate.serviceScv << ", rho " << estimate.offeredLoad << "\n";
+      std::cout << "p_отк = " << estimate.rejection << ", T_ож = " << estimate.wait << ", очередь " << estimate.queueLength
+        << ", загрузка " << estimate.utilization << (estimate.settled ? " (исход ясен без прогона)" : "")
+        << "; " << micros << " мкс\n";
+      return 0;
+    }
+
+    if (mode == "--plan" && argc > 2) {
+      // Самая дешевая конфигурация под ограничения: --plan <файл.ini> [rejection=0.01] [wait99=10] [channels=1:12]
+      //   [buffer=64] [layouts=asc,desc,equal] [reps=8] [max_reps=64] [slot_cost=0.1] [seed=17] [threads=0]
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      PlanSpec spec;
+      for (int i = 3; i < argc; i++) {
+        spec.setParameter(argv[i]);
+      }
+      auto start = std::chrono::steady_clock::now();
+      PlanCandidate best = planCapacity(config, spec);
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (!best.feasible) {
+        std::cout << "Ни одна конфигурация до " << spec.maxChannels << " каналов и " << spec.maxBuffer
+          << " мест не выполняет ограничений (" << seconds << " с)\n";
+        return 1;
+      }
+      std::cout << "Самая дешевая: каналов " << best.channels << ", буфер " << best.bufferCapacity << ", схема " << best.layout
+        << ", стоимость " << best.cost << "\n"
+        << "p_отк = " << best.rejection << " +- " << best.rejectionHalf << " (<= " << spec.maxRejection << "), T_ож p99 = "
+        << best.waitP99 << " +- " << best.waitP99Half << " (<= " << spec.maxWaitP99 << "); реплик " << best.replications
+        << ", доверительная вероятность по каждому ограничению 0.9; " << seconds << " с\n";
+      return 0;
+    }
+
+    if (mode == "--plan-verify") {
+      // Самопроверка планировщика на крайних буферах: --plan-verify [threads]
+      unsigned threads = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2])) : 0;
+      return verifyPlanner(threads) ? 0 : 1;
+    }
+
+    if (mode == "--analytic-validate") {
+      // Проверка модели на сетке серии: --analytic-validate [параметры серии, как у --sweep]
+      SweepSpec spec;
+      for (int i = 2; i < argc; i++) {
+        spec.setParameter(argv[i]);
+      }
+      runAnalyticValidation(spec);
+      return 0;
+    }
+
+    if (mode == "--dispatch-compare" && argc > 2) {
+      // Сравнение политик выбора канала на одном сценарии: --dispatch-compare <файл.ini> [d]
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      if (argc > 3) {
+        config.dispatchChoices = std::max(1, std::atoi(argv[3]));
+      }
+      runDispatchComparison(config);
+      return 0;
+    }
+
+    if (mode == "--autoscale-compare" && argc > 2) {
+      // Задержка и отказы против канало-времени для политик автомасштабирования: --autoscale-compare <файл.ini>
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      runAutoscaleComparison(config);
+      return 0;
+    }
+
+    if (mode == "--shard-bench" && argc > 2) {
+      // Ускорение от числа шардов: --shard-bench <файл.ini> [шардов, по умолчанию ядер] [задержка передачи]
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      int maxShards = (argc > 3) ? std::atoi(argv[3]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+      double forwardDelay = (argc > 4) ? std::atof(argv[4]) : 1.0;
+      if (forwardDelay <= 0) {
+        std::cerr << "Задержка передачи должна быть положительной - это запас окна синхронизации\n";
+        return 1;
+      }
+      return runShardBenchmark(config, std::max(1, maxShards), forwardDelay) ? 0 : 1;
+    }
+
+    if (mode == "--farm" && argc > 3) {
+      // Координатор фермы реплик: --farm <адрес> <файл.ini> [реплик] [локальных рабочих] [seed] [таймаут реплики, с]
+      // Рабочие на других машинах: --farm-worker хост:порт (адрес координатора - 0.0.0.0:порт)
+      FarmSpec spec;
+      spec.address = argv[2];
+      spec.scenarioPath = argv[3];
+      spec.replications = (argc > 4) ? std::max(1, std::atoi(argv[4])) : 100;
+      spec.localWorkers = (argc > 5) ? std::max(0, std::atoi(argv[5])) : static_cast<int>(std::thread::hardware_concurrency());
+      spec.seed = (argc > 6) ? static_cast<unsigned>(std::atoi(argv[6])) : 17;
+      if (argc > 7) {
+        spec.workerTimeout = std::max(1.0, std::atof(argv[7]));
+      }
+      spec.workerProgram = argv[0];
+      return runFarmCoordinator(spec) == spec.replications ? 0 : 1;
+    }
+
+    if (mode == "--farm-worker" && argc > 2) {
+      // Рабочий фермы: --farm-worker <адрес координатора>
+      runFarmWorker(argv[2]);
+      return 0;
+    }
+
+    if (mode == "--rare" && argc > 2) {
+      // Малые p_отк расщеплением: --rare <файл.ini> [реплик] [пороги a,b,c | auto] [кратности r | r1,r2,r3]
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      SplittingSpec spec;
+      spec.replications = (argc > 3) ? std::atoi(argv[3]) : spec.replications;
+      auto parseList = [](const std::string& text) {
+        std::vector<int> values;
+        std::size_t begin = 0;
+        while (text != "auto" && begin <= text.size()) {
+          std::size_t comma = text.find(',', begin);
+          values.push_back(std::stoi(text.substr(begin, comma - begin)));
+          begin = (comma == std::string::npos) ? text.size() + 1 : comma + 1;
+        }
+        return values;
+      };
+      if (argc > 4) {
+        spec.thresholds = parseList(argv[4]);
+      }
+      if (argc > 5) {
+        spec.factors = parseList(argv[5]);
+      }
+      runSplittingReport(config, spec);
+      return 0;
+    }
+
+    if (mode == "--crn-compare" && argc > 3) {
+      // Сравнение двух конфигураций: --crn-compare <a.ini> <b.ini | buffer=N | channels=N> [прогонов] [seed]
+      SimulationConfig a = SimulationConfig::fromFile(argv[2]);
+      std::string change = argv[3];
+      SimulationConfig b = (change.find('=') != std::string::npos) ? comparisonVariant(a, change) : SimulationConfig::fromFile(change);
+      ComparisonSpec spec;
+      spec.replications = (argc > 4) ? std::atoi(argv[4]) : spec.replications;
+      spec.seed = (argc > 5) ? static_cast<unsigned>(std::atoi(argv[5])) : a.seed;
+      runComparison(a, b, spec);
+      return 0;
+    }
+
+    if (mode == "--scenario" && argc > 2) {
+      // Прогон сценария из файла: --scenario <файл.ini> [report] - report печатает полные таблицы ОР1/ОР2
+      auto start = std::chrono::steady_clock::now();
+      SimulationConfig config = SimulationConfig::fromFile(argv[2]);
+      PushNotificationSystem system(config);
+      double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "Сценарий " << argv[2] << ": источников " << config.sources.size() << ", каналов "
+        << config.channels.size() << ", буфер " << config.bufferCapacity << ", построен за "
+        << buildSeconds * 1000.0 << " мс" << std::endl;
+
+      start = std::chrono::steady_clock::now();
+      system.runHeadless();
+      double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      const Database& database = system.getDatabase();
+      std::cout << "Прогон: " << runSeconds << " с, событий " << system.getProcessedEvents()
+        << ", модельное время " << system.getCurrentTime() << "\n";
+      std::cout << "Доставлено: " << database.getDeliveredCount() << ", вытеснено: " << database.getRejectedCount()
+        << ", истекло по TTL: " << database.getExpiredCount() << ", объединено: " << database.getCoalescedCount()
+        << ", повторов: " << database.getRetryCount() << ", не пропущено на входе: " << database.getThrottledCount()
+        << ", p_отк = " << database.getRejectionRate() << ", T_ож = " << database.getAvgWaitTime() << "\n";
+      if (system.getWarmupResetTime() >= 0) {
+        std::cout << "Разгон (MSER-" << config.warmupBatch << "): до t = " << system.getWarmup().getTruncationTime()
+          << ", статистика с t = " << system.getWarmupResetTime() << "\n";
+      }
+      if (config.precision > 0) {
+        std::cout << "Точность " << config.precision << " по Таблице 1 (метод пачек): "
+          << (system.isPrecisionReached() ? "достигнута" : "не достигнута") << ", сгенерировано " << database.getGeneratedCount() << "\n";
+      }
+      if (system.getRetryPool().getCapacity() > 0) {
+        std::cout << "Пул повторов: " << system.getRetryPool().getCapacity() << " ячеек, максимум занято "
+          << system.getRetryPool().getPeakInUse() << ", не поместилось " << system.getRetryPool().getOverflows() << "\n";
+      }
+      UtilizationBalance balance = database.getUtilizationBalance(system.getCurrentTime());
+      std::cout << "Загрузка каналов: мин " << balance.min << ", макс " << balance.max << ", индекс Джейна " << balance.jain
+        << "; T_ож p99 = " << database.getWaitHistogram().quantile(0.99)
+        << ", T_отклика p99 = " << database.getResponseHistogram().quantile(0.99) << "\n";
+      if (system.getAutoscaler().isEnabled()) {
+        double channelHours = database.getChannelHours(system.getCurrentTime());
+        std::cout << "Автомасштабирование: канало-время " << channelHours << " (в среднем "
+          << channelHours / system.getCurrentTime() << " каналов), стоимость " << channelHours * system.getAutoscaler().getConfig().channelCost
+          << ", введено " << system.getProvisionedChannels() << ", снято " << system.getRetiredChannels()
+          << ", работает " << system.getActiveChannels() << "\n";
+      }
+      for (int cls = 0; database.getClassCount() > 1 && cls < database.getClassCount(); cls++) {
+        std::cout << "Класс " << cls << ": p_отк = " << database.getClassRejectionRate(cls)
+          << ", T_ож p99 = " << database.getClassWaitHistogram(cls).quantile(0.99)
+          << ", T_отклика p99 = " << database.getClassResponseHistogram(cls).quantile(0.99) << "\n";
+      }
+      if (argc > 3 && std::string(argv[3]) == "report") {
+        system.finalizeSimulation();
+      }
+      return 0;
+    }
+
+    // Создаем систему с 3 источниками, буфером на 5, 3 каналами
+    PushNotificationSystem system(3, 5, 3, 20); // Ограничиваем для демонстрации
+
+    // Запускаем пошаговую симуляцию
     system.runStepByStep();
   }
   catch (const std::exception& e) {